@@ -0,0 +1,45 @@
+#include "autosave.h"
+
+void* AutosaveWorker(void* arg) {
+    Autosave* autosave = (Autosave*)arg;
+    WriteSaveSnapshot(autosave->snapshot);
+    atomic_store(&autosave->finished, true);
+    return NULL;
+}
+
+bool StartAutosave(Autosave* autosave, World* world, const char* path) {
+    if (autosave->running) return false;
+
+    autosave->snapshot = TakeSaveSnapshot(world, path);
+    atomic_store(&autosave->finished, false);
+
+    if (pthread_create(&autosave->thread, NULL, AutosaveWorker, autosave) != 0) {
+        // No thread to hand it to; save inline rather than drop the edits.
+        WriteSaveSnapshot(autosave->snapshot);
+        autosave->succeeded = ApplySaveSnapshot(world, autosave->snapshot);
+        autosave->snapshot = NULL;
+        return true;
+    }
+    autosave->running = true;
+    return true;
+}
+
+// Returns true on the call that applies a finished save.
+bool PollAutosave(Autosave* autosave, World* world) {
+    if (!autosave->running || !atomic_load(&autosave->finished)) return false;
+
+    pthread_join(autosave->thread, NULL);
+    autosave->running = false;
+    autosave->succeeded = ApplySaveSnapshot(world, autosave->snapshot);
+    autosave->snapshot = NULL;
+    return true;
+}
+
+void FinishAutosave(Autosave* autosave, World* world) {
+    if (!autosave->running) return;
+
+    pthread_join(autosave->thread, NULL);
+    autosave->running = false;
+    autosave->succeeded = ApplySaveSnapshot(world, autosave->snapshot);
+    autosave->snapshot = NULL;
+}
@@ -0,0 +1,23 @@
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+
+#include "save.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+// One background save at a time: the snapshot is taken on the main thread,
+// encoded and written by a worker, and applied back on the main thread by
+// PollAutosave once the worker has finished.
+typedef struct {
+    pthread_t thread;
+    SaveSnapshot* snapshot;
+    atomic_bool finished;
+    bool running;
+    bool succeeded;
+} Autosave;
+
+bool StartAutosave(Autosave* autosave, World* world, const char* path);
+bool PollAutosave(Autosave* autosave, World* world);
+void FinishAutosave(Autosave* autosave, World* world);
+
+#endif
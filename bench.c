@@ -0,0 +1,506 @@
+#include "bench.h"
+#include "raylib.h"
+#include "raymath.h"
+#include "world.h"
+#include "physics.h"
+#include "entity.h"
+#include "mesher.h"
+#include "culling.h"
+#include "terrain.h"
+#include "stream.h"
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+// Headless benchmark: builds a random world and drives the collision,
+// raycast, edit, meshing and culling paths along a scripted camera orbit.
+// --travel instead flies in a straight line over streamed terrain, and
+// --entities N drops N items over the world and times the entity step on
+// both its paths. Nothing here opens a window or touches the GPU.
+
+#define BENCH_DEFAULT_SIZE 128
+#define BENCH_DEFAULT_HEIGHT 24
+#define BENCH_DEFAULT_DENSITY 0.35f
+#define BENCH_DEFAULT_SEED 1
+#define BENCH_DEFAULT_FRAMES 600
+
+#define BENCH_RAYS_PER_FRAME 64
+#define BENCH_EDITS_PER_FRAME 4
+#define BENCH_RAY_SPREAD 0.6f
+#define BENCH_ORBIT_SPEED 0.01f
+#define BENCH_ASPECT (16.0f / 9.0f)
+
+#define BENCH_TRAVEL_SPEED 1.5f
+#define BENCH_TRAVEL_EDIT_INTERVAL 10
+
+#define BENCH_ENTITY_DROP_HEIGHT 16.0f
+#define BENCH_ENTITY_SPEED 3.0f
+
+typedef enum {
+    PHASE_COLLISION = 0,
+    PHASE_RAYCAST,
+    PHASE_EDIT,
+    PHASE_MESH,
+    PHASE_CULL,
+    PHASE_COUNT
+} BenchPhase;
+
+const char* phaseNames[PHASE_COUNT] = { "collision", "raycast", "edit", "mesh", "cull" };
+
+typedef struct {
+    double* samples;
+    int count;
+    long allocations;
+    long frees;
+    size_t bytes;
+} PhaseStats;
+
+typedef struct {
+    long allocations;
+    long frees;
+    size_t bytes;
+    double start;
+} PhaseMark;
+
+typedef struct {
+    int size;
+    int height;
+    float density;
+    unsigned int seed;
+    int frames;
+    bool terrain;
+    int threads;
+    bool travel;
+    int viewRadius;
+    int entities;
+} BenchConfig;
+
+// Terrain workers allocate too, so the counters are atomic.
+atomic_long benchAllocations = 0;
+atomic_long benchFrees = 0;
+atomic_size_t benchBytes = 0;
+
+void* BenchMalloc(size_t size) {
+    benchAllocations++;
+    benchBytes += size;
+    return malloc(size);
+}
+
+void* BenchCalloc(size_t count, size_t size) {
+    benchAllocations++;
+    benchBytes += count * size;
+    return calloc(count, size);
+}
+
+void* BenchRealloc(void* ptr, size_t size) {
+    benchAllocations++;
+    benchBytes += size;
+    return realloc(ptr, size);
+}
+
+void BenchFree(void* ptr) {
+    if (ptr != NULL) benchFrees++;
+    free(ptr);
+}
+
+double BenchNow(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+unsigned int NextRandom(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+float RandomFloat(unsigned int* state) {
+    return (NextRandom(state) >> 8) * (1.0f / 16777216.0f);
+}
+
+void GenerateBenchWorld(World* world, const BenchConfig* config) {
+    unsigned int state = config->seed ? config->seed : 1;
+
+    for (int y = 0; y < config->height; y++) {
+        // Denser near the ground so the orbit sees both solid mass and caves.
+        float density = config->density * (1.5f - (float)y / config->height);
+        for (int z = 0; z < config->size; z++) {
+            for (int x = 0; x < config->size; x++) {
+                if (RandomFloat(&state) < density) {
+                    SetBlock(world, x, y, z, (BlockType)(1 + NextRandom(&state) % (BLOCK_TYPE_COUNT - 1)));
+                }
+            }
+        }
+    }
+}
+
+PhaseMark BeginPhase(void) {
+    return (PhaseMark){ benchAllocations, benchFrees, benchBytes, BenchNow() };
+}
+
+void EndPhase(PhaseStats* phase, PhaseMark mark) {
+    phase->samples[phase->count++] = (BenchNow() - mark.start) * 1000.0;
+    phase->allocations += benchAllocations - mark.allocations;
+    phase->frees += benchFrees - mark.frees;
+    phase->bytes += benchBytes - mark.bytes;
+}
+
+int CompareDoubles(const void* a, const void* b) {
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+double Percentile(const double* sorted, int count, double p) {
+    if (count == 0) return 0.0;
+    int index = (int)ceil(p * count) - 1;
+    if (index < 0) index = 0;
+    if (index >= count) index = count - 1;
+    return sorted[index];
+}
+
+void PrintPhase(const char* name, PhaseStats* phase, int frames) {
+    qsort(phase->samples, phase->count, sizeof(double), CompareDoubles);
+    printf("%-10s %9.4f %9.4f %9.4f %9.4f %10.1f %10.1f %12.1f\n", name,
+           Percentile(phase->samples, phase->count, 0.50),
+           Percentile(phase->samples, phase->count, 0.90),
+           Percentile(phase->samples, phase->count, 0.99),
+           phase->count ? phase->samples[phase->count - 1] : 0.0,
+           (double)phase->allocations / frames,
+           (double)phase->frees / frames,
+           (double)phase->bytes / frames);
+}
+
+// Builds geometry for every dirty chunk and throws it away; hasMesh is kept
+// so the culling pass sees the same chunks the renderer would draw.
+int MeshDirtyChunks(World* world) {
+    int rebuilt = 0;
+    for (int i = 0; i < world->chunkCount; i++) {
+        Chunk* chunk = world->chunks[i];
+        if (!chunk->dirty) continue;
+
+        Mesh mesh = { 0 };
+        chunk->mesh.hasMesh = BuildChunkGeometry(world, chunk, &mesh);
+        if (chunk->mesh.hasMesh) FreeMeshGeometry(&mesh);
+        rebuilt++;
+    }
+    return rebuilt;
+}
+
+bool ParseArgs(int argc, char** argv, BenchConfig* config) {
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--size") == 0 && value) config->size = atoi(value);
+        else if (strcmp(argv[i], "--height") == 0 && value) config->height = atoi(value);
+        else if (strcmp(argv[i], "--density") == 0 && value) config->density = (float)atof(value);
+        else if (strcmp(argv[i], "--seed") == 0 && value) config->seed = (unsigned int)strtoul(value, NULL, 10);
+        else if (strcmp(argv[i], "--frames") == 0 && value) config->frames = atoi(value);
+        else if (strcmp(argv[i], "--threads") == 0 && value) config->threads = atoi(value);
+        else if (strcmp(argv[i], "--view-radius") == 0 && value) config->viewRadius = atoi(value);
+        else if (strcmp(argv[i], "--entities") == 0 && value) config->entities = atoi(value);
+        else if (strcmp(argv[i], "--terrain") == 0) {
+            config->terrain = true;
+            continue;
+        } else if (strcmp(argv[i], "--travel") == 0) {
+            config->travel = true;
+            continue;
+        } else {
+            fprintf(stderr, "usage: %s [--size N] [--height N] [--density F] [--seed N] [--frames N] [--terrain] [--threads N] [--travel] [--view-radius N] [--entities N]\n", argv[0]);
+            return false;
+        }
+        i++;
+    }
+    return config->size > 0 && config->height > 0 && config->frames > 0 && config->viewRadius > 0 && config->entities >= 0;
+}
+
+// Streams terrain around a camera flying along +x, digging out a block every
+// few frames so evicted chunks carry unsaved edits into the cache. Resident
+// chunks and cache size should level off however long it runs.
+int RunTravelBench(const BenchConfig* config) {
+    World world = { 0 };
+    world.hasTerrain = true;
+    world.terrainSeed = config->seed;
+
+    ChunkCache cache;
+    InitChunkCache(&cache, CHUNK_CACHE_DEFAULT_BUDGET);
+    world.cache = &cache;
+
+    TerrainGenerator generator;
+    StartTerrainGenerator(&generator, (TerrainSettings){ config->seed }, config->threads);
+    ChunkStreamer streamer;
+    InitChunkStreamer(&streamer, config->viewRadius);
+
+    PhaseStats stream = { 0 };
+    PhaseStats mesh = { 0 };
+    stream.samples = (double*)calloc(config->frames, sizeof(double));
+    mesh.samples = (double*)calloc(config->frames, sizeof(double));
+
+    int peakChunks = 0;
+    int peakCacheEntries = 0;
+    size_t peakCacheBytes = 0;
+    long dug = 0;
+
+    for (int frame = 0; frame < config->frames; frame++) {
+        Vector3 position = { frame * BENCH_TRAVEL_SPEED, TERRAIN_MAX_HEIGHT + CAMERA_HEIGHT, 0.0f };
+
+        PhaseMark mark = BeginPhase();
+        // Waiting for the terrain jobs keeps runs comparable: the same
+        // chunks are resident and the same blocks are dug every time.
+        UpdateStreaming(&streamer, &world, &generator, position, 1.0f / 60.0f);
+        FinishTerrainChunks(&streamer, &world, &generator);
+        EndPhase(&stream, mark);
+
+        if (frame % BENCH_TRAVEL_EDIT_INTERVAL == 0) {
+            int x = (int)roundf(position.x);
+            int y = (int)FindGroundLevel(position, &world) - 1;
+            if (GetBlock(&world, x, y, 0) != BLOCK_AIR) {
+                SetBlock(&world, x, y, 0, BLOCK_AIR);
+                dug++;
+            }
+        }
+
+        mark = BeginPhase();
+        MeshDirtyChunks(&world);
+        EndPhase(&mesh, mark);
+
+        if (world.chunkCount > peakChunks) peakChunks = world.chunkCount;
+        if (cache.count > peakCacheEntries) peakCacheEntries = cache.count;
+        if (cache.bytes > peakCacheBytes) peakCacheBytes = cache.bytes;
+    }
+
+    printf("travel: %.0f blocks at view radius %i on %i threads, %ld blocks dug\n",
+           config->frames * BENCH_TRAVEL_SPEED, config->viewRadius, config->threads, dug);
+    printf("resident chunks: %i peak, %i at end; cache: %i entries, %.1f KB peak (%.1f KB at end)\n\n",
+           peakChunks, world.chunkCount, peakCacheEntries, peakCacheBytes / 1024.0, cache.bytes / 1024.0);
+    printf("%-10s %9s %9s %9s %9s %10s %10s %12s\n", "phase", "p50 ms", "p90 ms", "p99 ms", "max ms", "allocs/f", "frees/f", "bytes/f");
+    PrintPhase("stream", &stream, config->frames);
+    PrintPhase("mesh", &mesh, config->frames);
+    free(stream.samples);
+    free(mesh.samples);
+
+    StopTerrainGenerator(&generator);
+    FreeChunkStreamer(&streamer);
+    FreeWorld(&world);
+    FreeChunkCache(&cache);
+    return 0;
+}
+
+void SpawnBenchEntities(EntitySet* set, const BenchConfig* config) {
+    unsigned int state = config->seed ^ 0x85EBCA6Bu;
+    for (int i = 0; i < config->entities; i++) {
+        Vector3 position = { RandomFloat(&state) * config->size, config->height + RandomFloat(&state) * BENCH_ENTITY_DROP_HEIGHT, RandomFloat(&state) * config->size };
+        Vector3 velocity = { (RandomFloat(&state) * 2.0f - 1.0f) * BENCH_ENTITY_SPEED, 0.0f, (RandomFloat(&state) * 2.0f - 1.0f) * BENCH_ENTITY_SPEED };
+        BlockType type = (BlockType)(1 + NextRandom(&state) % (BLOCK_TYPE_COUNT - 1));
+        SpawnEntity(set, ENTITY_ITEM, type, position, velocity);
+    }
+}
+
+// The same drop is stepped once with batches and once entity by entity;
+// items never change the world, so both runs see the same grid and should
+// end in the same place.
+int RunEntityBench(const BenchConfig* config) {
+    World world = { 0 };
+    GenerateBenchWorld(&world, config);
+
+    const char* pathNames[2] = { ENTITY_SIMD ? "sse2" : "batched", "scalar" };
+    EntitySet sets[2];
+    PhaseStats phases[2] = { 0 };
+    for (int p = 0; p < 2; p++) {
+        InitEntitySet(&sets[p]);
+        SpawnBenchEntities(&sets[p], config);
+        phases[p].samples = (double*)calloc(config->frames, sizeof(double));
+        for (int frame = 0; frame < config->frames; frame++) {
+            PhaseMark mark = BeginPhase();
+            StepEntities(&sets[p], &world, ENTITY_TIMESTEP, p == 0);
+            EndPhase(&phases[p], mark);
+        }
+    }
+
+    float difference = 0.0f;
+    int grounded = 0;
+    for (int i = 0; i < sets[0].count && i < sets[1].count; i++) {
+        difference = fmaxf(difference, fabsf(sets[0].x[i] - sets[1].x[i]));
+        difference = fmaxf(difference, fabsf(sets[0].y[i] - sets[1].y[i]));
+        difference = fmaxf(difference, fabsf(sets[0].z[i] - sets[1].z[i]));
+        grounded += sets[0].grounded[i];
+    }
+
+    printf("entities: %i items over %ix%ix%i, %i ticks of %.2f ms\n",
+           config->entities, config->size, config->height, config->size, config->frames, ENTITY_TIMESTEP * 1000.0f);
+    printf("at end: %i and %i left, %i resting, largest position difference %g\n\n", sets[0].count, sets[1].count, grounded, difference);
+    printf("%-10s %9s %9s %9s %9s %10s %10s %12s\n", "path", "p50 ms", "p90 ms", "p99 ms", "max ms", "allocs/f", "frees/f", "bytes/f");
+    for (int p = 0; p < 2; p++) {
+        PrintPhase(pathNames[p], &phases[p], config->frames);
+        free(phases[p].samples);
+        FreeEntitySet(&sets[p]);
+    }
+    FreeWorld(&world);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config = {
+        BENCH_DEFAULT_SIZE, BENCH_DEFAULT_HEIGHT, BENCH_DEFAULT_DENSITY, BENCH_DEFAULT_SEED, BENCH_DEFAULT_FRAMES,
+        false, 0, false, STREAM_DEFAULT_VIEW_RADIUS, 0
+    };
+    if (!ParseArgs(argc, argv, &config)) return 1;
+    if (config.threads <= 0) config.threads = DefaultJobThreadCount();
+    if (config.travel) return RunTravelBench(&config);
+    if (config.entities > 0) return RunEntityBench(&config);
+
+    World world = { 0 };
+
+    double start = BenchNow();
+    if (config.terrain) {
+        // Terrain covers a size x size square; height follows from it.
+        config.height = TERRAIN_MAX_HEIGHT;
+        TerrainGenerator generator;
+        StartTerrainGenerator(&generator, (TerrainSettings){ config.seed }, config.threads);
+        int chunks = (config.size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        for (int cz = 0; cz < chunks; cz++) {
+            for (int cx = 0; cx < chunks; cx++) {
+                for (int cy = 0; cy < TERRAIN_CHUNK_LAYERS; cy++) {
+                    RequestTerrainChunk(&generator, cx, cy, cz);
+                }
+            }
+        }
+        while (generator.pending > 0) {
+            CollectTerrainChunks(&generator, &world);
+        }
+        StopTerrainGenerator(&generator);
+    } else {
+        GenerateBenchWorld(&world, &config);
+    }
+    double generateTime = BenchNow() - start;
+
+    long allocations = benchAllocations;
+    start = BenchNow();
+    int initialChunks = MeshDirtyChunks(&world);
+    double initialMeshTime = BenchNow() - start;
+    long initialMeshAllocations = benchAllocations - allocations;
+
+    if (config.terrain) {
+        printf("world: terrain seed %u on %i threads, %i blocks in %i chunks\n", config.seed, config.threads, world.blockCount, world.chunkCount);
+    } else {
+        printf("world: %ix%ix%i density %.2f seed %u, %i blocks in %i chunks\n",
+               config.size, config.height, config.size, config.density, config.seed, world.blockCount, world.chunkCount);
+    }
+    printf("generate: %.2f ms, initial mesh: %i chunks in %.2f ms (%ld allocations)\n",
+           generateTime * 1000.0, initialChunks, initialMeshTime * 1000.0, initialMeshAllocations);
+
+    PhaseStats phases[PHASE_COUNT] = { 0 };
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        phases[p].samples = (double*)calloc(config.frames, sizeof(double));
+    }
+
+    Vector3 center = { config.size * 0.5f, config.height * 0.5f, config.size * 0.5f };
+    float orbitRadius = config.size * 0.35f;
+
+    Player player = { 0 };
+    player.position = (Vector3){ center.x, config.height + CAMERA_HEIGHT, center.z };
+    player.previousPosition = player.position;
+
+    Camera camera = { 0 };
+    camera.up = (Vector3){ 0.0f, 1.0f, 0.0f };
+    camera.fovy = 100.0f;
+    camera.projection = CAMERA_PERSPECTIVE;
+
+    ChunkVisibility visibility = { 0 };
+    unsigned int state = config.seed ^ 0x9E3779B9u;
+    long rayHits = 0;
+    long edits = 0;
+    long rebuilt = 0;
+    long visible = 0;
+
+    for (int frame = 0; frame < config.frames; frame++) {
+        float angle = frame * BENCH_ORBIT_SPEED;
+        camera.position = (Vector3){
+            center.x + cosf(angle) * orbitRadius,
+            config.height + 4.0f,
+            center.z + sinf(angle) * orbitRadius
+        };
+        camera.target = (Vector3){ center.x, center.y * 0.5f, center.z };
+        Vector3 forward = Vector3Normalize(Vector3Subtract(camera.target, camera.position));
+        Vector3 right = Vector3Normalize(Vector3CrossProduct(forward, camera.up));
+        Vector3 up = Vector3CrossProduct(right, forward);
+        PhaseMark mark;
+
+        // The player walks along the orbit tangent and hops every second.
+        mark = BeginPhase();
+        Vector3 move = { -sinf(angle), 0.0f, cosf(angle) };
+        StepPlayer(&player, &world, move, frame % 120 == 0, PHYSICS_TIMESTEP);
+        if (player.position.y < RESPAWN_Y_THRESHOLD) {
+            player.position = (Vector3){ center.x, config.height + CAMERA_HEIGHT, center.z };
+            player.velocityY = 0.0f;
+        }
+        EndPhase(&phases[PHASE_COLLISION], mark);
+
+        VoxelHit hits[BENCH_EDITS_PER_FRAME] = { 0 };
+
+        mark = BeginPhase();
+        for (int r = 0; r < BENCH_RAYS_PER_FRAME; r++) {
+            float du = (RandomFloat(&state) * 2.0f - 1.0f) * BENCH_RAY_SPREAD;
+            float dv = (RandomFloat(&state) * 2.0f - 1.0f) * BENCH_RAY_SPREAD;
+            Vector3 direction = Vector3Add(forward, Vector3Add(Vector3Scale(right, du), Vector3Scale(up, dv)));
+            Ray ray = { camera.position, Vector3Normalize(direction) };
+            VoxelHit hit = RaycastVoxels(&world, ray, BLOCK_REACH * 4.0f);
+            if (hit.hit) rayHits++;
+            if (r < BENCH_EDITS_PER_FRAME) hits[r] = hit;
+        }
+        EndPhase(&phases[PHASE_RAYCAST], mark);
+
+        // Each edit moves a block one cell towards the camera, so the block
+        // count stays stable over long runs.
+        mark = BeginPhase();
+        for (int e = 0; e < BENCH_EDITS_PER_FRAME; e++) {
+            VoxelHit* hit = &hits[e];
+            if (!hit->hit || hit->ground) continue;
+
+            BlockType type = GetBlock(&world, hit->x, hit->y, hit->z);
+            SetBlock(&world, hit->x, hit->y, hit->z, BLOCK_AIR);
+            SetBlock(&world, hit->adjacentX, hit->adjacentY, hit->adjacentZ, type);
+            edits++;
+        }
+        EndPhase(&phases[PHASE_EDIT], mark);
+
+        mark = BeginPhase();
+        rebuilt += MeshDirtyChunks(&world);
+        EndPhase(&phases[PHASE_MESH], mark);
+
+        mark = BeginPhase();
+        CollectVisibleChunks(&world, camera, BENCH_ASPECT, 0, &visibility);
+        visible += visibility.count;
+        EndPhase(&phases[PHASE_CULL], mark);
+    }
+
+    printf("frames: %i, ray hits %ld, edits %ld, chunk rebuilds %ld, visible chunks %.1f/frame\n\n",
+           config.frames, rayHits, edits, rebuilt, (double)visible / config.frames);
+    printf("%-10s %9s %9s %9s %9s %10s %10s %12s\n", "phase", "p50 ms", "p90 ms", "p99 ms", "max ms", "allocs/f", "frees/f", "bytes/f");
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        PrintPhase(phaseNames[p], &phases[p], config.frames);
+        free(phases[p].samples);
+    }
+
+    FreeChunkVisibility(&visibility);
+    FreeWorld(&world);
+    return 0;
+}
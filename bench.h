@@ -0,0 +1,18 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+
+// Force-included into every translation unit of the bench build so that the
+// modules' RL_* allocations go through counters instead of straight to libc.
+void* BenchMalloc(size_t size);
+void* BenchCalloc(size_t count, size_t size);
+void* BenchRealloc(void* ptr, size_t size);
+void BenchFree(void* ptr);
+
+#define RL_MALLOC(sz) BenchMalloc(sz)
+#define RL_CALLOC(n, sz) BenchCalloc(n, sz)
+#define RL_REALLOC(ptr, sz) BenchRealloc(ptr, sz)
+#define RL_FREE(ptr) BenchFree(ptr)
+
+#endif
@@ -0,0 +1,69 @@
+#include "server.h"
+#include "jobpool.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DEFAULT_SAVE_PATH "world.box"
+#define DEFAULT_TERRAIN_SEED 1337u
+#define STATS_INTERVAL 10.0
+
+volatile sig_atomic_t running = 1;
+
+void StopRunning(int signal) {
+    (void)signal;
+    running = 0;
+}
+
+int main(int argc, char** argv) {
+    ServerSettings settings = { NET_DEFAULT_SOCKET, DEFAULT_SAVE_PATH, false, DEFAULT_TERRAIN_SEED, DefaultJobThreadCount() };
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--flat") == 0) settings.flat = true;
+        else if (strcmp(argv[i], "--no-save") == 0) settings.savePath = NULL;
+        else if (strcmp(argv[i], "--socket") == 0 && value) settings.socketPath = argv[++i];
+        else if (strcmp(argv[i], "--save") == 0 && value) settings.savePath = argv[++i];
+        else if (strcmp(argv[i], "--seed") == 0 && value) settings.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && value) settings.threads = atoi(argv[++i]);
+        else {
+            fprintf(stderr, "usage: %s [--socket PATH] [--save PATH] [--no-save] [--flat] [--seed N] [--threads N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Server server;
+    if (!StartServer(&server, settings)) {
+        fprintf(stderr, "could not listen on %s\n", settings.socketPath);
+        return 1;
+    }
+    signal(SIGINT, StopRunning);
+    signal(SIGTERM, StopRunning);
+    printf("listening on %s, %i ticks per second\n", settings.socketPath, SERVER_TICK_RATE);
+    fflush(stdout);
+
+    // Ticks run on a fixed schedule; one that overruns pushes the schedule
+    // back rather than being made up with a burst.
+    const double tickSeconds = 1.0 / SERVER_TICK_RATE;
+    double nextTick = ServerTime();
+    double nextStats = nextTick + STATS_INTERVAL;
+    while (running) {
+        ServerTick(&server, (float)tickSeconds);
+
+        double now = ServerTime();
+        if (now >= nextStats) {
+            ServerTickStats stats = GetServerTickStats(&server);
+            printf("%i clients, %i chunks, tick p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+                server.clientCount, server.world.chunkCount, stats.p50, stats.p99, stats.max);
+            fflush(stdout);
+            nextStats = now + STATS_INTERVAL;
+        }
+
+        nextTick += tickSeconds;
+        if (nextTick < now) nextTick = now;
+        SleepServer(nextTick - now);
+    }
+
+    StopServer(&server);
+    return 0;
+}
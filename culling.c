@@ -0,0 +1,145 @@
+#include "culling.h"
+#include "raymath.h"
+#include "rlgl.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Gribb & Hartmann plane extraction from the combined view-projection.
+Frustum ExtractFrustum(Matrix m) {
+    Frustum frustum;
+    Vector4 row0 = { m.m0, m.m4, m.m8, m.m12 };
+    Vector4 row1 = { m.m1, m.m5, m.m9, m.m13 };
+    Vector4 row2 = { m.m2, m.m6, m.m10, m.m14 };
+    Vector4 row3 = { m.m3, m.m7, m.m11, m.m15 };
+
+    frustum.planes[0] = (Vector4){ row3.x + row0.x, row3.y + row0.y, row3.z + row0.z, row3.w + row0.w };
+    frustum.planes[1] = (Vector4){ row3.x - row0.x, row3.y - row0.y, row3.z - row0.z, row3.w - row0.w };
+    frustum.planes[2] = (Vector4){ row3.x + row1.x, row3.y + row1.y, row3.z + row1.z, row3.w + row1.w };
+    frustum.planes[3] = (Vector4){ row3.x - row1.x, row3.y - row1.y, row3.z - row1.z, row3.w - row1.w };
+    frustum.planes[4] = (Vector4){ row3.x + row2.x, row3.y + row2.y, row3.z + row2.z, row3.w + row2.w };
+    frustum.planes[5] = (Vector4){ row3.x - row2.x, row3.y - row2.y, row3.z - row2.z, row3.w - row2.w };
+    return frustum;
+}
+
+Frustum CameraFrustum(Camera camera, float aspect) {
+    Matrix view = MatrixLookAt(camera.position, camera.target, camera.up);
+    Matrix projection = MatrixPerspective(camera.fovy * DEG2RAD, aspect, RL_CULL_DISTANCE_NEAR, RL_CULL_DISTANCE_FAR);
+    return ExtractFrustum(MatrixMultiply(view, projection));
+}
+
+bool IsBoxInFrustum(const Frustum* frustum, BoundingBox box) {
+    for (int i = 0; i < 6; i++) {
+        Vector4 p = frustum->planes[i];
+        float x = (p.x >= 0.0f) ? box.max.x : box.min.x;
+        float y = (p.y >= 0.0f) ? box.max.y : box.min.y;
+        float z = (p.z >= 0.0f) ? box.max.z : box.min.z;
+        if (p.x * x + p.y * y + p.z * z + p.w < 0.0f) return false;
+    }
+    return true;
+}
+
+BoundingBox ChunkBounds(int cx, int cy, int cz) {
+    return (BoundingBox){
+        (Vector3){ cx * CHUNK_SIZE - 0.5f, (float)(cy * CHUNK_SIZE), cz * CHUNK_SIZE - 0.5f },
+        (Vector3){ (cx + 1) * CHUNK_SIZE - 0.5f, (float)((cy + 1) * CHUNK_SIZE), (cz + 1) * CHUNK_SIZE - 0.5f }
+    };
+}
+
+// Breadth-first walk over chunks starting at the camera. A chunk is entered
+// through one face and may only be left through faces its air connects to,
+// never heading back against a direction already travelled, and only into
+// chunks that intersect the view frustum. Chunks not reached are hidden. A
+// positive chunkRadius limits the walk to that many chunks around the camera,
+// since the world bounds only ever grow as the player travels.
+void CollectVisibleChunks(World* world, Camera camera, float aspect, int chunkRadius, ChunkVisibility* visibility) {
+    static ChunkVisit* queue = NULL;
+    static int queueCapacity = 0;
+    static unsigned char* visited = NULL;
+    static int visitedCapacity = 0;
+
+    const int offsets[6][3] = { {-1,0,0}, {1,0,0}, {0,-1,0}, {0,1,0}, {0,0,-1}, {0,0,1} };
+
+    visibility->count = 0;
+    visibility->culledCount = 0;
+    if (visibility->capacity < world->chunkCount) {
+        visibility->capacity = world->chunkCount;
+        visibility->chunks = (Chunk**)RL_REALLOC(visibility->chunks, visibility->capacity * sizeof(Chunk*));
+    }
+
+    int meshedChunks = 0;
+    for (int i = 0; i < world->chunkCount; i++) {
+        if (world->chunks[i]->mesh.hasMesh) meshedChunks++;
+    }
+    if (world->chunkCount == 0) return;
+
+    int camX, camY, camZ;
+    CellFromPosition(camera.position, &camX, &camY, &camZ);
+    camX >>= CHUNK_SHIFT;
+    camY >>= CHUNK_SHIFT;
+    camZ >>= CHUNK_SHIFT;
+
+    int minX = ((world->minChunkX < camX) ? world->minChunkX : camX) - 1;
+    int minY = ((world->minChunkY < camY) ? world->minChunkY : camY) - 1;
+    int minZ = ((world->minChunkZ < camZ) ? world->minChunkZ : camZ) - 1;
+    int maxX = ((world->maxChunkX > camX) ? world->maxChunkX : camX) + 1;
+    int maxY = ((world->maxChunkY > camY) ? world->maxChunkY : camY) + 1;
+    int maxZ = ((world->maxChunkZ > camZ) ? world->maxChunkZ : camZ) + 1;
+    if (chunkRadius > 0) {
+        if (minX < camX - chunkRadius) minX = camX - chunkRadius;
+        if (minY < camY - chunkRadius) minY = camY - chunkRadius;
+        if (minZ < camZ - chunkRadius) minZ = camZ - chunkRadius;
+        if (maxX > camX + chunkRadius) maxX = camX + chunkRadius;
+        if (maxY > camY + chunkRadius) maxY = camY + chunkRadius;
+        if (maxZ > camZ + chunkRadius) maxZ = camZ + chunkRadius;
+    }
+    int sizeX = maxX - minX + 1, sizeY = maxY - minY + 1, sizeZ = maxZ - minZ + 1;
+    int regionVolume = sizeX * sizeY * sizeZ;
+
+    if (regionVolume > visitedCapacity) {
+        visitedCapacity = regionVolume;
+        visited = (unsigned char*)RL_REALLOC(visited, visitedCapacity);
+        queueCapacity = regionVolume;
+        queue = (ChunkVisit*)RL_REALLOC(queue, queueCapacity * sizeof(ChunkVisit));
+    }
+    memset(visited, 0, regionVolume);
+
+    Frustum frustum = CameraFrustum(camera, aspect);
+
+    int head = 0, tail = 0;
+    queue[tail++] = (ChunkVisit){ camX, camY, camZ, -1, 0 };
+    visited[((camY - minY) * sizeZ + (camZ - minZ)) * sizeX + (camX - minX)] = 1;
+
+    while (head < tail) {
+        ChunkVisit visit = queue[head++];
+        // Only loaded chunks; bringing evicted ones back is up to streaming.
+        Chunk* chunk = FindChunk(world, visit.cx, visit.cy, visit.cz);
+
+        if (chunk != NULL && chunk->mesh.hasMesh) {
+            visibility->chunks[visibility->count++] = chunk;
+        }
+
+        for (int f = 0; f < CHUNK_FACE_COUNT; f++) {
+            if (visit.directions & (1 << (f ^ 1))) continue;
+            if (visit.entryFace >= 0 && chunk != NULL && !(chunk->faceLinks[visit.entryFace] & (1 << f))) continue;
+
+            int nx = visit.cx + offsets[f][0];
+            int ny = visit.cy + offsets[f][1];
+            int nz = visit.cz + offsets[f][2];
+            if (nx < minX || nx > maxX || ny < minY || ny > maxY || nz < minZ || nz > maxZ) continue;
+
+            unsigned char* seen = &visited[((ny - minY) * sizeZ + (nz - minZ)) * sizeX + (nx - minX)];
+            if (*seen) continue;
+            if (!IsBoxInFrustum(&frustum, ChunkBounds(nx, ny, nz))) continue;
+
+            *seen = 1;
+            queue[tail++] = (ChunkVisit){ nx, ny, nz, (signed char)(f ^ 1), (unsigned char)(visit.directions | (1 << f)) };
+        }
+    }
+
+    visibility->culledCount = meshedChunks - visibility->count;
+}
+
+void FreeChunkVisibility(ChunkVisibility* visibility) {
+    RL_FREE(visibility->chunks);
+    *visibility = (ChunkVisibility){ 0 };
+}
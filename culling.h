@@ -0,0 +1,30 @@
+#ifndef CULLING_H
+#define CULLING_H
+
+#include "world.h"
+
+typedef struct {
+    Vector4 planes[6];
+} Frustum;
+
+typedef struct {
+    int cx, cy, cz;
+    signed char entryFace;
+    unsigned char directions;
+} ChunkVisit;
+
+typedef struct {
+    Chunk** chunks;
+    int count;
+    int capacity;
+    int culledCount;
+} ChunkVisibility;
+
+Frustum ExtractFrustum(Matrix m);
+Frustum CameraFrustum(Camera camera, float aspect);
+bool IsBoxInFrustum(const Frustum* frustum, BoundingBox box);
+BoundingBox ChunkBounds(int cx, int cy, int cz);
+void CollectVisibleChunks(World* world, Camera camera, float aspect, int chunkRadius, ChunkVisibility* visibility);
+void FreeChunkVisibility(ChunkVisibility* visibility);
+
+#endif
@@ -0,0 +1,290 @@
+#include "edit.h"
+#include <stdlib.h>
+#include <string.h>
+
+BlockRegion RegionFromCorners(int ax, int ay, int az, int bx, int by, int bz) {
+    return (BlockRegion){
+        (ax < bx) ? ax : bx, (ay < by) ? ay : by, (az < bz) ? az : bz,
+        (ax > bx) ? ax : bx, (ay > by) ? ay : by, (az > bz) ? az : bz
+    };
+}
+
+long long RegionVolume(BlockRegion region) {
+    return (long long)(region.x1 - region.x0 + 1) * (region.y1 - region.y0 + 1) * (region.z1 - region.z0 + 1);
+}
+
+BoundingBox RegionBox(BlockRegion region) {
+    return (BoundingBox){ CellBox(region.x0, region.y0, region.z0).min, CellBox(region.x1, region.y1, region.z1).max };
+}
+
+unsigned char EditedVoxel(const RegionEdit* edit, int x, int y, int z, unsigned char old) {
+    const BlockRegion* r = &edit->region;
+    switch (edit->kind) {
+        case EDIT_FILL:
+            return (unsigned char)edit->type;
+        case EDIT_HOLLOW: {
+            bool shell = x == r->x0 || x == r->x1 || y == r->y0 || y == r->y1 || z == r->z0 || z == r->z1;
+            return shell ? (unsigned char)edit->type : BLOCK_AIR;
+        }
+        case EDIT_REPLACE:
+            return (old == edit->match) ? (unsigned char)edit->type : old;
+        case EDIT_PASTE: {
+            const BlockClipboard* clip = edit->clipboard;
+            return clip->voxels[((y - r->y0) * clip->sizeZ + (z - r->z0)) * clip->sizeX + (x - r->x0)];
+        }
+    }
+    return old;
+}
+
+// Bit per chunk face the voxel touches, in faceLinks order.
+int VoxelBorderMask(int index) {
+    int lx = index & CHUNK_MASK;
+    int lz = (index >> CHUNK_SHIFT) & CHUNK_MASK;
+    int ly = index >> (2 * CHUNK_SHIFT);
+    return (lx == 0) | (lx == CHUNK_MASK) << 1 | (ly == 0) << 2 | (ly == CHUNK_MASK) << 3 | (lz == 0) << 4 | (lz == CHUNK_MASK) << 5;
+}
+
+// Writes one side of a diff into the world and does the bookkeeping SetBlock
+// does per block once for the whole chunk.
+void ApplyChunkDiff(World* world, const ChunkDiff* diff, bool undo) {
+    const unsigned char* values = undo ? diff->before : diff->after;
+    Chunk* chunk = GetChunk(world, diff->cx, diff->cy, diff->cz);
+    if (chunk == NULL) {
+        chunk = CreateChunk(world, diff->cx, diff->cy, diff->cz);
+        RestoreChunkLight(world, chunk);
+    }
+
+    unsigned char* voxels = GetWritableVoxels(chunk);
+    int baseX = diff->cx * CHUNK_SIZE, baseY = diff->cy * CHUNK_SIZE, baseZ = diff->cz * CHUNK_SIZE;
+    int added = 0;
+    int borders = 0;
+    int v = 0;
+    for (int r = 0; r < diff->runCount; r++) {
+        int start = diff->runs[2 * r];
+        int end = start + diff->runs[2 * r + 1];
+        for (int i = start; i < end; i++, v++) {
+            added += (values[v] != BLOCK_AIR) - (voxels[i] != BLOCK_AIR);
+            voxels[i] = values[v];
+            MarkLightDirty(world, baseX + (i & CHUNK_MASK), baseY + (i >> (2 * CHUNK_SHIFT)), baseZ + ((i >> CHUNK_SHIFT) & CHUNK_MASK));
+        }
+        // A run wrapping into the next row passes both x faces, one wrapping
+        // into the next layer both z faces; the rest show at its ends.
+        borders |= VoxelBorderMask(start) | VoxelBorderMask(end - 1);
+        if (start >> CHUNK_SHIFT != (end - 1) >> CHUNK_SHIFT) borders |= 0x03;
+        if (start >> (2 * CHUNK_SHIFT) != (end - 1) >> (2 * CHUNK_SHIFT)) borders |= 0x30;
+    }
+    chunk->blockCount += added;
+    world->blockCount += added;
+
+    chunk->dirty = true;
+    chunk->modified = true;
+    chunk->generated = false;
+    chunk->revision = ++world->revision;
+    world->modified = true;
+    int cx = diff->cx, cy = diff->cy, cz = diff->cz;
+    if (borders & 0x01) MarkChunkDirty(world, cx - 1, cy, cz);
+    if (borders & 0x02) MarkChunkDirty(world, cx + 1, cy, cz);
+    if (borders & 0x04) MarkChunkDirty(world, cx, cy - 1, cz);
+    if (borders & 0x08) MarkChunkDirty(world, cx, cy + 1, cz);
+    if (borders & 0x10) MarkChunkDirty(world, cx, cy, cz - 1);
+    if (borders & 0x20) MarkChunkDirty(world, cx, cy, cz + 1);
+
+    if (chunk->blockCount == 0) {
+        InsertCoord(&world->emptied, cx, cy, cz, 0);
+        KeepChunkLight(world, chunk);
+        RemoveChunk(world, chunk);
+    }
+}
+
+// Collects the cells of one chunk that the edit changes, walking them in
+// voxel index order so neighbouring changes merge into runs.
+bool BuildChunkDiff(World* world, const RegionEdit* edit, BlockRegion clip, int cx, int cy, int cz, ChunkDiff* diff) {
+    static unsigned short runs[CHUNK_VOLUME * 2];
+    static unsigned char before[CHUNK_VOLUME];
+    static unsigned char after[CHUNK_VOLUME];
+
+    Chunk* chunk = GetChunk(world, cx, cy, cz);
+    const unsigned char* voxels = (chunk != NULL) ? chunk->voxels->data : NULL;
+
+    int baseX = cx * CHUNK_SIZE, baseY = cy * CHUNK_SIZE, baseZ = cz * CHUNK_SIZE;
+    int x0 = (clip.x0 > baseX) ? clip.x0 - baseX : 0, x1 = (clip.x1 < baseX + CHUNK_MASK) ? clip.x1 - baseX : CHUNK_MASK;
+    int y0 = (clip.y0 > baseY) ? clip.y0 - baseY : 0, y1 = (clip.y1 < baseY + CHUNK_MASK) ? clip.y1 - baseY : CHUNK_MASK;
+    int z0 = (clip.z0 > baseZ) ? clip.z0 - baseZ : 0, z1 = (clip.z1 < baseZ + CHUNK_MASK) ? clip.z1 - baseZ : CHUNK_MASK;
+
+    int runCount = 0;
+    int count = 0;
+    int last = -2;
+    for (int ly = y0; ly <= y1; ly++) {
+        for (int lz = z0; lz <= z1; lz++) {
+            for (int lx = x0; lx <= x1; lx++) {
+                int index = ChunkVoxelIndex(lx, ly, lz);
+                unsigned char old = (voxels != NULL) ? voxels[index] : BLOCK_AIR;
+                unsigned char value = EditedVoxel(edit, baseX + lx, baseY + ly, baseZ + lz, old);
+                if (value == old) continue;
+
+                if (index == last + 1) {
+                    runs[2 * runCount - 1]++;
+                } else {
+                    runs[2 * runCount] = (unsigned short)index;
+                    runs[2 * runCount + 1] = 1;
+                    runCount++;
+                }
+                before[count] = old;
+                after[count] = value;
+                count++;
+                last = index;
+            }
+        }
+    }
+    if (count == 0) return false;
+
+    size_t runBytes = runCount * 2 * sizeof(unsigned short);
+    unsigned char* data = (unsigned char*)RL_MALLOC(runBytes + 2 * count);
+    memcpy(data, runs, runBytes);
+    memcpy(data + runBytes, before, count);
+    memcpy(data + runBytes + count, after, count);
+    *diff = (ChunkDiff){ cx, cy, cz, runCount, count, (unsigned short*)data, data + runBytes, data + runBytes + count };
+    return true;
+}
+
+void FreeEditRecord(EditRecord* record) {
+    for (int i = 0; i < record->chunkCount; i++) {
+        RL_FREE(record->chunks[i].runs);
+    }
+    RL_FREE(record->chunks);
+    *record = (EditRecord){ 0 };
+}
+
+void PushEditRecord(EditHistory* history, EditRecord record) {
+    while (history->count > history->position) {
+        EditRecord* dropped = &history->records[--history->count];
+        history->bytes -= dropped->bytes;
+        FreeEditRecord(dropped);
+    }
+
+    if (history->count >= history->capacity) {
+        history->capacity = history->capacity ? history->capacity * 2 : 64;
+        history->records = (EditRecord*)RL_REALLOC(history->records, history->capacity * sizeof(EditRecord));
+    }
+    history->records[history->count++] = record;
+    history->position = history->count;
+    history->bytes += record.bytes;
+
+    // The newest record always stays, however large.
+    int dropCount = 0;
+    while (history->bytes > history->budget && dropCount < history->count - 1) {
+        history->bytes -= history->records[dropCount].bytes;
+        FreeEditRecord(&history->records[dropCount]);
+        dropCount++;
+    }
+    if (dropCount > 0) {
+        history->count -= dropCount;
+        history->position -= dropCount;
+        memmove(history->records, history->records + dropCount, history->count * sizeof(EditRecord));
+    }
+}
+
+// Each touched chunk is diffed and written once, however many of its cells
+// change, and is remeshed once on the next dirty pass. Returns the number of
+// cells changed; cells below the ground plane are left alone.
+int ApplyRegionEdit(World* world, EditHistory* history, const RegionEdit* edit) {
+    BlockRegion clip = edit->region;
+    if (clip.y0 < 0) clip.y0 = 0;
+    if (clip.y1 < clip.y0 || RegionVolume(clip) > EDIT_MAX_VOLUME) return 0;
+    if (edit->kind == EDIT_PASTE && (edit->clipboard == NULL || edit->clipboard->voxels == NULL)) return 0;
+
+    EditRecord record = { 0 };
+    int capacity = 0;
+    for (int cy = clip.y0 >> CHUNK_SHIFT; cy <= clip.y1 >> CHUNK_SHIFT; cy++) {
+        for (int cz = clip.z0 >> CHUNK_SHIFT; cz <= clip.z1 >> CHUNK_SHIFT; cz++) {
+            for (int cx = clip.x0 >> CHUNK_SHIFT; cx <= clip.x1 >> CHUNK_SHIFT; cx++) {
+                ChunkDiff diff;
+                if (!BuildChunkDiff(world, edit, clip, cx, cy, cz, &diff)) continue;
+                ApplyChunkDiff(world, &diff, false);
+
+                if (record.chunkCount >= capacity) {
+                    capacity = capacity ? capacity * 2 : 8;
+                    record.chunks = (ChunkDiff*)RL_REALLOC(record.chunks, capacity * sizeof(ChunkDiff));
+                }
+                record.chunks[record.chunkCount++] = diff;
+                record.voxelCount += diff.voxelCount;
+                record.bytes += sizeof(ChunkDiff) + diff.runCount * 2 * sizeof(unsigned short) + 2 * diff.voxelCount;
+            }
+        }
+    }
+    if (record.chunkCount == 0) return 0;
+
+    PushEditRecord(history, record);
+    return record.voxelCount;
+}
+
+bool CopyRegion(World* world, BlockRegion region, BlockClipboard* clipboard) {
+    if (RegionVolume(region) > EDIT_MAX_VOLUME) return false;
+
+    FreeClipboard(clipboard);
+    clipboard->sizeX = region.x1 - region.x0 + 1;
+    clipboard->sizeY = region.y1 - region.y0 + 1;
+    clipboard->sizeZ = region.z1 - region.z0 + 1;
+    clipboard->voxels = (unsigned char*)RL_CALLOC(RegionVolume(region), 1);
+
+    // Chunk by chunk, so each is looked up once.
+    for (int cy = region.y0 >> CHUNK_SHIFT; cy <= region.y1 >> CHUNK_SHIFT; cy++) {
+        for (int cz = region.z0 >> CHUNK_SHIFT; cz <= region.z1 >> CHUNK_SHIFT; cz++) {
+            for (int cx = region.x0 >> CHUNK_SHIFT; cx <= region.x1 >> CHUNK_SHIFT; cx++) {
+                Chunk* chunk = GetChunk(world, cx, cy, cz);
+                if (chunk == NULL) continue;
+
+                int baseX = cx * CHUNK_SIZE, baseY = cy * CHUNK_SIZE, baseZ = cz * CHUNK_SIZE;
+                int x0 = (region.x0 > baseX) ? region.x0 : baseX, x1 = (region.x1 < baseX + CHUNK_MASK) ? region.x1 : baseX + CHUNK_MASK;
+                int y0 = (region.y0 > baseY) ? region.y0 : baseY, y1 = (region.y1 < baseY + CHUNK_MASK) ? region.y1 : baseY + CHUNK_MASK;
+                int z0 = (region.z0 > baseZ) ? region.z0 : baseZ, z1 = (region.z1 < baseZ + CHUNK_MASK) ? region.z1 : baseZ + CHUNK_MASK;
+                for (int y = y0; y <= y1; y++) {
+                    for (int z = z0; z <= z1; z++) {
+                        unsigned char* row = &clipboard->voxels[((y - region.y0) * clipboard->sizeZ + (z - region.z0)) * clipboard->sizeX];
+                        const unsigned char* source = &chunk->voxels->data[ChunkVoxelIndex(0, y - baseY, z - baseZ)];
+                        memcpy(row + (x0 - region.x0), source + (x0 - baseX), x1 - x0 + 1);
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void FreeClipboard(BlockClipboard* clipboard) {
+    RL_FREE(clipboard->voxels);
+    *clipboard = (BlockClipboard){ 0 };
+}
+
+void InitEditHistory(EditHistory* history, size_t budget) {
+    *history = (EditHistory){ 0 };
+    history->budget = budget;
+}
+
+bool UndoEdit(World* world, EditHistory* history) {
+    if (history->position == 0) return false;
+
+    EditRecord* record = &history->records[--history->position];
+    for (int i = 0; i < record->chunkCount; i++) {
+        ApplyChunkDiff(world, &record->chunks[i], true);
+    }
+    return true;
+}
+
+bool RedoEdit(World* world, EditHistory* history) {
+    if (history->position == history->count) return false;
+
+    EditRecord* record = &history->records[history->position++];
+    for (int i = 0; i < record->chunkCount; i++) {
+        ApplyChunkDiff(world, &record->chunks[i], false);
+    }
+    return true;
+}
+
+void FreeEditHistory(EditHistory* history) {
+    for (int i = 0; i < history->count; i++) {
+        FreeEditRecord(&history->records[i]);
+    }
+    RL_FREE(history->records);
+    *history = (EditHistory){ 0 };
+}
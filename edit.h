@@ -0,0 +1,84 @@
+#ifndef EDIT_H
+#define EDIT_H
+
+#include "world.h"
+#include <stddef.h>
+
+#define EDIT_MAX_VOLUME (128 * 128 * 128)
+#define EDIT_HISTORY_BUDGET (16 * 1024 * 1024)
+
+typedef enum {
+    EDIT_FILL = 0,
+    EDIT_HOLLOW,
+    EDIT_REPLACE,
+    EDIT_PASTE
+} EditKind;
+
+// Inclusive cell bounds with min <= max on every axis.
+typedef struct {
+    int x0, y0, z0;
+    int x1, y1, z1;
+} BlockRegion;
+
+// Voxels are stored x fastest, then z, then y, like a chunk.
+typedef struct {
+    int sizeX, sizeY, sizeZ;
+    unsigned char* voxels;
+} BlockClipboard;
+
+// Hollow sets the region's outer shell to type and clears the inside;
+// replace only changes cells holding match. A paste region must have the
+// clipboard's size.
+typedef struct {
+    EditKind kind;
+    BlockRegion region;
+    BlockType type;
+    BlockType match;
+    const BlockClipboard* clipboard;
+} RegionEdit;
+
+// The voxels one edit changed in one chunk, as runs of consecutive voxel
+// indices: runs[2 * i] starts a run of runs[2 * i + 1] voxels. before and
+// after hold one byte per changed voxel and share the runs allocation.
+typedef struct {
+    int cx, cy, cz;
+    int runCount;
+    int voxelCount;
+    unsigned short* runs;
+    unsigned char* before;
+    unsigned char* after;
+} ChunkDiff;
+
+typedef struct {
+    ChunkDiff* chunks;
+    int chunkCount;
+    int voxelCount;
+    size_t bytes;
+} EditRecord;
+
+// records[0, position) can be undone and records[position, count) redone. A
+// new edit drops the redo side; the oldest records go once the diffs exceed
+// budget bytes.
+typedef struct {
+    EditRecord* records;
+    int count;
+    int capacity;
+    int position;
+    size_t bytes;
+    size_t budget;
+} EditHistory;
+
+BlockRegion RegionFromCorners(int ax, int ay, int az, int bx, int by, int bz);
+long long RegionVolume(BlockRegion region);
+BoundingBox RegionBox(BlockRegion region);
+
+int ApplyRegionEdit(World* world, EditHistory* history, const RegionEdit* edit);
+bool CopyRegion(World* world, BlockRegion region, BlockClipboard* clipboard);
+void FreeClipboard(BlockClipboard* clipboard);
+
+void InitEditHistory(EditHistory* history, size_t budget);
+bool UndoEdit(World* world, EditHistory* history);
+bool RedoEdit(World* world, EditHistory* history);
+void FreeEditHistory(EditHistory* history);
+
+#endif
@@ -0,0 +1,324 @@
+#include "entity.h"
+#include "physics.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if ENTITY_SIMD
+#include <emmintrin.h>
+#endif
+
+bool FallsWithGravity(BlockType type) {
+    return type == BLOCK_SAND || type == BLOCK_GRAVEL;
+}
+
+void InitEntitySet(EntitySet* set) {
+    *set = (EntitySet){ 0 };
+}
+
+void GrowEntitySet(EntitySet* set) {
+    set->capacity = set->capacity ? set->capacity * 2 : 256;
+    float** floats[] = { &set->x, &set->y, &set->z, &set->vx, &set->vy, &set->vz, &set->halfWidth, &set->halfHeight, &set->age };
+    for (int i = 0; i < (int)(sizeof(floats) / sizeof(floats[0])); i++) {
+        *floats[i] = (float*)RL_REALLOC(*floats[i], set->capacity * sizeof(float));
+    }
+    unsigned char** bytes[] = { &set->kind, &set->type, &set->grounded };
+    for (int i = 0; i < (int)(sizeof(bytes) / sizeof(bytes[0])); i++) {
+        *bytes[i] = (unsigned char*)RL_REALLOC(*bytes[i], set->capacity);
+    }
+}
+
+int SpawnEntity(EntitySet* set, EntityKind kind, BlockType type, Vector3 position, Vector3 velocity) {
+    if (set->count == set->capacity) GrowEntitySet(set);
+    int i = set->count++;
+    float half = (kind == ENTITY_ITEM) ? ENTITY_ITEM_SIZE / 2.0f : 0.5f;
+    set->x[i] = position.x;
+    set->y[i] = position.y;
+    set->z[i] = position.z;
+    set->vx[i] = velocity.x;
+    set->vy[i] = velocity.y;
+    set->vz[i] = velocity.z;
+    set->halfWidth[i] = half;
+    set->halfHeight[i] = half;
+    set->age[i] = 0.0f;
+    set->kind[i] = (unsigned char)kind;
+    set->type[i] = (unsigned char)type;
+    set->grounded[i] = 0;
+    return i;
+}
+
+// Items pop up out of the cell in a direction picked from its coordinates,
+// so a replay scatters them the same way.
+int SpawnItem(EntitySet* set, BlockType type, int x, int y, int z) {
+    unsigned int hash = ((unsigned int)x * 73856093u) ^ ((unsigned int)y * 19349663u) ^ ((unsigned int)z * 83492791u);
+    float angle = (float)(hash & 0xFFFF) * (2.0f * PI / 65536.0f);
+    Vector3 velocity = { cosf(angle) * ENTITY_ITEM_SCATTER, ENTITY_ITEM_POP_SPEED, sinf(angle) * ENTITY_ITEM_SCATTER };
+    return SpawnEntity(set, ENTITY_ITEM, type, CellCenter(x, y, z), velocity);
+}
+
+// Moves the last entity into the gap, so indices past index change.
+void RemoveEntity(EntitySet* set, int index) {
+    int last = --set->count;
+    set->x[index] = set->x[last];
+    set->y[index] = set->y[last];
+    set->z[index] = set->z[last];
+    set->vx[index] = set->vx[last];
+    set->vy[index] = set->vy[last];
+    set->vz[index] = set->vz[last];
+    set->halfWidth[index] = set->halfWidth[last];
+    set->halfHeight[index] = set->halfHeight[last];
+    set->age[index] = set->age[last];
+    set->kind[index] = set->kind[last];
+    set->type[index] = set->type[last];
+    set->grounded[index] = set->grounded[last];
+}
+
+void FreeEntitySet(EntitySet* set) {
+    RL_FREE(set->x);
+    RL_FREE(set->y);
+    RL_FREE(set->z);
+    RL_FREE(set->vx);
+    RL_FREE(set->vy);
+    RL_FREE(set->vz);
+    RL_FREE(set->halfWidth);
+    RL_FREE(set->halfHeight);
+    RL_FREE(set->age);
+    RL_FREE(set->kind);
+    RL_FREE(set->type);
+    RL_FREE(set->grounded);
+    *set = (EntitySet){ 0 };
+}
+
+// One step for entities [first, last). Sideways moves probe the cell at the
+// leading edge, at the height of the box center, and stop dead against it;
+// the vertical move probes the cell under the bottom (or over the top) at
+// the center column and lands on it. Steps are short enough that no entity
+// crosses more than one cell boundary per axis. Falling, the cell the bottom
+// starts in is probed first, so an entity lands on a block that appeared
+// around it instead of sinking through.
+void StepEntityRange(EntitySet* set, World* world, int first, int last, float dt) {
+    const float friction = fmaxf(0.0f, 1.0f - ENTITY_ITEM_FRICTION * dt);
+    for (int i = first; i < last; i++) {
+        float x = set->x[i], y = set->y[i], z = set->z[i];
+        float vx = set->vx[i], vy = set->vy[i], vz = set->vz[i];
+        float hw = set->halfWidth[i], hh = set->halfHeight[i];
+        int cellY = (int)floorf(y);
+
+        vy = fmaxf(vy + GRAVITY * dt, -ENTITY_MAX_FALL_SPEED);
+
+        float nx = x + vx * dt;
+        if (vx != 0.0f && IsSolidCell(world, (int)floorf(nx + (vx > 0.0f ? hw : -hw) + 0.5f), cellY, (int)floorf(z + 0.5f))) vx = 0.0f;
+        else x = nx;
+        float nz = z + vz * dt;
+        if (vz != 0.0f && IsSolidCell(world, (int)floorf(x + 0.5f), cellY, (int)floorf(nz + (vz > 0.0f ? hw : -hw) + 0.5f))) vz = 0.0f;
+        else z = nz;
+
+        float ny = y + vy * dt;
+        bool down = vy < 0.0f;
+        float probeY = floorf(down ? ny - hh : ny + hh);
+        float fromY = floorf(y - hh);
+        int column = (int)floorf(x + 0.5f), row = (int)floorf(z + 0.5f);
+        bool hit = down && fromY != probeY && IsSolidCell(world, column, (int)fromY, row);
+        if (hit) probeY = fromY;
+        else hit = IsSolidCell(world, column, (int)probeY, row);
+        bool landed = hit && down;
+        if (landed) ny = probeY + 1.0f + hh;
+        else if (hit) ny = y;
+        if (hit) vy = 0.0f;
+        if (landed) {
+            vx *= friction;
+            vz *= friction;
+        }
+
+        set->x[i] = x;
+        set->y[i] = ny;
+        set->z[i] = z;
+        set->vx[i] = vx;
+        set->vy[i] = vy;
+        set->vz[i] = vz;
+        set->age[i] += dt;
+        set->grounded[i] = landed;
+    }
+}
+
+#if ENTITY_SIMD
+__m128 FloorPs(__m128 v) {
+    __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(v));
+    return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, v), _mm_set1_ps(1.0f)));
+}
+
+__m128 SelectPs(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// Probes the cells for the lanes set in active and returns an all-ones lane
+// for every solid one. Cell lookups stay scalar; everything around them is
+// done a batch at a time.
+__m128 ProbeCells(World* world, __m128 active, __m128 x, __m128 y, __m128 z) {
+    int cx[ENTITY_BATCH], cy[ENTITY_BATCH], cz[ENTITY_BATCH];
+    _mm_storeu_si128((__m128i*)cx, _mm_cvttps_epi32(FloorPs(x)));
+    _mm_storeu_si128((__m128i*)cy, _mm_cvttps_epi32(FloorPs(y)));
+    _mm_storeu_si128((__m128i*)cz, _mm_cvttps_epi32(FloorPs(z)));
+    int lanes = _mm_movemask_ps(active);
+    int solid[ENTITY_BATCH];
+    for (int l = 0; l < ENTITY_BATCH; l++) {
+        solid[l] = ((lanes >> l) & 1) && IsSolidCell(world, cx[l], cy[l], cz[l]) ? -1 : 0;
+    }
+    return _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)solid));
+}
+
+// StepEntityRange on ENTITY_BATCH entities at a time, with the same
+// arithmetic in the same order; the tail is left to the scalar path.
+void StepEntityBatches(EntitySet* set, World* world, float dt) {
+    const __m128 step = _mm_set1_ps(dt);
+    const __m128 gravity = _mm_set1_ps(GRAVITY * dt);
+    const __m128 maxFall = _mm_set1_ps(-ENTITY_MAX_FALL_SPEED);
+    const __m128 friction = _mm_set1_ps(fmaxf(0.0f, 1.0f - ENTITY_ITEM_FRICTION * dt));
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 all = _mm_cmpeq_ps(zero, zero);
+
+    int batched = set->count - set->count % ENTITY_BATCH;
+    for (int i = 0; i < batched; i += ENTITY_BATCH) {
+        __m128 x = _mm_loadu_ps(set->x + i), y = _mm_loadu_ps(set->y + i), z = _mm_loadu_ps(set->z + i);
+        __m128 vx = _mm_loadu_ps(set->vx + i), vy = _mm_loadu_ps(set->vy + i), vz = _mm_loadu_ps(set->vz + i);
+        __m128 hw = _mm_loadu_ps(set->halfWidth + i), hh = _mm_loadu_ps(set->halfHeight + i);
+        __m128 cellY = FloorPs(y);
+
+        vy = _mm_max_ps(_mm_add_ps(vy, gravity), maxFall);
+
+        __m128 nx = _mm_add_ps(x, _mm_mul_ps(vx, step));
+        __m128 edge = SelectPs(_mm_cmpgt_ps(vx, zero), hw, _mm_sub_ps(zero, hw));
+        __m128 blocked = ProbeCells(world, _mm_cmpneq_ps(vx, zero), _mm_add_ps(_mm_add_ps(nx, edge), half), cellY, _mm_add_ps(z, half));
+        vx = _mm_andnot_ps(blocked, vx);
+        x = SelectPs(blocked, x, nx);
+
+        __m128 nz = _mm_add_ps(z, _mm_mul_ps(vz, step));
+        edge = SelectPs(_mm_cmpgt_ps(vz, zero), hw, _mm_sub_ps(zero, hw));
+        blocked = ProbeCells(world, _mm_cmpneq_ps(vz, zero), _mm_add_ps(x, half), cellY, _mm_add_ps(_mm_add_ps(nz, edge), half));
+        vz = _mm_andnot_ps(blocked, vz);
+        z = SelectPs(blocked, z, nz);
+
+        __m128 ny = _mm_add_ps(y, _mm_mul_ps(vy, step));
+        __m128 down = _mm_cmplt_ps(vy, zero);
+        __m128 probeY = FloorPs(SelectPs(down, _mm_sub_ps(ny, hh), _mm_add_ps(ny, hh)));
+        __m128 fromY = FloorPs(_mm_sub_ps(y, hh));
+        __m128 column = _mm_add_ps(x, half), row = _mm_add_ps(z, half);
+        __m128 hit = ProbeCells(world, _mm_and_ps(down, _mm_cmpneq_ps(fromY, probeY)), column, fromY, row);
+        probeY = SelectPs(hit, fromY, probeY);
+        hit = _mm_or_ps(hit, ProbeCells(world, _mm_andnot_ps(hit, all), column, probeY, row));
+        __m128 landed = _mm_and_ps(hit, down);
+        ny = SelectPs(landed, _mm_add_ps(_mm_add_ps(probeY, one), hh), SelectPs(hit, y, ny));
+        vy = _mm_andnot_ps(hit, vy);
+        vx = SelectPs(landed, _mm_mul_ps(vx, friction), vx);
+        vz = SelectPs(landed, _mm_mul_ps(vz, friction), vz);
+
+        _mm_storeu_ps(set->x + i, x);
+        _mm_storeu_ps(set->y + i, ny);
+        _mm_storeu_ps(set->z + i, z);
+        _mm_storeu_ps(set->vx + i, vx);
+        _mm_storeu_ps(set->vy + i, vy);
+        _mm_storeu_ps(set->vz + i, vz);
+        _mm_storeu_ps(set->age + i, _mm_add_ps(_mm_loadu_ps(set->age + i), step));
+        int lanes = _mm_movemask_ps(landed);
+        for (int l = 0; l < ENTITY_BATCH; l++) set->grounded[i + l] = (lanes >> l) & 1;
+    }
+    StepEntityRange(set, world, batched, set->count, dt);
+}
+#else
+void StepEntityBatches(EntitySet* set, World* world, float dt) {
+    StepEntityRange(set, world, 0, set->count, dt);
+}
+#endif
+
+// Advances every entity by dt in steps of at most ENTITY_TIMESTEP, landing
+// falling blocks after each, then drops items that have expired or fallen
+// out of the world. simd picks the batched path where the build has it.
+void StepEntities(EntitySet* set, World* world, float dt, bool simd) {
+    int steps = (int)ceilf(dt / ENTITY_TIMESTEP);
+    if (steps < 1) return;
+    float step = dt / steps;
+    for (int s = 0; s < steps; s++) {
+        if (simd) StepEntityBatches(set, world, step);
+        else StepEntityRange(set, world, 0, set->count, step);
+        SettleFallingBlocks(set, world);
+    }
+    for (int i = set->count - 1; i >= 0; i--) {
+        if (set->y[i] < RESPAWN_Y_THRESHOLD || (set->kind[i] == ENTITY_ITEM && set->age[i] > ENTITY_ITEM_LIFETIME)) RemoveEntity(set, i);
+    }
+}
+
+// Lets go of the block at the cell if it falls with gravity and has nothing
+// under it, then of every such block stacked on top. Returns the number
+// released.
+int ReleaseFallingBlocks(EntitySet* set, World* world, int x, int y, int z) {
+    int released = 0;
+    for (;; y++) {
+        BlockType type = GetBlock(world, x, y, z);
+        if (!FallsWithGravity(type) || IsSolidCell(world, x, y - 1, z)) break;
+        SetBlock(world, x, y, z, BLOCK_AIR);
+        SpawnEntity(set, ENTITY_FALLING_BLOCK, type, CellCenter(x, y, z), (Vector3){ 0 });
+        released++;
+    }
+    return released;
+}
+
+// An edit can leave gravity blocks unsupported in the cells it changed and
+// in the cells right above them.
+int ReleaseEditedBlocks(EntitySet* set, World* world, const EditRecord* record) {
+    int released = 0;
+    for (int c = 0; c < record->chunkCount; c++) {
+        const ChunkDiff* diff = &record->chunks[c];
+        for (int r = 0; r < diff->runCount; r++) {
+            int start = diff->runs[2 * r];
+            for (int index = start; index < start + diff->runs[2 * r + 1]; index++) {
+                int x = diff->cx * CHUNK_SIZE + (index & CHUNK_MASK);
+                int z = diff->cz * CHUNK_SIZE + ((index >> CHUNK_SHIFT) & CHUNK_MASK);
+                int y = diff->cy * CHUNK_SIZE + (index >> (2 * CHUNK_SHIFT));
+                released += ReleaseFallingBlocks(set, world, x, y, z);
+                released += ReleaseFallingBlocks(set, world, x, y + 1, z);
+            }
+        }
+    }
+    return released;
+}
+
+// Falling blocks that have landed turn back into blocks, or into an item
+// when something has taken their cell meanwhile. Blocks falling together
+// in one column can land on the same cell in one step; the later ones go
+// on top of the pile. Returns the number landed.
+int SettleFallingBlocks(EntitySet* set, World* world) {
+    int settled = 0;
+    for (int i = set->count - 1; i >= 0; i--) {
+        if (set->kind[i] != ENTITY_FALLING_BLOCK || !set->grounded[i]) continue;
+        int x = (int)floorf(set->x[i] + 0.5f);
+        int y = (int)floorf(set->y[i] - set->halfHeight[i] + 0.5f);
+        int z = (int)floorf(set->z[i] + 0.5f);
+        BlockType type = (BlockType)set->type[i];
+        RemoveEntity(set, i);
+        while (FallsWithGravity(GetBlock(world, x, y, z))) y++;
+        if (GetBlock(world, x, y, z) == BLOCK_AIR) SetBlock(world, x, y, z, type);
+        else SpawnItem(set, type, x, y, z);
+        settled++;
+    }
+    return settled;
+}
+
+// Removes the items whose box touches box, by the test in
+// CheckAABBCollision, once they are old enough to pick up. Returns the
+// number picked up.
+int CollectItems(EntitySet* set, BoundingBox box) {
+    int picked = 0;
+    for (int i = set->count - 1; i >= 0; i--) {
+        if (set->kind[i] != ENTITY_ITEM || set->age[i] < ENTITY_PICKUP_DELAY) continue;
+        BoundingBox item = {
+            (Vector3){ set->x[i] - set->halfWidth[i], set->y[i] - set->halfHeight[i], set->z[i] - set->halfWidth[i] },
+            (Vector3){ set->x[i] + set->halfWidth[i], set->y[i] + set->halfHeight[i], set->z[i] + set->halfWidth[i] }
+        };
+        if (!CheckAABBCollision(box, item)) continue;
+        RemoveEntity(set, i);
+        picked++;
+    }
+    return picked;
+}
@@ -0,0 +1,66 @@
+#ifndef ENTITY_H
+#define ENTITY_H
+
+#include "world.h"
+#include "edit.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENTITY_SIMD 1
+#else
+#define ENTITY_SIMD 0
+#endif
+
+#define ENTITY_BATCH 4
+#define ENTITY_TIMESTEP (1.0f / 60.0f)
+#define ENTITY_MAX_FALL_SPEED 40.0f
+#define ENTITY_ITEM_SIZE 0.25f
+#define ENTITY_ITEM_POP_SPEED 5.0f
+#define ENTITY_ITEM_SCATTER 1.5f
+#define ENTITY_ITEM_FRICTION 6.0f
+#define ENTITY_ITEM_LIFETIME 300.0f
+#define ENTITY_PICKUP_DELAY 0.5f
+
+typedef enum {
+    ENTITY_FALLING_BLOCK = 0,
+    ENTITY_ITEM
+} EntityKind;
+
+// Structure of arrays, so the integrator and the collision tests run
+// ENTITY_BATCH entities at a time. Positions are box centers; bounds are
+// half extents, the same on x and z. Boxes follow the cell conventions of
+// CellBox and CheckAABBCollision.
+typedef struct {
+    float* x;
+    float* y;
+    float* z;
+    float* vx;
+    float* vy;
+    float* vz;
+    float* halfWidth;
+    float* halfHeight;
+    float* age;
+    unsigned char* kind;
+    unsigned char* type;
+    unsigned char* grounded;
+    int count;
+    int capacity;
+} EntitySet;
+
+bool FallsWithGravity(BlockType type);
+
+void InitEntitySet(EntitySet* set);
+int SpawnEntity(EntitySet* set, EntityKind kind, BlockType type, Vector3 position, Vector3 velocity);
+int SpawnItem(EntitySet* set, BlockType type, int x, int y, int z);
+void RemoveEntity(EntitySet* set, int index);
+void FreeEntitySet(EntitySet* set);
+
+void StepEntityRange(EntitySet* set, World* world, int first, int last, float dt);
+void StepEntityBatches(EntitySet* set, World* world, float dt);
+void StepEntities(EntitySet* set, World* world, float dt, bool simd);
+
+int ReleaseFallingBlocks(EntitySet* set, World* world, int x, int y, int z);
+int ReleaseEditedBlocks(EntitySet* set, World* world, const EditRecord* record);
+int SettleFallingBlocks(EntitySet* set, World* world);
+int CollectItems(EntitySet* set, BoundingBox box);
+
+#endif
@@ -0,0 +1,120 @@
+#include "entitymesh.h"
+#include "mesher.h"
+#include "raymath.h"
+#include <stdlib.h>
+#include <string.h>
+
+// The scratch page holds the CPU copy of the page being filled. Every cube
+// has the same faces in the same order, so its indices never change.
+void InitEntityMesh(EntityMesh* entityMesh) {
+    *entityMesh = (EntityMesh){ 0 };
+    for (int t = 1; t < BLOCK_TYPE_COUNT; t++) {
+        entityMesh->cubes[t] = GenBlockGeometry((BlockType)t);
+    }
+
+    Mesh* scratch = &entityMesh->scratch;
+    scratch->vertexCount = ENTITY_MESH_PAGE * ENTITY_CUBE_VERTICES;
+    scratch->triangleCount = ENTITY_MESH_PAGE * ENTITY_CUBE_INDICES / 3;
+    scratch->vertices = (float*)RL_CALLOC(scratch->vertexCount * 3, sizeof(float));
+    scratch->texcoords = (float*)RL_CALLOC(scratch->vertexCount * 2, sizeof(float));
+    scratch->texcoords2 = (float*)RL_CALLOC(scratch->vertexCount * 2, sizeof(float));
+    scratch->normals = (float*)RL_CALLOC(scratch->vertexCount * 3, sizeof(float));
+    scratch->colors = (unsigned char*)RL_CALLOC(scratch->vertexCount * 4, sizeof(unsigned char));
+    scratch->indices = (unsigned short*)RL_MALLOC(scratch->triangleCount * 3 * sizeof(unsigned short));
+
+    const unsigned short* cubeIndices = entityMesh->cubes[1].indices;
+    for (int c = 0; c < ENTITY_MESH_PAGE; c++) {
+        for (int k = 0; k < ENTITY_CUBE_INDICES; k++) {
+            scratch->indices[c * ENTITY_CUBE_INDICES + k] = (unsigned short)(cubeIndices[k] + c * ENTITY_CUBE_VERTICES);
+        }
+    }
+}
+
+// The block cube spans -0.5 to 0.5 on x and z and 0 to 1 on y; it is
+// stretched over the entity's box.
+void WriteEntityCube(EntityMesh* entityMesh, const EntitySet* set, int entity, int slot) {
+    const Mesh* cube = &entityMesh->cubes[set->type[entity]];
+    Mesh* scratch = &entityMesh->scratch;
+    int first = slot * ENTITY_CUBE_VERTICES;
+
+    float width = 2.0f * set->halfWidth[entity];
+    float height = 2.0f * set->halfHeight[entity];
+    float bottom = set->y[entity] - set->halfHeight[entity];
+    float* vertices = &scratch->vertices[first * 3];
+    for (int v = 0; v < ENTITY_CUBE_VERTICES; v++) {
+        vertices[v * 3 + 0] = set->x[entity] + cube->vertices[v * 3 + 0] * width;
+        vertices[v * 3 + 1] = bottom + cube->vertices[v * 3 + 1] * height;
+        vertices[v * 3 + 2] = set->z[entity] + cube->vertices[v * 3 + 2] * width;
+    }
+    memcpy(&scratch->texcoords[first * 2], cube->texcoords, ENTITY_CUBE_VERTICES * 2 * sizeof(float));
+    memcpy(&scratch->texcoords2[first * 2], cube->texcoords2, ENTITY_CUBE_VERTICES * 2 * sizeof(float));
+    memcpy(&scratch->normals[first * 3], cube->normals, ENTITY_CUBE_VERTICES * 3 * sizeof(float));
+    memcpy(&scratch->colors[first * 4], cube->colors, ENTITY_CUBE_VERTICES * 4 * sizeof(unsigned char));
+}
+
+// Pages are created the first time a frame needs them and kept; only the
+// part written this frame is sent and drawn.
+void DrawEntityPage(EntityMesh* entityMesh, int page, int count, Material material) {
+    if (page == entityMesh->pageCount) {
+        entityMesh->pages = (Mesh*)RL_REALLOC(entityMesh->pages, (entityMesh->pageCount + 1) * sizeof(Mesh));
+        Mesh mesh = entityMesh->scratch;
+        UploadMesh(&mesh, true);
+
+        // The CPU arrays belong to the scratch page.
+        mesh.vertices = NULL;
+        mesh.texcoords = NULL;
+        mesh.texcoords2 = NULL;
+        mesh.normals = NULL;
+        mesh.colors = NULL;
+        mesh.indices = NULL;
+        entityMesh->pages[entityMesh->pageCount++] = mesh;
+    }
+
+    const Mesh* scratch = &entityMesh->scratch;
+    Mesh* mesh = &entityMesh->pages[page];
+    int vertexCount = count * ENTITY_CUBE_VERTICES;
+    UpdateMeshBuffer(*mesh, 0, scratch->vertices, vertexCount * 3 * sizeof(float), 0);
+    UpdateMeshBuffer(*mesh, 1, scratch->texcoords, vertexCount * 2 * sizeof(float), 0);
+    UpdateMeshBuffer(*mesh, 2, scratch->normals, vertexCount * 3 * sizeof(float), 0);
+    UpdateMeshBuffer(*mesh, 3, scratch->colors, vertexCount * 4 * sizeof(unsigned char), 0);
+    UpdateMeshBuffer(*mesh, 5, scratch->texcoords2, vertexCount * 2 * sizeof(float), 0);
+    mesh->vertexCount = vertexCount;
+    mesh->triangleCount = count * ENTITY_CUBE_INDICES / 3;
+    DrawMesh(*mesh, material, MatrixIdentity());
+    entityMesh->callsLastFrame++;
+}
+
+void DrawEntities(EntityMesh* entityMesh, const EntitySet* set, const Frustum* frustum, Material material) {
+    entityMesh->drawnLastFrame = 0;
+    entityMesh->callsLastFrame = 0;
+
+    int page = 0, slot = 0;
+    for (int i = 0; i < set->count; i++) {
+        float hw = set->halfWidth[i], hh = set->halfHeight[i];
+        BoundingBox box = {
+            { set->x[i] - hw, set->y[i] - hh, set->z[i] - hw },
+            { set->x[i] + hw, set->y[i] + hh, set->z[i] + hw }
+        };
+        if (!IsBoxInFrustum(frustum, box)) continue;
+
+        WriteEntityCube(entityMesh, set, i, slot++);
+        entityMesh->drawnLastFrame++;
+        if (slot == ENTITY_MESH_PAGE) {
+            DrawEntityPage(entityMesh, page++, slot, material);
+            slot = 0;
+        }
+    }
+    if (slot > 0) DrawEntityPage(entityMesh, page, slot, material);
+}
+
+void UnloadEntityMesh(EntityMesh* entityMesh) {
+    for (int t = 1; t < BLOCK_TYPE_COUNT; t++) {
+        FreeMeshGeometry(&entityMesh->cubes[t]);
+    }
+    FreeMeshGeometry(&entityMesh->scratch);
+    for (int p = 0; p < entityMesh->pageCount; p++) {
+        UnloadMesh(entityMesh->pages[p]);
+    }
+    RL_FREE(entityMesh->pages);
+    *entityMesh = (EntityMesh){ 0 };
+}
@@ -0,0 +1,32 @@
+#ifndef ENTITYMESH_H
+#define ENTITYMESH_H
+
+#include "entity.h"
+#include "culling.h"
+
+#define ENTITY_CUBE_VERTICES 24
+#define ENTITY_CUBE_INDICES 36
+// Entities per draw call; 24 vertices each stays within 16-bit indices.
+#define ENTITY_MESH_PAGE 2048
+
+// Entities outside the view frustum are skipped. The rest are written into
+// one page of geometry at a time: each entity is its block's cube, scaled to
+// its box. Each page is a dynamic mesh, uploaded once and refilled every
+// frame, so the number of draw calls grows by one per ENTITY_MESH_PAGE
+// visible entities.
+typedef struct {
+    Mesh cubes[BLOCK_TYPE_COUNT];
+    Mesh scratch;
+    Mesh* pages;
+    int pageCount;
+
+    int drawnLastFrame;
+    int callsLastFrame;
+} EntityMesh;
+
+void InitEntityMesh(EntityMesh* entityMesh);
+void WriteEntityCube(EntityMesh* entityMesh, const EntitySet* set, int entity, int slot);
+void DrawEntities(EntityMesh* entityMesh, const EntitySet* set, const Frustum* frustum, Material material);
+void UnloadEntityMesh(EntityMesh* entityMesh);
+
+#endif
@@ -0,0 +1,233 @@
+#include "input.h"
+#include "save.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Every key the game reads, other than the block selection keys, whose
+// effect is stored as selectedBlock instead. At most 32.
+const int inputKeys[] = {
+    KEY_W, KEY_A, KEY_S, KEY_D, KEY_SPACE,
+    KEY_LEFT_CONTROL, KEY_RIGHT_CONTROL, KEY_LEFT_SHIFT, KEY_RIGHT_SHIFT,
+    KEY_O, KEY_F3, KEY_F4, KEY_F5, KEY_BACKSPACE,
+    KEY_Q, KEY_E, KEY_G, KEY_Z, KEY_Y, KEY_F, KEY_H, KEY_R, KEY_X, KEY_C, KEY_V
+};
+#define INPUT_KEY_COUNT ((int)(sizeof(inputKeys) / sizeof(inputKeys[0])))
+
+int InputKeyBit(int key) {
+    for (int i = 0; i < INPUT_KEY_COUNT; i++) {
+        if (inputKeys[i] == key) return i;
+    }
+    return -1;
+}
+
+InputFrame PollInput(int selectedBlock) {
+    InputFrame frame = { 0 };
+    for (int i = 0; i < INPUT_KEY_COUNT; i++) {
+        if (IsKeyDown(inputKeys[i])) frame.down |= 1u << i;
+        if (IsKeyPressed(inputKeys[i])) frame.pressed |= 1u << i;
+    }
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) frame.buttons |= 1 << MOUSE_BUTTON_LEFT;
+    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) frame.buttons |= 1 << MOUSE_BUTTON_RIGHT;
+
+    Vector2 mouse = GetMousePosition();
+    frame.mouseInWindow = mouse.x >= 0 && mouse.x < GetScreenWidth() && mouse.y >= 0 && mouse.y < GetScreenHeight();
+    frame.mouseDelta = GetMouseDelta();
+    frame.selectedBlock = selectedBlock;
+    return frame;
+}
+
+bool InputDown(const InputFrame* input, int key) {
+    int bit = InputKeyBit(key);
+    return bit >= 0 && (input->down >> bit) & 1;
+}
+
+bool InputPressed(const InputFrame* input, int key) {
+    int bit = InputKeyBit(key);
+    return bit >= 0 && (input->pressed >> bit) & 1;
+}
+
+bool InputMousePressed(const InputFrame* input, int button) {
+    return (input->buttons >> button) & 1;
+}
+
+// Held keys and the selected block are stored only when they change; the
+// rest only when nonzero.
+void RecordInputFrame(InputRecording* recording, const InputFrame* frame) {
+    if (recording->size + INPUT_MAX_FRAME_SIZE > recording->capacity) {
+        recording->capacity = recording->capacity ? recording->capacity * 2 : 64 * 1024;
+        recording->data = (unsigned char*)RL_REALLOC(recording->data, recording->capacity);
+    }
+    const InputFrame* last = &recording->last;
+    unsigned char* out = recording->data + recording->size;
+    unsigned char* flags = out++;
+
+    *flags = frame->mouseInWindow ? INPUT_MOUSE_IN_WINDOW : 0;
+    if (frame->down != last->down) {
+        *flags |= INPUT_HAS_DOWN;
+        PutU32(out, frame->down);
+        out += 4;
+    }
+    if (frame->pressed != 0) {
+        *flags |= INPUT_HAS_PRESSED;
+        PutU32(out, frame->pressed);
+        out += 4;
+    }
+    if (frame->buttons != 0) {
+        *flags |= INPUT_HAS_BUTTONS;
+        *out++ = frame->buttons;
+    }
+    if (frame->mouseDelta.x != 0.0f || frame->mouseDelta.y != 0.0f) {
+        *flags |= INPUT_HAS_MOUSE;
+        memcpy(out, &frame->mouseDelta.x, 4);
+        memcpy(out + 4, &frame->mouseDelta.y, 4);
+        out += 8;
+    }
+    if (frame->selectedBlock != last->selectedBlock || recording->frameCount == 0) {
+        *flags |= INPUT_HAS_BLOCK;
+        *out++ = (unsigned char)frame->selectedBlock;
+    }
+
+    recording->size = out - recording->data;
+    recording->last = *frame;
+    recording->frameCount++;
+}
+
+bool WriteInputRecording(const InputRecording* recording, const char* path) {
+    unsigned char header[INPUT_HEADER_SIZE];
+    memcpy(header, INPUT_MAGIC, 4);
+    PutU32(header + 4, INPUT_VERSION);
+    PutU32(header + 8, INPUT_FRAME_RATE);
+    PutU32(header + 12, recording->seed);
+    PutU32(header + 16, (uint32_t)recording->viewRadius);
+    PutU32(header + 20, recording->terrain ? INPUT_FLAG_TERRAIN : 0);
+    PutU32(header + 24, (uint32_t)recording->lodRadius);
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) return false;
+    bool ok = fwrite(header, 1, INPUT_HEADER_SIZE, file) == INPUT_HEADER_SIZE;
+    ok = ok && (recording->size == 0 || fwrite(recording->data, 1, recording->size, file) == recording->size);
+    return fclose(file) == 0 && ok;
+}
+
+bool LoadInputRecording(InputRecording* recording, const char* path) {
+    *recording = (InputRecording){ 0 };
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return false;
+
+    // Version 1 files end the header before the LOD radius, and were all
+    // recorded without reduced detail.
+    unsigned char header[INPUT_HEADER_SIZE] = { 0 };
+    bool ok = fread(header, 1, INPUT_HEADER_V1_SIZE, file) == INPUT_HEADER_V1_SIZE && memcmp(header, INPUT_MAGIC, 4) == 0 &&
+              GetU32(header + 8) == INPUT_FRAME_RATE;
+    uint32_t version = GetU32(header + 4);
+    if (version == INPUT_VERSION) {
+        ok = ok && fread(header + INPUT_HEADER_V1_SIZE, 1, INPUT_HEADER_SIZE - INPUT_HEADER_V1_SIZE, file) == INPUT_HEADER_SIZE - INPUT_HEADER_V1_SIZE;
+    } else if (version != 1) {
+        ok = false;
+    }
+    long start = ftell(file);
+    ok = ok && fseek(file, 0, SEEK_END) == 0;
+    long end = ftell(file);
+    ok = ok && start >= 0 && end >= start && fseek(file, start, SEEK_SET) == 0;
+    if (ok) {
+        recording->size = recording->capacity = (size_t)(end - start);
+        recording->data = (unsigned char*)RL_MALLOC(recording->size + 1);
+        ok = fread(recording->data, 1, recording->size, file) == recording->size;
+    }
+    fclose(file);
+    if (!ok) {
+        FreeInputRecording(recording);
+        return false;
+    }
+
+    recording->seed = GetU32(header + 12);
+    recording->viewRadius = (int)GetU32(header + 16);
+    recording->terrain = (GetU32(header + 20) & INPUT_FLAG_TERRAIN) != 0;
+    recording->lodRadius = (int)GetU32(header + 24);
+    return true;
+}
+
+// Returns false at the end of the recording, or at a truncated frame.
+bool NextInputFrame(InputRecording* recording, InputFrame* frame) {
+    const unsigned char* data = recording->data;
+    size_t size = recording->size;
+    size_t pos = recording->position;
+    if (pos >= size) return false;
+
+    unsigned char flags = data[pos++];
+    size_t needed = ((flags & INPUT_HAS_DOWN) ? 4 : 0) + ((flags & INPUT_HAS_PRESSED) ? 4 : 0) +
+                    ((flags & INPUT_HAS_BUTTONS) ? 1 : 0) + ((flags & INPUT_HAS_MOUSE) ? 8 : 0) + ((flags & INPUT_HAS_BLOCK) ? 1 : 0);
+    if (size - pos < needed) return false;
+
+    InputFrame next = { 0 };
+    next.down = recording->last.down;
+    next.selectedBlock = recording->last.selectedBlock;
+    next.mouseInWindow = (flags & INPUT_MOUSE_IN_WINDOW) != 0;
+    if (flags & INPUT_HAS_DOWN) {
+        next.down = GetU32(data + pos);
+        pos += 4;
+    }
+    if (flags & INPUT_HAS_PRESSED) {
+        next.pressed = GetU32(data + pos);
+        pos += 4;
+    }
+    if (flags & INPUT_HAS_BUTTONS) next.buttons = data[pos++];
+    if (flags & INPUT_HAS_MOUSE) {
+        memcpy(&next.mouseDelta.x, data + pos, 4);
+        memcpy(&next.mouseDelta.y, data + pos + 4, 4);
+        pos += 8;
+    }
+    if (flags & INPUT_HAS_BLOCK) next.selectedBlock = data[pos++];
+
+    recording->position = pos;
+    recording->last = next;
+    recording->frameCount++;
+    *frame = next;
+    return true;
+}
+
+void FreeInputRecording(InputRecording* recording) {
+    RL_FREE(recording->data);
+    *recording = (InputRecording){ 0 };
+}
+
+void AddReplayFrame(ReplayStats* stats, const ProfileFrame* frame) {
+    if (stats->count >= stats->capacity) {
+        stats->capacity = stats->capacity ? stats->capacity * 2 : 1024;
+        stats->frameMs = (float*)RL_REALLOC(stats->frameMs, stats->capacity * sizeof(float));
+    }
+    stats->frameMs[stats->count++] = frame->frameMs;
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++) {
+        stats->stageMs[s] += frame->stageMs[s];
+    }
+}
+
+int CompareFrameMs(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+void PrintReplayStats(const ReplayStats* stats) {
+    if (stats->count == 0) return;
+
+    float* sorted = (float*)RL_MALLOC(stats->count * sizeof(float));
+    memcpy(sorted, stats->frameMs, stats->count * sizeof(float));
+    qsort(sorted, stats->count, sizeof(float), CompareFrameMs);
+    double total = 0.0;
+    for (int i = 0; i < stats->count; i++) total += sorted[i];
+
+    int last = stats->count - 1;
+    printf("replay: %i frames in %.2f s, %.1f fps\n", stats->count, total / 1000.0, stats->count * 1000.0 / total);
+    printf("frame ms: mean %.3f, p50 %.3f, p95 %.3f, p99 %.3f, max %.3f\n",
+        total / stats->count, sorted[last / 2], sorted[last * 95 / 100], sorted[last * 99 / 100], sorted[last]);
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++) {
+        printf("  %-8s %8.3f ms/frame\n", profileStageNames[s], stats->stageMs[s] / stats->count);
+    }
+    RL_FREE(sorted);
+}
+
+void FreeReplayStats(ReplayStats* stats) {
+    RL_FREE(stats->frameMs);
+    *stats = (ReplayStats){ 0 };
+}
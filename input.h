@@ -0,0 +1,81 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "raylib.h"
+#include "profiler.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+// File layout (little-endian):
+//   header  "BOXI", version, frames per second, terrain seed, view radius,
+//           flags, LOD radius (version 2 on)
+//   frames  one per frame: a byte of INPUT_HAS_* flags, then only the fields
+//           they name, in flag order
+// Keys are stored as bits indexed by inputKeys, so an idle frame is a single
+// byte. Recording and replay both start from a fresh world with the stored
+// seed and never touch the save, so a session replays the same way on any
+// build that reads input the same way.
+#define INPUT_MAGIC "BOXI"
+#define INPUT_VERSION 2
+#define INPUT_HEADER_SIZE 28
+#define INPUT_HEADER_V1_SIZE 24
+#define INPUT_FLAG_TERRAIN 1
+#define INPUT_FRAME_RATE 60
+#define INPUT_MAX_FRAME_SIZE 19
+
+#define INPUT_HAS_DOWN 0x01
+#define INPUT_HAS_PRESSED 0x02
+#define INPUT_HAS_BUTTONS 0x04
+#define INPUT_HAS_MOUSE 0x08
+#define INPUT_HAS_BLOCK 0x10
+#define INPUT_MOUSE_IN_WINDOW 0x20
+
+// down and pressed hold one bit per inputKeys entry; buttons one bit per
+// mouse button pressed this frame.
+typedef struct {
+    unsigned int down;
+    unsigned int pressed;
+    unsigned char buttons;
+    bool mouseInWindow;
+    Vector2 mouseDelta;
+    int selectedBlock;
+} InputFrame;
+
+// Frames are kept in memory and written in one go when recording ends.
+typedef struct {
+    unsigned int seed;
+    bool terrain;
+    int viewRadius;
+    int lodRadius;
+
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+    size_t position;
+    InputFrame last;
+    int frameCount;
+} InputRecording;
+
+typedef struct {
+    float* frameMs;
+    int count;
+    int capacity;
+    double stageMs[PROFILE_STAGE_COUNT];
+} ReplayStats;
+
+InputFrame PollInput(int selectedBlock);
+bool InputDown(const InputFrame* input, int key);
+bool InputPressed(const InputFrame* input, int key);
+bool InputMousePressed(const InputFrame* input, int button);
+
+void RecordInputFrame(InputRecording* recording, const InputFrame* frame);
+bool WriteInputRecording(const InputRecording* recording, const char* path);
+bool LoadInputRecording(InputRecording* recording, const char* path);
+bool NextInputFrame(InputRecording* recording, InputFrame* frame);
+void FreeInputRecording(InputRecording* recording);
+
+void AddReplayFrame(ReplayStats* stats, const ProfileFrame* frame);
+void PrintReplayStats(const ReplayStats* stats);
+void FreeReplayStats(ReplayStats* stats);
+
+#endif
@@ -0,0 +1,156 @@
+#include "jobpool.h"
+#include "raylib.h"
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+int DefaultJobThreadCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int count = (int)info.dwNumberOfProcessors;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    // Leave a core for the render loop.
+    return (count > 2) ? count - 1 : 1;
+}
+
+void PushJob(JobDeque* deque, Job job) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->count == deque->capacity) {
+        int capacity = deque->capacity ? deque->capacity * 2 : JOB_DEQUE_INITIAL_CAPACITY;
+        Job* jobs = (Job*)RL_MALLOC(capacity * sizeof(Job));
+        for (int i = 0; i < deque->count; i++) {
+            jobs[i] = deque->jobs[(deque->head + i) % deque->capacity];
+        }
+        RL_FREE(deque->jobs);
+        deque->jobs = jobs;
+        deque->head = 0;
+        deque->capacity = capacity;
+    }
+    deque->jobs[(deque->head + deque->count) % deque->capacity] = job;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+bool PopJob(JobDeque* deque, Job* job) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->count > 0;
+    if (found) {
+        deque->count--;
+        *job = deque->jobs[(deque->head + deque->count) % deque->capacity];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+bool StealJob(JobDeque* deque, Job* job) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->count > 0;
+    if (found) {
+        *job = deque->jobs[deque->head];
+        deque->head = (deque->head + 1) % deque->capacity;
+        deque->count--;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+bool TakeJob(JobPool* pool, int index, Job* job) {
+    if (PopJob(&pool->deques[index], job)) return true;
+    for (int i = 1; i < pool->threadCount; i++) {
+        if (StealJob(&pool->deques[(index + i) % pool->threadCount], job)) return true;
+    }
+    return false;
+}
+
+void* JobWorkerMain(void* arg) {
+    JobWorker* worker = (JobWorker*)arg;
+    JobPool* pool = worker->pool;
+
+    for (;;) {
+        Job job;
+        if (TakeJob(pool, worker->index, &job)) {
+            atomic_fetch_sub(&pool->queued, 1);
+            job.run(job.data);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (atomic_load(&pool->queued) == 0 && !pool->stopping) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        bool stop = pool->stopping;
+        pthread_mutex_unlock(&pool->lock);
+        if (stop) break;
+    }
+    return NULL;
+}
+
+bool StartJobPool(JobPool* pool, int threadCount) {
+    *pool = (JobPool){ 0 };
+    pool->threadCount = (threadCount > 0) ? threadCount : 1;
+    pool->threads = (pthread_t*)RL_CALLOC(pool->threadCount, sizeof(pthread_t));
+    pool->workers = (JobWorker*)RL_CALLOC(pool->threadCount, sizeof(JobWorker));
+    pool->deques = (JobDeque*)RL_CALLOC(pool->threadCount, sizeof(JobDeque));
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+
+    for (int i = 0; i < pool->threadCount; i++) {
+        pthread_mutex_init(&pool->deques[i].lock, NULL);
+        pool->workers[i] = (JobWorker){ pool, i };
+    }
+    for (int i = 0; i < pool->threadCount; i++) {
+        if (pthread_create(&pool->threads[i], NULL, JobWorkerMain, &pool->workers[i]) != 0) {
+            pool->threadCount = i;
+            StopJobPool(pool, NULL);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Jobs from the main thread are dealt round-robin; stealing evens out the rest.
+void SubmitJob(JobPool* pool, JobFunction run, void* data) {
+    int index = pool->nextDeque;
+    pool->nextDeque = (index + 1) % pool->threadCount;
+
+    atomic_fetch_add(&pool->queued, 1);
+    PushJob(&pool->deques[index], (Job){ run, data });
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Jobs that never started are handed to cancel (if given) so their data can
+// be released.
+void StopJobPool(JobPool* pool, JobFunction cancel) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->threadCount; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    for (int i = 0; i < pool->threadCount; i++) {
+        Job job;
+        while (PopJob(&pool->deques[i], &job)) {
+            if (cancel != NULL) cancel(job.data);
+        }
+        pthread_mutex_destroy(&pool->deques[i].lock);
+        RL_FREE(pool->deques[i].jobs);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    RL_FREE(pool->threads);
+    RL_FREE(pool->workers);
+    RL_FREE(pool->deques);
+    *pool = (JobPool){ 0 };
+}
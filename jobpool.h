@@ -0,0 +1,50 @@
+#ifndef JOBPOOL_H
+#define JOBPOOL_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#define JOB_DEQUE_INITIAL_CAPACITY 64
+
+typedef void (*JobFunction)(void* data);
+
+typedef struct {
+    JobFunction run;
+    void* data;
+} Job;
+
+// Each worker owns a deque: it pops its newest job from the bottom and,
+// when it runs dry, steals the oldest job from the top of another worker's.
+typedef struct {
+    pthread_mutex_t lock;
+    Job* jobs;
+    int head, count, capacity;
+} JobDeque;
+
+typedef struct JobPool JobPool;
+
+typedef struct {
+    JobPool* pool;
+    int index;
+} JobWorker;
+
+struct JobPool {
+    pthread_t* threads;
+    JobWorker* workers;
+    JobDeque* deques;
+    int threadCount;
+
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    atomic_int queued;
+    int nextDeque;
+    bool stopping;
+};
+
+int DefaultJobThreadCount(void);
+bool StartJobPool(JobPool* pool, int threadCount);
+void SubmitJob(JobPool* pool, JobFunction run, void* data);
+void StopJobPool(JobPool* pool, JobFunction cancel);
+
+#endif
@@ -0,0 +1,454 @@
+#include "light.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define LIGHT_FACE_DOWN 2
+
+const int lightOffsets[6][3] = { {-1,0,0}, {1,0,0}, {0,-1,0}, {0,1,0}, {0,0,-1}, {0,0,1} };
+
+// Leaves let light through, but sky light loses a level in them like
+// anywhere off the straight path down.
+bool PassesLight(BlockType type) {
+    return type == BLOCK_AIR || type == BLOCK_LEAVES;
+}
+
+int BlockLightEmission(BlockType type) {
+    return (type == BLOCK_LAMP) ? LIGHT_MAX : 0;
+}
+
+// The brighter of the two channels; the mesher shades by this.
+int LightLevel(unsigned char light) {
+    int sky = light >> LIGHT_SKY_SHIFT;
+    int block = light & LIGHT_BLOCK_MASK;
+    return (sky > block) ? sky : block;
+}
+
+int LightChannel(unsigned char light, int shift) {
+    return (light >> shift) & LIGHT_MAX;
+}
+
+void InitLightEngine(LightEngine* engine) {
+    *engine = (LightEngine){ 0 };
+}
+
+void PushLightNode(LightQueue* queue, int x, int y, int z, int value) {
+    if (queue->count == queue->capacity) {
+        queue->capacity = queue->capacity ? queue->capacity * 2 : 1024;
+        queue->nodes = (LightNode*)RL_REALLOC(queue->nodes, queue->capacity * sizeof(LightNode));
+    }
+    queue->nodes[queue->count++] = (LightNode){ x, y, z, (unsigned char)value };
+}
+
+void QueueLightUpdate(LightEngine* engine, int x, int y, int z) {
+    PushLightNode(&engine->updates, x, y, z, 0);
+}
+
+Chunk* FindAirChunk(const LightEngine* engine, int cx, int cy, int cz) {
+    int* index = FindCoord(&engine->airChunkIndex, cx, cy, cz);
+    return (index != NULL) ? engine->airChunks[*index] : NULL;
+}
+
+// Air chunks share one voxel buffer with nothing in it.
+Chunk* AddAirChunk(LightEngine* engine, int cx, int cy, int cz, LightBuffer* light) {
+    if (engine->air == NULL) {
+        engine->air = (VoxelBuffer*)RL_CALLOC(1, sizeof(VoxelBuffer));
+        engine->air->refCount = 1;
+    }
+    if (engine->airChunkCount == engine->airChunkCapacity) {
+        engine->airChunkCapacity = engine->airChunkCapacity ? engine->airChunkCapacity * 2 : CHUNK_TABLE_INITIAL_CAPACITY;
+        engine->airChunks = (Chunk**)RL_REALLOC(engine->airChunks, engine->airChunkCapacity * sizeof(Chunk*));
+    }
+
+    Chunk* chunk = (Chunk*)RL_CALLOC(1, sizeof(Chunk));
+    chunk->cx = cx;
+    chunk->cy = cy;
+    chunk->cz = cz;
+    chunk->index = engine->airChunkCount;
+    chunk->voxels = RetainVoxelBuffer(engine->air);
+    chunk->light = light;
+    engine->airChunks[engine->airChunkCount++] = chunk;
+    InsertCoord(&engine->airChunkIndex, cx, cy, cz, chunk->index);
+    return chunk;
+}
+
+void RemoveAirChunk(LightEngine* engine, Chunk* chunk) {
+    RemoveCoord(&engine->airChunkIndex, chunk->cx, chunk->cy, chunk->cz);
+    Chunk* last = engine->airChunks[--engine->airChunkCount];
+    engine->airChunks[chunk->index] = last;
+    if (last != chunk) {
+        last->index = chunk->index;
+        *FindCoord(&engine->airChunkIndex, last->cx, last->cy, last->cz) = last->index;
+    }
+
+    ReleaseVoxelBuffer(chunk->voxels);
+    if (chunk->light != NULL) ReleaseLightBuffer(chunk->light);
+    RL_FREE(chunk);
+    engine->lastChunk = NULL;
+}
+
+LightBuffer* NewLightBuffer(unsigned char value) {
+    LightBuffer* buffer = (LightBuffer*)RL_MALLOC(sizeof(LightBuffer));
+    buffer->refCount = 1;
+    memset(buffer->data, value, sizeof(buffer->data));
+    return buffer;
+}
+
+// The chunk holding the cell, loaded or held as air, if it is lit. Light
+// passes mostly stay within one chunk, so the last one found is tried first.
+Chunk* FindLitChunk(LightEngine* engine, World* world, int x, int y, int z) {
+    int cx = x >> CHUNK_SHIFT, cy = y >> CHUNK_SHIFT, cz = z >> CHUNK_SHIFT;
+    Chunk* chunk = engine->lastChunk;
+    if (chunk != NULL && chunk->cx == cx && chunk->cy == cy && chunk->cz == cz) return chunk;
+
+    chunk = FindChunk(world, cx, cy, cz);
+    if (chunk == NULL) chunk = FindAirChunk(engine, cx, cy, cz);
+    if (chunk == NULL || chunk->light == NULL) return NULL;
+    engine->lastChunk = chunk;
+    return chunk;
+}
+
+int LitCellIndex(int x, int y, int z) {
+    return ChunkVoxelIndex(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK);
+}
+
+// Faces of the chunks next door read this cell's light through their
+// padding, so they are rebuilt too when it is on the border.
+void SetCellLight(LightEngine* engine, World* world, Chunk* chunk, int x, int y, int z, int shift, int value) {
+    unsigned char* light = &GetWritableLight(chunk)[LitCellIndex(x, y, z)];
+    *light = (unsigned char)((*light & ~(LIGHT_MAX << shift)) | (value << shift));
+    engine->cellsLitLastFrame++;
+
+    int lx = x & CHUNK_MASK, ly = y & CHUNK_MASK, lz = z & CHUNK_MASK;
+    chunk->dirty = true;
+    if (lx == 0) MarkChunkDirty(world, chunk->cx - 1, chunk->cy, chunk->cz);
+    if (lx == CHUNK_MASK) MarkChunkDirty(world, chunk->cx + 1, chunk->cy, chunk->cz);
+    if (ly == 0) MarkChunkDirty(world, chunk->cx, chunk->cy - 1, chunk->cz);
+    if (ly == CHUNK_MASK) MarkChunkDirty(world, chunk->cx, chunk->cy + 1, chunk->cz);
+    if (lz == 0) MarkChunkDirty(world, chunk->cx, chunk->cy, chunk->cz - 1);
+    if (lz == CHUNK_MASK) MarkChunkDirty(world, chunk->cx, chunk->cy, chunk->cz + 1);
+}
+
+// Each removal node holds the light its cell had. A neighbor dimmer than
+// that, or sky light carried straight down from it, got its light through
+// the cell and loses it too; a neighbor at least as bright has its own
+// source and is queued to spread back into the darkened cells. So is open
+// sky past the edge of the loaded world.
+void RemoveLight(LightEngine* engine, World* world, LightQueue* removals, LightQueue* additions, int shift) {
+    while (removals->head < removals->count) {
+        LightNode node = removals->nodes[removals->head++];
+        for (int f = 0; f < 6; f++) {
+            int nx = node.x + lightOffsets[f][0];
+            int ny = node.y + lightOffsets[f][1];
+            int nz = node.z + lightOffsets[f][2];
+            Chunk* chunk = FindLitChunk(engine, world, nx, ny, nz);
+            if (chunk == NULL) {
+                if (shift == LIGHT_SKY_SHIFT && ny >= 0) PushLightNode(additions, nx, ny, nz, LIGHT_MAX);
+                continue;
+            }
+
+            int index = LitCellIndex(nx, ny, nz);
+            int value = LightChannel(chunk->light->data[index], shift);
+            if (value == 0) continue;
+
+            bool straightDown = shift == LIGHT_SKY_SHIFT && f == LIGHT_FACE_DOWN && node.value == LIGHT_MAX;
+            if (value < node.value || (straightDown && value == LIGHT_MAX)) {
+                int emission = (shift == 0) ? BlockLightEmission((BlockType)chunk->voxels->data[index]) : 0;
+                SetCellLight(engine, world, chunk, nx, ny, nz, shift, emission);
+                PushLightNode(removals, nx, ny, nz, value);
+                if (emission > 0) PushLightNode(additions, nx, ny, nz, emission);
+            } else {
+                PushLightNode(additions, nx, ny, nz, value);
+            }
+        }
+    }
+    removals->head = removals->count = 0;
+}
+
+// Plain breadth-first flood from every queued node; a cell only takes light
+// brighter than what it has, so each is settled in few visits. Nodes whose
+// cell has since been darkened by a removal spread nothing.
+void SpreadLight(LightEngine* engine, World* world, LightQueue* additions, int shift) {
+    while (additions->head < additions->count) {
+        LightNode node = additions->nodes[additions->head++];
+        if (node.value <= 1) continue;
+        Chunk* source = FindLitChunk(engine, world, node.x, node.y, node.z);
+        if (source != NULL && LightChannel(source->light->data[LitCellIndex(node.x, node.y, node.z)], shift) != node.value) continue;
+        for (int f = 0; f < 6; f++) {
+            int nx = node.x + lightOffsets[f][0];
+            int ny = node.y + lightOffsets[f][1];
+            int nz = node.z + lightOffsets[f][2];
+            Chunk* chunk = FindLitChunk(engine, world, nx, ny, nz);
+            if (chunk == NULL) continue;
+
+            int index = LitCellIndex(nx, ny, nz);
+            BlockType type = (BlockType)chunk->voxels->data[index];
+            if (!PassesLight(type)) continue;
+
+            bool straightDown = shift == LIGHT_SKY_SHIFT && f == LIGHT_FACE_DOWN && node.value == LIGHT_MAX && type == BLOCK_AIR;
+            int value = straightDown ? LIGHT_MAX : node.value - 1;
+            if (LightChannel(chunk->light->data[index], shift) >= value) continue;
+
+            SetCellLight(engine, world, chunk, nx, ny, nz, shift, value);
+            PushLightNode(additions, nx, ny, nz, value);
+        }
+    }
+    additions->head = additions->count = 0;
+}
+
+// One layer of cells across a chunk, at local coordinate layer on the given
+// axis; -1 and CHUNK_SIZE are the layers just outside it.
+void PushLightLayer(LightQueue* queue, int baseX, int baseY, int baseZ, int axis, int layer, int value) {
+    for (int j = 0; j < CHUNK_SIZE; j++) {
+        for (int i = 0; i < CHUNK_SIZE; i++) {
+            int p[3];
+            p[axis] = layer;
+            p[(axis + 1) % 3] = i;
+            p[(axis + 2) % 3] = j;
+            PushLightNode(queue, baseX + p[0], baseY + p[1], baseZ + p[2], value);
+        }
+    }
+}
+
+// The same layer in a lit neighbor, spreading the light it holds.
+void PushNeighborLayer(LightEngine* engine, Chunk* neighbor, int baseX, int baseY, int baseZ, int axis, int layer) {
+    for (int j = 0; j < CHUNK_SIZE; j++) {
+        for (int i = 0; i < CHUNK_SIZE; i++) {
+            int p[3];
+            p[axis] = layer;
+            p[(axis + 1) % 3] = i;
+            p[(axis + 2) % 3] = j;
+            int x = baseX + p[0], y = baseY + p[1], z = baseZ + p[2];
+            unsigned char light = neighbor->light->data[LitCellIndex(x, y, z)];
+            int sky = LightChannel(light, LIGHT_SKY_SHIFT);
+            int block = LightChannel(light, 0);
+            if (sky > 1) PushLightNode(&engine->skyAdditions, x, y, z, sky);
+            if (block > 1) PushLightNode(&engine->blockAdditions, x, y, z, block);
+        }
+    }
+}
+
+// Light from the lit neighbors of a chunk that has just been given its own,
+// for the next spread.
+void PushNeighborLight(LightEngine* engine, World* world, Chunk* chunk) {
+    int baseX = chunk->cx * CHUNK_SIZE, baseY = chunk->cy * CHUNK_SIZE, baseZ = chunk->cz * CHUNK_SIZE;
+    for (int f = 0; f < 6; f++) {
+        int dx = lightOffsets[f][0], dy = lightOffsets[f][1], dz = lightOffsets[f][2];
+        Chunk* neighbor = FindLitChunk(engine, world, baseX + dx * CHUNK_SIZE, baseY + dy * CHUNK_SIZE, baseZ + dz * CHUNK_SIZE);
+        if (neighbor != NULL) {
+            PushNeighborLayer(engine, neighbor, baseX, baseY, baseZ, (dx != 0) ? 0 : (dy != 0) ? 1 : 2, (dx + dy + dz > 0) ? CHUNK_SIZE : -1);
+        }
+    }
+    engine->lastChunk = NULL;
+}
+
+// Empty chunks under one that has just appeared are no longer open sky all
+// through, so they are held as air chunks from here on, starting from the
+// open sky they were and the block light around them.
+void CoverEmptyChunksBelow(LightEngine* engine, World* world, int cx, int cy, int cz) {
+    for (int y = cy - 1; y >= 0; y--) {
+        if (FindChunk(world, cx, y, cz) != NULL || FindAirChunk(engine, cx, y, cz) != NULL) break;
+        Chunk* air = AddAirChunk(engine, cx, y, cz, NewLightBuffer(LIGHT_OPEN_SKY));
+        PushNeighborLight(engine, world, air);
+    }
+}
+
+// Before a chunk is lit its cells count as open sky, or as the air chunk
+// held in its place, and the chunks around it may have taken light from
+// them. That light is removed first, from every border cell, then the chunk
+// fills from its lamps, from lit neighbors and from open sky wherever a
+// neighbor is missing. Below the ground plane is never open sky.
+void LightNewChunk(LightEngine* engine, World* world, Chunk* chunk) {
+    Chunk* air = FindAirChunk(engine, chunk->cx, chunk->cy, chunk->cz);
+    if (air != NULL) RemoveAirChunk(engine, air);
+    GetWritableLight(chunk);
+    engine->chunksLitLastFrame++;
+    MarkNeighborsDirty(world, chunk->cx, chunk->cy, chunk->cz);
+    CoverEmptyChunksBelow(engine, world, chunk->cx, chunk->cy, chunk->cz);
+    int baseX = chunk->cx * CHUNK_SIZE, baseY = chunk->cy * CHUNK_SIZE, baseZ = chunk->cz * CHUNK_SIZE;
+
+    for (int index = 0; index < CHUNK_VOLUME; index++) {
+        int lx = index & CHUNK_MASK;
+        int lz = (index >> CHUNK_SHIFT) & CHUNK_MASK;
+        int ly = index >> (2 * CHUNK_SHIFT);
+        int x = baseX + lx, y = baseY + ly, z = baseZ + lz;
+
+        if (lx == 0 || lx == CHUNK_MASK || ly == 0 || ly == CHUNK_MASK || lz == 0 || lz == CHUNK_MASK) {
+            PushLightNode(&engine->skyRemovals, x, y, z, LIGHT_MAX);
+            if (air != NULL) PushLightNode(&engine->blockRemovals, x, y, z, LIGHT_MAX + 1);
+        }
+        int emission = BlockLightEmission((BlockType)chunk->voxels->data[index]);
+        if (emission > 0) {
+            SetCellLight(engine, world, chunk, x, y, z, 0, emission);
+            PushLightNode(&engine->blockAdditions, x, y, z, emission);
+        }
+    }
+    RemoveLight(engine, world, &engine->skyRemovals, &engine->skyAdditions, LIGHT_SKY_SHIFT);
+    RemoveLight(engine, world, &engine->blockRemovals, &engine->blockAdditions, 0);
+
+    for (int f = 0; f < 6; f++) {
+        int dx = lightOffsets[f][0], dy = lightOffsets[f][1], dz = lightOffsets[f][2];
+        Chunk* neighbor = FindLitChunk(engine, world, baseX + dx * CHUNK_SIZE, baseY + dy * CHUNK_SIZE, baseZ + dz * CHUNK_SIZE);
+        int axis = (dx != 0) ? 0 : (dy != 0) ? 1 : 2;
+        int layer = (dx + dy + dz > 0) ? CHUNK_SIZE : -1;
+        if (neighbor != NULL) {
+            PushNeighborLayer(engine, neighbor, baseX, baseY, baseZ, axis, layer);
+        } else if (baseY + dy >= 0) {
+            PushLightLayer(&engine->skyAdditions, baseX, baseY, baseZ, axis, layer, LIGHT_MAX);
+        }
+    }
+    SpreadLight(engine, world, &engine->skyAdditions, LIGHT_SKY_SHIFT);
+    SpreadLight(engine, world, &engine->blockAdditions, 0);
+}
+
+// A chunk an edit brings back takes over the light held for it, or else the
+// open sky it was, and light from its neighbors spreads in with the next
+// update; the cells the edit filled are queued like any other change. Below
+// the ground plane it starts out dark.
+void LightCreatedChunk(LightEngine* engine, World* world, Chunk* chunk) {
+    Chunk* air = FindAirChunk(engine, chunk->cx, chunk->cy, chunk->cz);
+    if (air != NULL) {
+        chunk->light = air->light;
+        air->light = NULL;
+        RemoveAirChunk(engine, air);
+    } else {
+        chunk->light = NewLightBuffer((chunk->cy >= 0) ? LIGHT_OPEN_SKY : 0);
+        PushNeighborLight(engine, world, chunk);
+    }
+    CoverEmptyChunksBelow(engine, world, chunk->cx, chunk->cy, chunk->cz);
+}
+
+// A chunk dug out completely leaves the world, but its light is held on as
+// an air chunk, so the cells just dug are relit like any others.
+void KeepEmptiedChunk(LightEngine* engine, Chunk* chunk) {
+    if (chunk->light == NULL) return;
+    AddAirChunk(engine, chunk->cx, chunk->cy, chunk->cz, chunk->light);
+    chunk->light = NULL;
+}
+
+// Air chunks go once streaming has dropped every loaded chunk of their
+// column, and read as open sky like the rest of the unloaded world from
+// then on. Block light they passed on is taken back from their whole border,
+// above what any cell can hold, and the border becomes a sky source.
+void DropUnusedAirChunks(LightEngine* engine, World* world) {
+    for (int i = engine->airChunkCount - 1; i >= 0; i--) {
+        Chunk* air = engine->airChunks[i];
+        bool used = false;
+        for (int cy = world->minChunkY; world->hasBounds && cy <= world->maxChunkY && !used; cy++) {
+            used = FindChunk(world, air->cx, cy, air->cz) != NULL;
+        }
+        if (used) continue;
+
+        int baseX = air->cx * CHUNK_SIZE, baseY = air->cy * CHUNK_SIZE, baseZ = air->cz * CHUNK_SIZE;
+        for (int axis = 0; axis < 3; axis++) {
+            for (int layer = 0; layer < CHUNK_SIZE; layer += CHUNK_MASK) {
+                PushLightLayer(&engine->blockRemovals, baseX, baseY, baseZ, axis, layer, LIGHT_MAX + 1);
+                if (air->cy >= 0) PushLightLayer(&engine->skyAdditions, baseX, baseY, baseZ, axis, layer, LIGHT_MAX);
+            }
+        }
+        MarkNeighborsDirty(world, air->cx, air->cy, air->cz);
+        RemoveAirChunk(engine, air);
+    }
+}
+
+// Ambient occlusion reaches across chunk edges and corners, which SetBlock
+// does not mark.
+void MarkCellNeighborhoodDirty(World* world, int x, int y, int z) {
+    int cx0 = (x - 1) >> CHUNK_SHIFT, cx1 = (x + 1) >> CHUNK_SHIFT;
+    int cy0 = (y - 1) >> CHUNK_SHIFT, cy1 = (y + 1) >> CHUNK_SHIFT;
+    int cz0 = (z - 1) >> CHUNK_SHIFT, cz1 = (z + 1) >> CHUNK_SHIFT;
+    if (cx0 == cx1 && cy0 == cy1 && cz0 == cz1) return;
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cz = cz0; cz <= cz1; cz++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                MarkChunkDirty(world, cx, cy, cz);
+            }
+        }
+    }
+}
+
+// Chunks that arrived since the last call are lit first, then every changed
+// cell loses its light and takes it back from its neighbors and its own
+// block, all changes together.
+void UpdateWorldLight(LightEngine* engine, World* world) {
+    engine->lastChunk = NULL;
+    engine->chunksLitLastFrame = 0;
+    engine->cellsLitLastFrame = 0;
+
+    DropUnusedAirChunks(engine, world);
+    for (int i = 0; i < world->chunkCount; i++) {
+        if (world->chunks[i]->light == NULL) LightNewChunk(engine, world, world->chunks[i]);
+    }
+
+    LightQueue* updates = &engine->updates;
+    for (int i = 0; i < updates->count; i++) {
+        LightNode cell = updates->nodes[i];
+        MarkCellNeighborhoodDirty(world, cell.x, cell.y, cell.z);
+        Chunk* chunk = FindLitChunk(engine, world, cell.x, cell.y, cell.z);
+        if (chunk == NULL) continue;
+
+        unsigned char light = chunk->light->data[LitCellIndex(cell.x, cell.y, cell.z)];
+        int sky = LightChannel(light, LIGHT_SKY_SHIFT);
+        int block = LightChannel(light, 0);
+        if (sky > 0) {
+            SetCellLight(engine, world, chunk, cell.x, cell.y, cell.z, LIGHT_SKY_SHIFT, 0);
+            PushLightNode(&engine->skyRemovals, cell.x, cell.y, cell.z, sky);
+        }
+        if (block > 0) {
+            SetCellLight(engine, world, chunk, cell.x, cell.y, cell.z, 0, 0);
+            PushLightNode(&engine->blockRemovals, cell.x, cell.y, cell.z, block);
+        }
+    }
+    RemoveLight(engine, world, &engine->skyRemovals, &engine->skyAdditions, LIGHT_SKY_SHIFT);
+    RemoveLight(engine, world, &engine->blockRemovals, &engine->blockAdditions, 0);
+
+    for (int i = 0; i < updates->count; i++) {
+        LightNode cell = updates->nodes[i];
+        Chunk* chunk = FindLitChunk(engine, world, cell.x, cell.y, cell.z);
+        if (chunk != NULL) {
+            int index = LitCellIndex(cell.x, cell.y, cell.z);
+            int emission = BlockLightEmission((BlockType)chunk->voxels->data[index]);
+            if (emission > LightChannel(chunk->light->data[index], 0)) {
+                SetCellLight(engine, world, chunk, cell.x, cell.y, cell.z, 0, emission);
+                PushLightNode(&engine->blockAdditions, cell.x, cell.y, cell.z, emission);
+            }
+        }
+
+        for (int f = 0; f < 6; f++) {
+            int nx = cell.x + lightOffsets[f][0];
+            int ny = cell.y + lightOffsets[f][1];
+            int nz = cell.z + lightOffsets[f][2];
+            Chunk* neighbor = FindLitChunk(engine, world, nx, ny, nz);
+            if (neighbor == NULL) {
+                if (ny >= 0) PushLightNode(&engine->skyAdditions, nx, ny, nz, LIGHT_MAX);
+                continue;
+            }
+            unsigned char light = neighbor->light->data[LitCellIndex(nx, ny, nz)];
+            if (LightChannel(light, LIGHT_SKY_SHIFT) > 0) PushLightNode(&engine->skyAdditions, nx, ny, nz, LightChannel(light, LIGHT_SKY_SHIFT));
+            if (LightChannel(light, 0) > 0) PushLightNode(&engine->blockAdditions, nx, ny, nz, LightChannel(light, 0));
+        }
+    }
+    updates->count = 0;
+    SpreadLight(engine, world, &engine->skyAdditions, LIGHT_SKY_SHIFT);
+    SpreadLight(engine, world, &engine->blockAdditions, 0);
+    engine->lastChunk = NULL;
+}
+
+void FreeLightQueue(LightQueue* queue) {
+    RL_FREE(queue->nodes);
+    *queue = (LightQueue){ 0 };
+}
+
+void FreeLightEngine(LightEngine* engine) {
+    FreeLightQueue(&engine->updates);
+    FreeLightQueue(&engine->skyRemovals);
+    FreeLightQueue(&engine->blockRemovals);
+    FreeLightQueue(&engine->skyAdditions);
+    FreeLightQueue(&engine->blockAdditions);
+    while (engine->airChunkCount > 0) {
+        RemoveAirChunk(engine, engine->airChunks[engine->airChunkCount - 1]);
+    }
+    RL_FREE(engine->airChunks);
+    FreeCoordMap(&engine->airChunkIndex);
+    if (engine->air != NULL) ReleaseVoxelBuffer(engine->air);
+    *engine = (LightEngine){ 0 };
+}
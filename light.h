@@ -0,0 +1,59 @@
+#ifndef LIGHT_H
+#define LIGHT_H
+
+#include "world.h"
+
+typedef struct {
+    int x, y, z;
+    unsigned char value;
+} LightNode;
+
+// First in, first out; emptied in one go once every node is taken.
+typedef struct {
+    LightNode* nodes;
+    int head;
+    int count;
+    int capacity;
+} LightQueue;
+
+// Sky light comes down from above at LIGHT_MAX and keeps it straight down
+// through air; every other step costs one level, for both channels. Chunks
+// with no blocks are not kept in the world, so the engine holds the light
+// of empty chunks that matter as air chunks: those dug out, and those under
+// a loaded chunk. Any other missing chunk reads as open sky. Changed cells
+// wait in updates until UpdateWorldLight, which takes light away from around
+// all of them in one pass and spreads it back in another, touching only
+// cells whose light came through them. Chunks it writes to are marked dirty,
+// so their meshes are rebuilt with the rest of the frame's changes.
+typedef struct LightEngine {
+    LightQueue updates;
+    LightQueue skyRemovals;
+    LightQueue blockRemovals;
+    LightQueue skyAdditions;
+    LightQueue blockAdditions;
+    Chunk* lastChunk;
+
+    Chunk** airChunks;
+    int airChunkCount;
+    int airChunkCapacity;
+    CoordMap airChunkIndex;
+    VoxelBuffer* air;
+
+    int chunksLitLastFrame;
+    int cellsLitLastFrame;
+} LightEngine;
+
+bool PassesLight(BlockType type);
+int BlockLightEmission(BlockType type);
+int LightLevel(unsigned char light);
+
+void InitLightEngine(LightEngine* engine);
+void QueueLightUpdate(LightEngine* engine, int x, int y, int z);
+Chunk* FindAirChunk(const LightEngine* engine, int cx, int cy, int cz);
+void LightNewChunk(LightEngine* engine, World* world, Chunk* chunk);
+void LightCreatedChunk(LightEngine* engine, World* world, Chunk* chunk);
+void KeepEmptiedChunk(LightEngine* engine, Chunk* chunk);
+void UpdateWorldLight(LightEngine* engine, World* world);
+void FreeLightEngine(LightEngine* engine);
+
+#endif
@@ -0,0 +1,250 @@
+#include "server.h"
+#include "netclient.h"
+#include "jobpool.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Headless load test: runs a server on a thread of this process and drives
+// simulated editors against it over a loopback socket. Each editor walks at
+// random and keeps editing cells around itself, now and then a whole region,
+// so nearby editors receive each other's changes. Editors only parse what
+// they receive; no client world is kept.
+
+#define LOADTEST_SOCKET "box-loadtest.sock"
+#define LOADTEST_DEFAULT_CLIENTS 16
+#define LOADTEST_DEFAULT_SECONDS 20.0f
+#define LOADTEST_DEFAULT_EDIT_RATE 20.0f
+#define LOADTEST_DEFAULT_REGION_RATE 0.2f
+#define LOADTEST_DEFAULT_VIEW_RADIUS 6
+#define LOADTEST_SEED 1
+
+#define LOADTEST_FRAME_RATE 60
+#define LOADTEST_SPAWN_SPREAD 48.0f
+#define LOADTEST_WALK_SPEED 4.3f
+#define LOADTEST_TURN_RATE 1.5f
+#define LOADTEST_EDIT_RANGE 8
+#define LOADTEST_EDIT_HEIGHT 64
+#define LOADTEST_REGION_SIZE 8
+
+typedef struct {
+    int clients;
+    float seconds;
+    float editRate;
+    float regionRate;
+    int viewRadius;
+    int threads;
+    bool flat;
+} LoadTestConfig;
+
+typedef struct {
+    NetClient net;
+    float x, z, heading;
+    float editCredit, regionCredit;
+    uint64_t editsSent;
+
+    bool joined;
+    double joinSeconds;
+    uint64_t joinBytes;
+} Editor;
+
+typedef struct {
+    Server server;
+    atomic_bool stop;
+} ServerThread;
+
+unsigned int NextRandom(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+float RandomFloat(unsigned int* state) {
+    return (NextRandom(state) >> 8) * (1.0f / 16777216.0f);
+}
+
+void* RunServerThread(void* arg) {
+    ServerThread* thread = (ServerThread*)arg;
+    const double tickSeconds = 1.0 / SERVER_TICK_RATE;
+    double nextTick = ServerTime();
+    while (!atomic_load(&thread->stop)) {
+        ServerTick(&thread->server, (float)tickSeconds);
+        double now = ServerTime();
+        nextTick += tickSeconds;
+        if (nextTick < now) nextTick = now;
+        SleepServer(nextTick - now);
+    }
+    return NULL;
+}
+
+// Joined once every column in view has fully arrived.
+bool HasViewColumns(const NetClient* client, int x, int z, int viewRadius) {
+    for (int dz = -viewRadius; dz <= viewRadius; dz++) {
+        for (int dx = -viewRadius; dx <= viewRadius; dx++) {
+            if (!IsNetColumnReady(client, x + dx * CHUNK_SIZE, z + dz * CHUNK_SIZE)) return false;
+        }
+    }
+    return true;
+}
+
+void EditAround(Editor* editor, int size, unsigned int* state) {
+    int x = (int)floorf(editor->x) + (int)(NextRandom(state) % (2 * LOADTEST_EDIT_RANGE + 1)) - LOADTEST_EDIT_RANGE;
+    int y = (int)(NextRandom(state) % LOADTEST_EDIT_HEIGHT);
+    int z = (int)floorf(editor->z) + (int)(NextRandom(state) % (2 * LOADTEST_EDIT_RANGE + 1)) - LOADTEST_EDIT_RANGE;
+    BlockType type = (BlockType)(NextRandom(state) % BLOCK_TYPE_COUNT);
+
+    // The server ignores edits outside held columns, so none are sent.
+    for (int dz = 0; dz < size; dz++) {
+        for (int dx = 0; dx < size; dx++) {
+            if (!IsNetColumnReady(&editor->net, x + dx, z + dz)) continue;
+            for (int dy = 0; dy < size; dy++) {
+                QueueNetEdit(&editor->net, x + dx, y + dy, z + dz, type);
+                editor->editsSent++;
+            }
+        }
+    }
+}
+
+void UpdateEditor(Editor* editor, const LoadTestConfig* config, float deltaTime, double now, double start, unsigned int* state) {
+    editor->heading += (RandomFloat(state) - 0.5f) * 2.0f * LOADTEST_TURN_RATE * deltaTime;
+    editor->x += cosf(editor->heading) * LOADTEST_WALK_SPEED * deltaTime;
+    editor->z += sinf(editor->heading) * LOADTEST_WALK_SPEED * deltaTime;
+    SendNetPosition(&editor->net, (Vector3){ editor->x, (float)LOADTEST_EDIT_HEIGHT, editor->z });
+
+    editor->editCredit += config->editRate * deltaTime;
+    editor->regionCredit += config->regionRate * deltaTime;
+    for (; editor->editCredit >= 1.0f; editor->editCredit -= 1.0f) EditAround(editor, 1, state);
+    for (; editor->regionCredit >= 1.0f; editor->regionCredit -= 1.0f) EditAround(editor, LOADTEST_REGION_SIZE, state);
+
+    UpdateNetClient(&editor->net);
+    if (!editor->joined && HasViewColumns(&editor->net, (int)floorf(editor->x), (int)floorf(editor->z), config->viewRadius)) {
+        editor->joined = true;
+        editor->joinSeconds = now - start;
+        editor->joinBytes = editor->net.connection.bytesReceived;
+    }
+}
+
+bool ParseArgs(int argc, char** argv, LoadTestConfig* config) {
+    for (int i = 1; i < argc; i++) {
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(argv[i], "--clients") == 0 && value) config->clients = atoi(value);
+        else if (strcmp(argv[i], "--seconds") == 0 && value) config->seconds = (float)atof(value);
+        else if (strcmp(argv[i], "--edit-rate") == 0 && value) config->editRate = (float)atof(value);
+        else if (strcmp(argv[i], "--region-rate") == 0 && value) config->regionRate = (float)atof(value);
+        else if (strcmp(argv[i], "--view-radius") == 0 && value) config->viewRadius = atoi(value);
+        else if (strcmp(argv[i], "--threads") == 0 && value) config->threads = atoi(value);
+        else if (strcmp(argv[i], "--flat") == 0) {
+            config->flat = true;
+            continue;
+        } else {
+            fprintf(stderr, "usage: %s [--clients N] [--seconds F] [--edit-rate F] [--region-rate F] [--view-radius N] [--threads N] [--flat]\n", argv[0]);
+            return false;
+        }
+        i++;
+    }
+    return config->clients > 0 && config->clients <= SERVER_MAX_CLIENTS && config->seconds > 0.0f &&
+        config->viewRadius > 0 && config->viewRadius <= SERVER_MAX_VIEW_RADIUS;
+}
+
+int main(int argc, char** argv) {
+    LoadTestConfig config = {
+        LOADTEST_DEFAULT_CLIENTS, LOADTEST_DEFAULT_SECONDS, LOADTEST_DEFAULT_EDIT_RATE, LOADTEST_DEFAULT_REGION_RATE,
+        LOADTEST_DEFAULT_VIEW_RADIUS, DefaultJobThreadCount(), false
+    };
+    if (!ParseArgs(argc, argv, &config)) return 1;
+
+    unlink(LOADTEST_SOCKET);
+    static ServerThread thread;
+    ServerSettings settings = { LOADTEST_SOCKET, NULL, config.flat, LOADTEST_SEED, config.threads };
+    if (!StartServer(&thread.server, settings)) {
+        fprintf(stderr, "could not listen on %s\n", LOADTEST_SOCKET);
+        return 1;
+    }
+    atomic_init(&thread.stop, false);
+    pthread_t serverThread;
+    pthread_create(&serverThread, NULL, RunServerThread, &thread);
+
+    unsigned int state = LOADTEST_SEED;
+    Editor* editors = (Editor*)RL_CALLOC(config.clients, sizeof(Editor));
+    int connected = 0;
+    for (int i = 0; i < config.clients; i++) {
+        Editor* editor = &editors[i];
+        if (!ConnectNetClient(&editor->net, LOADTEST_SOCKET, NULL, config.viewRadius)) continue;
+        editor->x = (RandomFloat(&state) - 0.5f) * LOADTEST_SPAWN_SPREAD;
+        editor->z = (RandomFloat(&state) - 0.5f) * LOADTEST_SPAWN_SPREAD;
+        editor->heading = RandomFloat(&state) * 2.0f * PI;
+        connected++;
+    }
+    printf("load test: %i of %i clients connected, view radius %i, %.1f edits/s and %.2f %i^3 regions/s each, %s terrain\n",
+        connected, config.clients, config.viewRadius, config.editRate, config.regionRate, LOADTEST_REGION_SIZE,
+        config.flat ? "flat" : "generated");
+
+    const double frameSeconds = 1.0 / LOADTEST_FRAME_RATE;
+    double start = ServerTime();
+    double nextFrame = start;
+    double now = start;
+    while (now - start < config.seconds) {
+        for (int i = 0; i < config.clients; i++) {
+            if (editors[i].net.connection.closed) continue;
+            UpdateEditor(&editors[i], &config, (float)frameSeconds, now, start, &state);
+        }
+        nextFrame += frameSeconds;
+        now = ServerTime();
+        if (nextFrame < now) nextFrame = now;
+        SleepServer(nextFrame - now);
+        now = ServerTime();
+    }
+    double elapsed = now - start;
+
+    atomic_store(&thread.stop, true);
+    pthread_join(serverThread, NULL);
+
+    // Bandwidth is split at each client's join: the snapshots of everything
+    // in view first, then the steady stream of changes and new columns.
+    int joined = 0, dropped = 0;
+    double joinSeconds = 0.0, joinBytes = 0.0, steadyDown = 0.0, totalUp = 0.0;
+    double minSteady = INFINITY, maxSteady = 0.0;
+    uint64_t changes = 0, edits = 0;
+    for (int i = 0; i < config.clients; i++) {
+        Editor* editor = &editors[i];
+        if (editor->net.connection.closed) dropped++;
+        totalUp += (double)editor->net.connection.bytesSent / elapsed;
+        changes += editor->net.changesReceived;
+        edits += editor->editsSent;
+        if (!editor->joined) continue;
+
+        joined++;
+        joinSeconds += editor->joinSeconds;
+        joinBytes += (double)editor->joinBytes;
+        double steady = (double)(editor->net.connection.bytesReceived - editor->joinBytes) / (elapsed - editor->joinSeconds);
+        steadyDown += steady;
+        if (steady < minSteady) minSteady = steady;
+        if (steady > maxSteady) maxSteady = steady;
+    }
+    ServerTickStats stats = GetServerTickStats(&thread.server);
+
+    printf("ran %.1f s: %i joined, %i dropped, %llu edits sent, %llu changes received\n",
+        elapsed, joined, dropped, (unsigned long long)edits, (unsigned long long)changes);
+    if (joined > 0) {
+        printf("join: %.2f s, %.1f KB per client\n", joinSeconds / joined, joinBytes / joined / 1024.0);
+        printf("down after join: %.2f KB/s per client (min %.2f, max %.2f)\n",
+            steadyDown / joined / 1024.0, minSteady / 1024.0, maxSteady / 1024.0);
+    }
+    printf("up: %.2f KB/s per client\n", totalUp / config.clients / 1024.0);
+    printf("server tick (last %i): p50 %.3f ms, p99 %.3f ms, max %.3f ms, budget %.1f ms\n",
+        stats.ticks, stats.p50, stats.p99, stats.max, 1000.0f / SERVER_TICK_RATE);
+
+    for (int i = 0; i < config.clients; i++) {
+        CloseNetClient(&editors[i].net);
+    }
+    RL_FREE(editors);
+    StopServer(&thread.server);
+    return 0;
+}
@@ -1,31 +1,48 @@
 #include "raylib.h"
 #include "raymath.h"
 #include "rlgl.h"
+#include "world.h"
+#include "physics.h"
+#include "entity.h"
+#include "entitymesh.h"
+#include "tick.h"
+#include "light.h"
+#include "mesher.h"
+#include "meshjob.h"
+#include "culling.h"
+#include "save.h"
+#include "autosave.h"
+#include "terrain.h"
+#include "stream.h"
+#include "profiler.h"
+#include "edit.h"
+#include "netclient.h"
+#include "input.h"
+#include "resolution.h"
+#include "assets.h"
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define TILE_SIZE 1.0f
-#define BOARD_SIZE 100
+#if ASSET_ATLAS_PIXELS != ATLAS_PIXELS
+#error "assets.h does not match the atlas layout; rebuild it with make"
+#endif
 
-#define GRAVITY -35.0f
-#define JUMP_FORCE 10.0f
-#define RESPAWN_Y_THRESHOLD -10.0f
+#define TILE_SIZE 1.0f
 
-#define CAMERA_HEIGHT 2.0f
-#define CAMERA_SPEED 4.0f
 #define MOUSE_SENSITIVITY 0.003f
-#define PLAYER_RADIUS 0.3f
-#define PLAYER_HEIGHT 2.0f
-#define SPAWN_POSITION (Vector3){ 50.0f, CAMERA_HEIGHT, 50.0f }
 
 #define GHOST_BLOCK_MIN_ALPHA 0.3f
 #define GHOST_BLOCK_MAX_ALPHA 0.7f
 #define GHOST_BLOCK_SPEED 2.0f
 #define CUBE_WIRE_OFFSET 1.001f
+#define OUTLINE_ALPHA 0.6f
 
 #define GROUND_THICKNESS 0.1f
 
+#define SELECTION_COLOR (Color){ 255, 255, 255, 200 }
+
 #define CROSSHAIR_SIZE 10
 #define FPS_TEXT_SIZE 20
 #define FPS_UPDATE_INTERVAL 0.1f
@@ -33,204 +50,252 @@
 #define MAX_FADING_BLOCKS 100
 #define FADE_TIME 0.1f
 
-typedef enum {
-    BLOCK_STONE = 1,
-    BLOCK_GRASS = 2,
-    BLOCK_DIRT = 3,
-    BLOCK_WOOD = 4
-} BlockType;
-
-typedef struct {
-    Vector3 position;
-    bool active;
-    BlockType type;
-} Block;
+#define SAVE_PATH "world.box"
+#define AUTOSAVE_INTERVAL 30.0f
+
+#define DEFAULT_TERRAIN_SEED 1337u
+
+#define PROFILE_CSV_PATH "profile.csv"
+#define PROFILE_TRACE_PATH "profile.json"
+
+// Every block face samples the atlas through the same shader: texcoords
+// repeat once per voxel across merged quads and texcoords2 selects the tile.
+// fract() jumps at every voxel edge, so the mip level is picked from the
+// unwrapped coordinate instead, and capped where a tile is one texel wide.
+// The same fract() gives the distance to the voxel's edge in pixels, which
+// draws the block outlines without any extra geometry; they fade out where a
+// voxel gets too small on screen for the lines to read.
+const char* blockVertexShader =
+    "#version 330\n"
+    "in vec3 vertexPosition;\n"
+    "in vec2 vertexTexCoord;\n"
+    "in vec2 vertexTexCoord2;\n"
+    "in vec4 vertexColor;\n"
+    "uniform mat4 mvp;\n"
+    "out vec2 fragTexCoord;\n"
+    "out vec2 fragTile;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    fragTexCoord = vertexTexCoord;\n"
+    "    fragTile = vertexTexCoord2;\n"
+    "    fragColor = vertexColor;\n"
+    "    gl_Position = mvp * vec4(vertexPosition, 1.0);\n"
+    "}\n";
+
+const char* blockFragmentShader =
+    "#version 330\n"
+    "in vec2 fragTexCoord;\n"
+    "in vec2 fragTile;\n"
+    "in vec4 fragColor;\n"
+    "uniform sampler2D texture0;\n"
+    "uniform vec4 colDiffuse;\n"
+    "uniform float tileScale;\n"
+    "uniform float maxLod;\n"
+    "uniform float outlineAlpha;\n"
+    "out vec4 finalColor;\n"
+    "void main() {\n"
+    "    vec2 uv = (fragTile + fract(fragTexCoord)) * tileScale;\n"
+    "    vec2 texels = fragTexCoord * tileScale * vec2(textureSize(texture0, 0));\n"
+    "    vec2 dx = dFdx(texels);\n"
+    "    vec2 dy = dFdy(texels);\n"
+    "    float lod = clamp(0.5 * log2(max(dot(dx, dx), dot(dy, dy))), 0.0, maxLod);\n"
+    "    finalColor = textureLod(texture0, uv, lod) * colDiffuse * fragColor;\n"
+    "    vec2 pixel = fwidth(fragTexCoord);\n"
+    "    vec2 edge = min(fract(fragTexCoord), 1.0 - fract(fragTexCoord)) / pixel;\n"
+    "    float line = 1.0 - smoothstep(0.5, 1.5, min(edge.x, edge.y));\n"
+    "    line *= 1.0 - smoothstep(0.1, 0.3, max(pixel.x, pixel.y));\n"
+    "    finalColor.rgb = mix(finalColor.rgb, vec3(0.35), line * outlineAlpha);\n"
+    "}\n";
 
 typedef struct {
     Vector3 position;
     float fadeTimer;
     BlockType type;
-    bool active;
 } FadingBlock;
 
-Block* blocks = NULL;
-int blockCount = 0;
-int blockCapacity = 0;
+World world = { 0 };
+LightEngine lightEngine;
+Profiler profiler;
 
-FadingBlock* fadingBlocks = NULL;
+// Every fade lasts FADE_TIME, so they expire in the order they were added:
+// a ring buffer keeps them oldest-first and drops the oldest when full.
+FadingBlock fadingBlocks[MAX_FADING_BLOCKS];
+int fadingBlockHead = 0;
 int fadingBlockCount = 0;
-int fadingBlockCapacity = 0;
+
+// Falling blocks and dropped items. Items picked up are only counted.
+EntitySet entities = { 0 };
+int itemsCollected = 0;
+
+// Grass spreading and decaying. Like falling blocks, offline only.
+BlockTicker ticker = { 0 };
 
 BlockType selectedBlockType = BLOCK_STONE;
 
-bool CheckPlayerCollision(Vector3 playerPos, Block* blocks, int blockCount);
-float FindGroundLevel(Vector3 position, Block* blocks, int blockCount);
-bool IsPlayerSupported(Vector3 playerPos, Block* blocks, int blockCount);
-void _gc();
+Rectangle AtlasTileRect(int tile) {
+    return (Rectangle){ (float)((tile % ATLAS_COLUMNS) * TILE_PIXELS), (float)((tile / ATLAS_COLUMNS) * TILE_PIXELS), TILE_PIXELS, TILE_PIXELS };
+}
 
-void DrawBlockPreview(Texture2D texture) {
+void DrawBlockPreview(Texture2D atlas, int tile) {
     int previewSize = 64;
     int padding = 20;
     int screenWidth = GetScreenWidth();
-    int screenHeight = GetScreenHeight();
 
     Rectangle destRec = { screenWidth - previewSize - padding, padding, previewSize, previewSize };
-    DrawTexturePro(texture, (Rectangle){0, 0, texture.width, texture.height}, destRec, (Vector2){0,0}, 0.0f, WHITE);
+    DrawTexturePro(atlas, AtlasTileRect(tile), destRec, (Vector2){0,0}, 0.0f, WHITE);
 }
 
-bool CheckAABBCollision(BoundingBox box1, BoundingBox box2) {
-    return (box1.min.x <= box2.max.x && box1.max.x >= box2.min.x) &&
-           (box1.min.y <= box2.max.y && box1.max.y >= box2.min.y) &&
-           (box1.min.z <= box2.max.z && box1.max.z >= box2.min.z);
+// The atlas is baked into assets.h by pack.c, already in upload order, so
+// this is a single copy to the GPU with no decoding and no file I/O.
+Texture2D LoadBlockAtlas(void) {
+    Image atlas = { (void*)assetAtlas, ASSET_ATLAS_PIXELS, ASSET_ATLAS_PIXELS, ASSET_ATLAS_MIPMAPS, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    Texture2D texture = LoadTextureFromImage(atlas);
+
+    // With mipmaps, point filtering also picks the nearest level.
+    SetTextureFilter(texture, TEXTURE_FILTER_POINT);
+    SetTextureWrap(texture, TEXTURE_WRAP_CLAMP);
+    return texture;
 }
 
-bool CheckPlayerCollision(Vector3 playerPos, Block* blocks, int blockCount) {
-    BoundingBox playerBox = {
-        (Vector3){ playerPos.x - PLAYER_RADIUS, playerPos.y - PLAYER_HEIGHT / 2.0f, playerPos.z - PLAYER_RADIUS },
-        (Vector3){ playerPos.x + PLAYER_RADIUS, playerPos.y + PLAYER_HEIGHT / 2.0f, playerPos.z + PLAYER_RADIUS }
-    };
-
-    for (int i = 0; i < blockCount; i++) {
-        if (blocks[i].active) {
-            BoundingBox blockBox = {
-                (Vector3){ blocks[i].position.x - 0.5f, blocks[i].position.y - 0.5f, blocks[i].position.z - 0.5f },
-                (Vector3){ blocks[i].position.x + 0.5f, blocks[i].position.y + 0.5f, blocks[i].position.z + 0.5f }
-            };
+Material LoadBlockMaterial(Texture2D atlas) {
+    Material material = LoadMaterialDefault();
+    material.shader = LoadShaderFromMemory(blockVertexShader, blockFragmentShader);
+    material.maps[MATERIAL_MAP_DIFFUSE].texture = atlas;
 
-            if (CheckAABBCollision(playerBox, blockBox)) {
-                return true;
-            }
-        }
-    }
-    return false;
+    float tileScale = 1.0f / ATLAS_COLUMNS;
+    float maxLod = log2f((float)TILE_PIXELS);
+    SetShaderValue(material.shader, GetShaderLocation(material.shader, "tileScale"), &tileScale, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(material.shader, GetShaderLocation(material.shader, "maxLod"), &maxLod, SHADER_UNIFORM_FLOAT);
+    return material;
 }
 
-Vector3 CheckMoveCollision(Vector3 newPos, Block* blocks, int blockCount) {
-    BoundingBox playerBox = {
-        (Vector3){ newPos.x - PLAYER_RADIUS, newPos.y - PLAYER_HEIGHT/2.0f, newPos.z - PLAYER_RADIUS },
-        (Vector3){ newPos.x + PLAYER_RADIUS, newPos.y + PLAYER_HEIGHT/2.0f, newPos.z + PLAYER_RADIUS }
-    };
+Mesh UploadGeometry(Mesh mesh) {
+    UploadMesh(&mesh, false);
 
-    Vector3 correction = {0.0f, 0.0f, 0.0f};
-
-    for (int i = 0; i < blockCount; i++) {
-        if (blocks[i].active) {
-            BoundingBox blockBox = {
-                (Vector3){ blocks[i].position.x - 0.5f, blocks[i].position.y - 0.5f, blocks[i].position.z - 0.5f },
-                (Vector3){ blocks[i].position.x + 0.5f, blocks[i].position.y + 0.5f, blocks[i].position.z + 0.5f }
-            };
+    // Geometry lives on the GPU from here on; drop the CPU copy.
+    FreeMeshGeometry(&mesh);
+    return mesh;
+}
 
-            if (CheckAABBCollision(playerBox, blockBox)) {
-
-                float overlapX = fminf(playerBox.max.x - blockBox.min.x, blockBox.max.x - playerBox.min.x);
-                float overlapY = fminf(playerBox.max.y - blockBox.min.y, blockBox.max.y - playerBox.min.y);
-                float overlapZ = fminf(playerBox.max.z - blockBox.min.z, blockBox.max.z - playerBox.min.z);
-
-                if (overlapX < overlapY && overlapX < overlapZ) {
-                    if (playerBox.max.x - blockBox.min.x < blockBox.max.x - playerBox.min.x) {
-                        correction.x = -overlapX;
-                    } else {
-                        correction.x = overlapX;
-                    }
-                } else if (overlapY < overlapX && overlapY < overlapZ) {
-                    if (playerBox.max.y - blockBox.min.y < blockBox.max.y - playerBox.min.y) {
-                        correction.y = -overlapY;
-                    } else {
-                        correction.y = overlapY;
-                    }
-                } else {
-                    if (playerBox.max.z - blockBox.min.z < blockBox.max.z - playerBox.min.z) {
-                        correction.z = -overlapZ;
-                    } else {
-                        correction.z = overlapZ;
-                    }
-                }
-
-                return correction;
-            }
-        }
+void PushFadingBlock(Vector3 position, BlockType type) {
+    if (fadingBlockCount == MAX_FADING_BLOCKS) {
+        fadingBlockHead = (fadingBlockHead + 1) % MAX_FADING_BLOCKS;
+        fadingBlockCount--;
     }
-    return correction;
+
+    FadingBlock* fading = &fadingBlocks[(fadingBlockHead + fadingBlockCount) % MAX_FADING_BLOCKS];
+    fading->position = position;
+    fading->type = type;
+    fading->fadeTimer = FADE_TIME;
+    fadingBlockCount++;
 }
 
-float FindGroundLevel(Vector3 position, Block* blocks, int blockCount) {
-    float groundLevel = 0.0f;
-    int targetX = (int)roundf(position.x);
-    int targetZ = (int)roundf(position.z);
-
-    if (targetX >= 0 && targetX < BOARD_SIZE && targetZ >= 0 && targetZ < BOARD_SIZE) {
-        for (int i = 0; i < blockCount; i++) {
-            if (blocks[i].active) {
-                if (roundf(blocks[i].position.x) == targetX && roundf(blocks[i].position.z) == targetZ) {
-                    float blockTop = blocks[i].position.y + 0.5f;
-                    if (blockTop > groundLevel) {
-                        groundLevel = blockTop;
-                    }
-                }
-            }
-        }
-        return groundLevel;
-    } else {
-        return -1000.0f;
+// Connected to a server, every local change also goes out as edit intents;
+// remote is NULL otherwise. An undo sends the cells' old values back.
+// Offline, sand and gravel an edit leaves unsupported start to fall; the
+// server keeps no entities, so connected they stay where they are. Block
+// ticks are offline only too.
+void ShareEditRecord(World* world, const EditRecord* record, bool undo, NetClient* remote) {
+    if (remote != NULL) {
+        QueueEditRecord(remote, record, undo);
+        return;
     }
+    ReleaseEditedBlocks(&entities, world, record);
+    NotifyEditRecord(&ticker, world, record);
 }
 
-bool IsPlayerSupported(Vector3 playerPos, Block* blocks, int blockCount) {
-    BoundingBox playerFeetBox = {
-        (Vector3){ playerPos.x - PLAYER_RADIUS, playerPos.y - PLAYER_HEIGHT / 2.0f - 0.1f, playerPos.z - PLAYER_RADIUS },
-        (Vector3){ playerPos.x + PLAYER_RADIUS, playerPos.y - PLAYER_HEIGHT / 2.0f, playerPos.z + PLAYER_RADIUS }
-    };
-
-    for (int i = 0; i < blockCount; i++) {
-        if (blocks[i].active) {
-            BoundingBox blockTopBox = {
-                (Vector3){ blocks[i].position.x - 0.5f, blocks[i].position.y + 0.5f - 0.1f, blocks[i].position.z - 0.5f },
-                (Vector3){ blocks[i].position.x + 0.5f, blocks[i].position.y + 0.5f, blocks[i].position.z + 0.5f }
-            };
+void ApplySharedEdit(World* world, EditHistory* history, const RegionEdit* edit, NetClient* remote) {
+    if (ApplyRegionEdit(world, history, edit) > 0) ShareEditRecord(world, &history->records[history->position - 1], false, remote);
+}
 
-            if (CheckAABBCollision(playerFeetBox, blockTopBox)) {
-                return true;
-            }
-        }
-    }
+void UndoSharedEdit(World* world, EditHistory* history, NetClient* remote) {
+    if (UndoEdit(world, history)) ShareEditRecord(world, &history->records[history->position], true, remote);
+}
 
-    if (playerFeetBox.min.y <= 0.5f && playerFeetBox.max.y >= -0.5f) {
-        if (playerPos.x >= 0.0f && playerPos.x <= BOARD_SIZE && playerPos.z >= 0.0f && playerPos.z <= BOARD_SIZE) {
-            return true;
-        }
-    }
+void RedoSharedEdit(World* world, EditHistory* history, NetClient* remote) {
+    if (RedoEdit(world, history)) ShareEditRecord(world, &history->records[history->position - 1], false, remote);
+}
 
-    return false;
+void UpdateFadingBlocks(float deltaTime) {
+    for (int i = 0; i < fadingBlockCount; i++) {
+        fadingBlocks[(fadingBlockHead + i) % MAX_FADING_BLOCKS].fadeTimer -= deltaTime;
+    }
+    while (fadingBlockCount > 0 && fadingBlocks[fadingBlockHead].fadeTimer <= 0) {
+        fadingBlockHead = (fadingBlockHead + 1) % MAX_FADING_BLOCKS;
+        fadingBlockCount--;
+    }
 }
 
-void _gc() {
-    int newBlockCount = 0;
-    for (int i = 0; i < blockCount; i++) {
-        if (blocks[i].active) {
-            blocks[newBlockCount] = blocks[i];
-            newBlockCount++;
-        }
+int main(int argc, char** argv) {
+    bool flat = false;
+    TerrainSettings terrainSettings = { DEFAULT_TERRAIN_SEED };
+    int terrainThreads = DefaultJobThreadCount();
+    int viewRadius = STREAM_DEFAULT_VIEW_RADIUS;
+    int lodRadius = STREAM_DEFAULT_LOD_RADIUS;
+    const char* tracePath = NULL;
+    const char* serverPath = NULL;
+    const char* recordPath = NULL;
+    const char* replayPath = NULL;
+    bool uncapped = false;
+    int targetFps = 0;
+    InitProfiler(&profiler);
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--flat") == 0) flat = true;
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) terrainSettings.seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) terrainThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--view-radius") == 0 && i + 1 < argc) viewRadius = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--lod-radius") == 0 && i + 1 < argc) lodRadius = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--profile") == 0) profiler.visible = true;
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) tracePath = argv[++i];
+        else if (strcmp(argv[i], "--connect") == 0 && i + 1 < argc) serverPath = argv[++i];
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordPath = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replayPath = argv[++i];
+        else if (strcmp(argv[i], "--uncapped") == 0) uncapped = true;
+        else if (strcmp(argv[i], "--target-fps") == 0 && i + 1 < argc) targetFps = atoi(argv[++i]);
     }
-    blockCount = newBlockCount;
 
-    int newFadingBlockCount = 0;
-    for (int i = 0; i < fadingBlockCount; i++) {
-        if (fadingBlocks[i].active) {
-            fadingBlocks[newFadingBlockCount] = fadingBlocks[i];
-            newFadingBlockCount++;
+    // Recording and replay run on a fixed timestep from a fresh world, wait
+    // for terrain instead of streaming it in the background, and never touch
+    // the save or a server. A replay takes its world settings from the file.
+    InputRecording recording = { 0 };
+    bool replaying = replayPath != NULL;
+    bool fixedStep = replaying || recordPath != NULL;
+    if (replaying) {
+        if (!LoadInputRecording(&recording, replayPath)) {
+            fprintf(stderr, "could not read %s\n", replayPath);
+            return 1;
         }
+        terrainSettings.seed = recording.seed;
+        flat = !recording.terrain;
+        viewRadius = recording.viewRadius;
+        lodRadius = recording.lodRadius;
     }
-    fadingBlockCount = newFadingBlockCount;
-}
+    if (viewRadius < 1) viewRadius = 1;
+    // Chunks within viewRadius columns are drawn in full detail, the rest out
+    // to lodRadius at reduced detail; a lodRadius of viewRadius or less turns
+    // that off.
+    int drawRadius = (lodRadius > viewRadius) ? lodRadius : viewRadius;
+    if (fixedStep) serverPath = NULL;
+    recording.seed = terrainSettings.seed;
+    recording.terrain = !flat;
+    recording.viewRadius = viewRadius;
+    recording.lodRadius = lodRadius;
+    ReplayStats replayStats = { 0 };
 
-int main(void) {
     SetTraceLogLevel(LOG_ERROR);
     SetConfigFlags(FLAG_WINDOW_RESIZABLE);
     InitWindow(800, 600, "box");
+    if (fixedStep) SetTargetFPS(replaying && uncapped ? 0 : INPUT_FRAME_RATE);
 
     int screenWidth = GetScreenWidth();
     int screenHeight = GetScreenHeight();
 
+    // With a target frame rate, the 3D pass is drawn at whatever resolution
+    // holds it and scaled up under the HUD. Fixed-step runs keep the scale
+    // where it starts, so runs stay comparable.
+    DynamicResolution resolution = { 0 };
+    if (targetFps > 0) InitDynamicResolution(&resolution, targetFps, screenWidth, screenHeight);
+
     bool mouseCaptured = true;
     bool skipNextClick = false;
     DisableCursor();
@@ -242,78 +307,114 @@ int main(void) {
     camera.projection = CAMERA_PERSPECTIVE;
 
     Vector3 forward = (Vector3){ 0.0f, 0.0f, 1.0f };
-    float velocityY = 0.0f;
-    bool isGrounded = true;
     float yaw = 0.0f;
     float pitch = 0.0f;
 
     int displayedFPS = 60;
     float fpsUpdateTimer = 0.0f;
 
-    blockCapacity = 100;
-    blocks = (Block*)malloc(blockCapacity * sizeof(Block));
-
-    fadingBlockCapacity = MAX_FADING_BLOCKS;
-    fadingBlocks = (FadingBlock*)malloc(fadingBlockCapacity * sizeof(FadingBlock));
-
-    Texture2D stoneTexture = LoadTexture("stone.png");
-    Texture2D grassTexture = LoadTexture("grass.png");
-    Texture2D dirtTexture = LoadTexture("dirt.png");
-    Texture2D woodTexture = LoadTexture("wood.png");
-
-    SetTextureFilter(grassTexture, TEXTURE_FILTER_POINT);
-    SetTextureFilter(stoneTexture, TEXTURE_FILTER_POINT);
-    SetTextureFilter(dirtTexture, TEXTURE_FILTER_POINT);
-    SetTextureFilter(woodTexture, TEXTURE_FILTER_POINT);
-
-    Material stoneMaterial = LoadMaterialDefault();
-    stoneMaterial.maps[MATERIAL_MAP_DIFFUSE].texture = stoneTexture;
-
-    Material grassMaterial = LoadMaterialDefault();
-    grassMaterial.maps[MATERIAL_MAP_DIFFUSE].texture = grassTexture;
-
-    Material dirtMaterial = LoadMaterialDefault();
-    dirtMaterial.maps[MATERIAL_MAP_DIFFUSE].texture = dirtTexture;
-
-    Material woodMaterial = LoadMaterialDefault();
-    woodMaterial.maps[MATERIAL_MAP_DIFFUSE].texture = woodTexture;
-
-    Material* blockMaterials[5];
-    blockMaterials[BLOCK_STONE] = &stoneMaterial;
-    blockMaterials[BLOCK_GRASS] = &grassMaterial;
-    blockMaterials[BLOCK_DIRT] = &dirtMaterial;
-    blockMaterials[BLOCK_WOOD] = &woodMaterial;
-
-    Texture2D blockTextures[5];
-    blockTextures[BLOCK_STONE] = stoneTexture;
-    blockTextures[BLOCK_GRASS] = grassTexture;
-    blockTextures[BLOCK_DIRT] = dirtTexture;
-    blockTextures[BLOCK_WOOD] = woodTexture;
-
-    Model blockModel = LoadModelFromMesh(GenMeshCube(1.0f, 1.0f, 1.0f));
-    Model ghostBlockModel = LoadModelFromMesh(GenMeshCube(1.0f, 1.0f, 1.0f));
-    Model groundModel = LoadModelFromMesh(GenMeshPlane((float)BOARD_SIZE, (float)BOARD_SIZE, BOARD_SIZE, BOARD_SIZE));
-
-    Material groundMaterial = LoadMaterialDefault();
-    groundMaterial.maps[MATERIAL_MAP_DIFFUSE].texture = grassTexture;
-
-    groundModel.materials[0] = groundMaterial;
-
-    float* texcoords = groundModel.meshes[0].texcoords;
-    int vertices_x = BOARD_SIZE + 1;
-    int vertices_y = BOARD_SIZE + 1;
-
-    for (int i = 0; i < vertices_x; i++) {
-        for (int j = 0; j < vertices_y; j++) {
-            texcoords[2 * (i + j * vertices_x)] = (float)i;
-            texcoords[2 * (i + j * vertices_x) + 1] = (float)j;
+    Player player = { 0 };
+    player.position = SPAWN_POSITION;
+    player.previousPosition = player.position;
+    player.spawnPosition = player.position;
+    float physicsAccumulator = 0.0f;
+
+    double atlasStart = GetTime();
+    Texture2D atlasTexture = LoadBlockAtlas();
+    Material blockMaterial = LoadBlockMaterial(atlasTexture);
+    int outlineLocation = GetShaderLocation(blockMaterial.shader, "outlineAlpha");
+    bool showOutlines = true;
+    float atlasMs = (float)((GetTime() - atlasStart) * 1000.0);
+    bool startupReported = false;
+
+    Mesh blockMeshes[BLOCK_TYPE_COUNT] = { 0 };
+    for (int t = 1; t < BLOCK_TYPE_COUNT; t++) {
+        blockMeshes[t] = UploadGeometry(GenBlockGeometry((BlockType)t));
+    }
+    Mesh groundMesh = UploadGeometry(GenGroundGeometry());
+    EntityMesh entityMesh;
+    InitEntityMesh(&entityMesh);
+
+    ChunkVisibility visibility = { 0 };
+    world.onChunkRemoved = UnloadChunkMesh;
+    InitLightEngine(&lightEngine);
+    world.light = &lightEngine;
+
+    // Chunk geometry is built on workers; the frame only uploads and swaps.
+    MeshBuilder meshBuilder;
+    StartMeshBuilder(&meshBuilder, DefaultJobThreadCount(), MESH_UPLOAD_BUDGET_MS);
+
+    // A saved world brings its own terrain seed; a new one takes it from the
+    // command line. Chunks stream in and out around the player either way,
+    // and the player is held until the spawn column has arrived. Connected
+    // to a server, the world holds only what the server sends and nothing is
+    // generated or saved here.
+    NetClient net = { 0 };
+    NetClient* remote = NULL;
+    if (serverPath != NULL) {
+        if (!ConnectNetClient(&net, serverPath, &world, drawRadius)) {
+            fprintf(stderr, "could not connect to %s\n", serverPath);
+            CloseWindow();
+            return 1;
         }
+        remote = &net;
+    } else if (fixedStep || !OpenWorldSave(&world, SAVE_PATH)) {
+        world.hasTerrain = !flat;
+        world.terrainSeed = terrainSettings.seed;
+    }
+    bool useSave = remote == NULL && !fixedStep;
+    // Replays must tick the same blocks every run, so they get no budget.
+    InitBlockTicker(&ticker, world.terrainSeed, fixedStep ? 0.0f : BLOCK_TICK_BUDGET_MS);
+    TerrainGenerator terrain = { 0 };
+    if (world.hasTerrain) {
+        StartTerrainGenerator(&terrain, (TerrainSettings){ world.terrainSeed }, terrainThreads);
     }
 
-    UpdateMeshBuffer(groundModel.meshes[0], 1, groundModel.meshes[0].texcoords, groundModel.meshes[0].vertexCount * 2 * sizeof(float), 0);
+    ChunkCache cache;
+    InitChunkCache(&cache, CHUNK_CACHE_DEFAULT_BUDGET);
+    cache.hasSave = useSave;
+    world.cache = &cache;
+    ChunkStreamer streamer;
+    InitChunkStreamer(&streamer, drawRadius);
+    bool spawned = false;
+
+    // Clicks and region commands all go through the edit history. The
+    // selection spans the cells picked with Q and E.
+    EditHistory history;
+    InitEditHistory(&history, EDIT_HISTORY_BUDGET);
+    BlockClipboard clipboard = { 0 };
+    int cornerA[3] = { 0 }, cornerB[3] = { 0 };
+    bool hasCornerA = false, hasCornerB = false;
+
+    Autosave autosave = { 0 };
+    float autosaveTimer = 0.0f;
+    double saveStartTime = 0.0;
+    float saveSnapshotMs = 0.0f;
+    float saveTotalMs = 0.0f;
+    bool hasSaveTimes = false;
 
     while (!WindowShouldClose()) {
-        float deltaTime = GetFrameTime();
+        // Everything below reads input only through this frame.
+        InputFrame input;
+        if (replaying) {
+            if (!NextInputFrame(&recording, &input)) break;
+            selectedBlockType = (BlockType)input.selectedBlock;
+        } else {
+            if (IsKeyPressed(KEY_ONE)) selectedBlockType = BLOCK_STONE;
+            if (IsKeyPressed(KEY_TWO)) selectedBlockType = BLOCK_GRASS;
+            if (IsKeyPressed(KEY_THREE)) selectedBlockType = BLOCK_DIRT;
+            if (IsKeyPressed(KEY_FOUR)) selectedBlockType = BLOCK_WOOD;
+            if (IsKeyPressed(KEY_FIVE)) selectedBlockType = BLOCK_LEAVES;
+            if (IsKeyPressed(KEY_SIX)) selectedBlockType = BLOCK_SAND;
+            if (IsKeyPressed(KEY_SEVEN)) selectedBlockType = BLOCK_GRAVEL;
+            if (IsKeyPressed(KEY_EIGHT)) selectedBlockType = BLOCK_LAMP;
+            input = PollInput(selectedBlockType);
+            if (recordPath != NULL) RecordInputFrame(&recording, &input);
+        }
+
+        BeginProfileFrame(&profiler);
+        BeginProfileStage(&profiler, PROFILE_INPUT);
+        float deltaTime = fixedStep ? 1.0f / INPUT_FRAME_RATE : GetFrameTime();
 
         fpsUpdateTimer += deltaTime;
         if (fpsUpdateTimer >= FPS_UPDATE_INTERVAL) {
@@ -324,14 +425,36 @@ int main(void) {
         if (IsWindowResized()) {
             screenWidth = GetScreenWidth();
             screenHeight = GetScreenHeight();
+            if (targetFps > 0) ResizeDynamicResolution(&resolution, screenWidth, screenHeight);
         }
 
-        if (IsKeyPressed(KEY_ONE)) selectedBlockType = BLOCK_STONE;
-        if (IsKeyPressed(KEY_TWO)) selectedBlockType = BLOCK_GRASS;
-        if (IsKeyPressed(KEY_THREE)) selectedBlockType = BLOCK_DIRT;
-        if (IsKeyPressed(KEY_FOUR)) selectedBlockType = BLOCK_WOOD;
+        if (InputPressed(&input, KEY_O)) showOutlines = !showOutlines;
+        if (InputPressed(&input, KEY_F3)) profiler.visible = !profiler.visible;
+        if (InputPressed(&input, KEY_F4)) {
+            WriteProfileCsv(&profiler, PROFILE_CSV_PATH);
+            WriteProfileTrace(&profiler, PROFILE_TRACE_PATH);
+        }
+
+        // Only the snapshot runs here; encoding and writing happen on the
+        // autosave thread and are applied once it finishes. A cache full of
+        // unsaved evicted chunks saves early so it can drop them.
+        BeginProfileStage(&profiler, PROFILE_SAVE);
+        autosaveTimer += deltaTime;
+        if (useSave && (InputPressed(&input, KEY_F5) || (autosaveTimer >= AUTOSAVE_INTERVAL && world.modified) || cache.needsFlush)) {
+            double saveStart = GetTime();
+            if (StartAutosave(&autosave, &world, SAVE_PATH)) {
+                saveSnapshotMs = (float)((GetTime() - saveStart) * 1000.0);
+                saveStartTime = saveStart;
+                autosaveTimer = 0.0f;
+            }
+        }
+        if (PollAutosave(&autosave, &world)) {
+            saveTotalMs = (float)((GetTime() - saveStartTime) * 1000.0);
+            hasSaveTimes = true;
+        }
 
-        if (IsKeyPressed(KEY_BACKSPACE)) {
+        BeginProfileStage(&profiler, PROFILE_INPUT);
+        if (InputPressed(&input, KEY_BACKSPACE)) {
             mouseCaptured = !mouseCaptured;
             if (mouseCaptured) {
                 DisableCursor();
@@ -343,9 +466,16 @@ int main(void) {
             }
         }
 
-        if (!mouseCaptured && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-            if (GetMousePosition().x >= 0 && GetMousePosition().x < GetScreenWidth() &&
-                GetMousePosition().y >= 0 && GetMousePosition().y < GetScreenHeight()) {
+        // Read by drawing and the HUD after skip_mouse_input, so set before
+        // any jump to it.
+        VoxelHit target = { 0 };
+        bool showGhostBlock = false;
+        bool hitBlock = false;
+        Vector3 ghostBlockPos = { 0 };
+        BlockRegion selection = { 0 };
+
+        if (!mouseCaptured && InputMousePressed(&input, MOUSE_BUTTON_LEFT)) {
+            if (input.mouseInWindow) {
                 mouseCaptured = true;
                 DisableCursor();
                 SetMousePosition(GetScreenWidth() / 2, GetScreenHeight() / 2);
@@ -356,14 +486,14 @@ int main(void) {
         }
 
         if (skipNextClick) {
-            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) || IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) {
+            if (InputMousePressed(&input, MOUSE_BUTTON_LEFT) || InputMousePressed(&input, MOUSE_BUTTON_RIGHT)) {
                 skipNextClick = false;
                 goto skip_mouse_input;
             }
         }
 
         if (mouseCaptured) {
-            Vector2 mouseDelta = GetMouseDelta();
+            Vector2 mouseDelta = input.mouseDelta;
             yaw += mouseDelta.x * MOUSE_SENSITIVITY;
             pitch -= mouseDelta.y * MOUSE_SENSITIVITY;
 
@@ -385,216 +515,340 @@ int main(void) {
         forwardDir = Vector3Normalize(forwardDir);
         Vector3 rightDir = Vector3Normalize(Vector3CrossProduct(forwardDir, camera.up));
 
-        if (IsKeyDown(KEY_W)) move = Vector3Add(move, forwardDir);
-        if (IsKeyDown(KEY_S)) move = Vector3Subtract(move, forwardDir);
-        if (IsKeyDown(KEY_D)) move = Vector3Add(move, rightDir);
-        if (IsKeyDown(KEY_A)) move = Vector3Subtract(move, rightDir);
+        if (InputDown(&input, KEY_W)) move = Vector3Add(move, forwardDir);
+        if (InputDown(&input, KEY_S)) move = Vector3Subtract(move, forwardDir);
+        if (InputDown(&input, KEY_D)) move = Vector3Add(move, rightDir);
+        if (InputDown(&input, KEY_A)) move = Vector3Subtract(move, rightDir);
 
         if (Vector3Length(move) > 0) {
             move = Vector3Normalize(move);
         }
 
-        Vector3 newPos = Vector3Add(camera.position, Vector3Scale(move, CAMERA_SPEED * deltaTime));
-        Vector3 collisionCorrection = CheckMoveCollision(newPos, blocks, blockCount);
-        if (collisionCorrection.x != 0 || collisionCorrection.z != 0) {
-            newPos = Vector3Add(newPos, (Vector3){collisionCorrection.x, 0.0f, collisionCorrection.z});
-        }
-        camera.position = newPos;
-
-        isGrounded = IsPlayerSupported(camera.position, blocks, blockCount);
-        if (isGrounded && IsKeyDown(KEY_SPACE)) {
-            velocityY = JUMP_FORCE;
-        } else if (!isGrounded) {
-            velocityY += GRAVITY * deltaTime;
+        // Physics runs in fixed steps regardless of frame rate; the camera is
+        // placed between the last two steps so motion stays smooth.
+        BeginProfileStage(&profiler, PROFILE_STREAM);
+        int spawnX = (int)roundf(player.spawnPosition.x);
+        int spawnZ = (int)roundf(player.spawnPosition.z);
+        bool spawnReady;
+        if (remote != NULL) {
+            SendNetPosition(remote, player.position);
+            UpdateNetClient(remote);
+            spawnReady = IsNetColumnReady(remote, spawnX, spawnZ);
         } else {
-            velocityY = 0.0f;
+            UpdateStreaming(&streamer, &world, &terrain, player.position, deltaTime);
+            if (fixedStep) FinishTerrainChunks(&streamer, &world, &terrain);
+            spawnReady = IsColumnStreamed(&streamer, spawnX, spawnZ);
+        }
+        if (!spawned && spawnReady) {
+            Vector3 spawn = SPAWN_POSITION;
+            spawn.y = FindGroundLevel(spawn, &world) + CAMERA_HEIGHT;
+            player.position = spawn;
+            player.previousPosition = spawn;
+            player.spawnPosition = spawn;
+            spawned = true;
         }
 
-        newPos = camera.position;
-        newPos.y += velocityY * deltaTime;
-        collisionCorrection = CheckMoveCollision(newPos, blocks, blockCount);
-        if (collisionCorrection.y != 0.0f) {
-            newPos.y += collisionCorrection.y;
-            velocityY = 0.0f;
+        BeginProfileStage(&profiler, PROFILE_PHYSICS);
+        if (spawned) physicsAccumulator += fminf(deltaTime, MAX_PHYSICS_STEPS * PHYSICS_TIMESTEP);
+        bool jump = InputDown(&input, KEY_SPACE);
+        while (physicsAccumulator >= PHYSICS_TIMESTEP) {
+            StepPlayer(&player, &world, move, jump, PHYSICS_TIMESTEP);
+            physicsAccumulator -= PHYSICS_TIMESTEP;
         }
-        camera.position = newPos;
 
-        if (camera.position.y < RESPAWN_Y_THRESHOLD) {
-            camera.position = SPAWN_POSITION;
-            velocityY = 0.0f;
+        BeginProfileStage(&profiler, PROFILE_ENTITY);
+        if (spawned) {
+            StepEntities(&entities, &world, fminf(deltaTime, MAX_PHYSICS_STEPS * PHYSICS_TIMESTEP), true);
+            itemsCollected += CollectItems(&entities, PlayerBox(player.position));
         }
 
+        BeginProfileStage(&profiler, PROFILE_TICK);
+        if (remote == NULL) RunBlockTicks(&ticker, &world, deltaTime);
+        camera.position = Vector3Lerp(player.previousPosition, player.position, physicsAccumulator / PHYSICS_TIMESTEP);
+
         camera.target = Vector3Add(camera.position, forward);
 
+        BeginProfileStage(&profiler, PROFILE_RAYCAST);
         Ray ray = GetMouseRay((Vector2){screenWidth / 2.0f, screenHeight / 2.0f}, camera);
 
-        Vector3 ghostBlockPos = {0};
-        bool showGhostBlock = false;
-        int hitBlockIndex = -1;
-        float shortestDistance = 10000.0f;
-
-        for (int i = 0; i < blockCount; i++) {
-            if (blocks[i].active) {
-                BoundingBox blockBox = {
-                    Vector3SubtractValue(blocks[i].position, 0.5f),
-                    Vector3AddValue(blocks[i].position, 0.5f)
-                };
-                RayCollision hitInfo = GetRayCollisionBox(ray, blockBox);
-                if (hitInfo.hit && hitInfo.distance < shortestDistance) {
-                    shortestDistance = hitInfo.distance;
-                    hitBlockIndex = i;
-                }
-            }
-        }
+        target = RaycastVoxels(&world, ray, BLOCK_REACH);
 
-        if (hitBlockIndex != -1) {
-            BoundingBox hitBlockBox = {
-                Vector3SubtractValue(blocks[hitBlockIndex].position, 0.5f),
-                Vector3AddValue(blocks[hitBlockIndex].position, 0.5f)
-            };
-            RayCollision hitInfo = GetRayCollisionBox(ray, hitBlockBox);
-            Vector3 roundedNormal = { roundf(hitInfo.normal.x), roundf(hitInfo.normal.y), roundf(hitInfo.normal.z) };
-            ghostBlockPos = Vector3Add(blocks[hitBlockIndex].position, roundedNormal);
-            showGhostBlock = true;
-        } else {
-            BoundingBox groundBox = { (Vector3){-0.5f, -0.5f, -0.5f}, (Vector3){BOARD_SIZE-0.5f, 0.5f, BOARD_SIZE-0.5f}};
-            RayCollision groundHit = GetRayCollisionBox(ray, groundBox);
-            if (groundHit.hit) {
-                ghostBlockPos = (Vector3){ roundf(groundHit.point.x), 0.5f, roundf(groundHit.point.z) };
-                showGhostBlock = true;
-            }
-        }
+        showGhostBlock = target.hit;
+        hitBlock = target.hit && !target.ground;
+        ghostBlockPos = CellCenter(target.adjacentX, target.adjacentY, target.adjacentZ);
 
-        if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && showGhostBlock && mouseCaptured) {
+        BeginProfileStage(&profiler, PROFILE_EDIT);
+        if (InputMousePressed(&input, MOUSE_BUTTON_LEFT) && showGhostBlock && mouseCaptured) {
             bool occupied = false;
             BoundingBox ghostBox = {
                 Vector3SubtractValue(ghostBlockPos, 0.5f),
                 Vector3AddValue(ghostBlockPos, 0.5f)
             };
-            BoundingBox playerBox = {
-                (Vector3){ camera.position.x - PLAYER_RADIUS, camera.position.y - PLAYER_HEIGHT / 2.0f, camera.position.z - PLAYER_RADIUS },
-                (Vector3){ camera.position.x + PLAYER_RADIUS, camera.position.y + PLAYER_HEIGHT / 2.0f, camera.position.z + PLAYER_RADIUS }
-            };
-
-            if (CheckAABBCollision(ghostBox, playerBox)) {
+            if (CheckAABBCollision(ghostBox, PlayerBox(player.position))) {
+                occupied = true;
+            } else if (GetBlock(&world, target.adjacentX, target.adjacentY, target.adjacentZ) != BLOCK_AIR) {
                 occupied = true;
-            } else {
-                for (int i = 0; i < blockCount; i++) {
-                    if (blocks[i].active &&
-                        fabs(blocks[i].position.x - ghostBlockPos.x) < 0.1f &&
-                        fabs(blocks[i].position.y - ghostBlockPos.y) < 0.1f &&
-                        fabs(blocks[i].position.z - ghostBlockPos.z) < 0.1f) {
-                        occupied = true;
-                        break;
-                    }
-                }
             }
 
             if (!occupied) {
-                if (blockCount >= blockCapacity) {
-                    blockCapacity *= 2;
-                    blocks = (Block*)realloc(blocks, blockCapacity * sizeof(Block));
-                }
-                blocks[blockCount].position = ghostBlockPos;
-                blocks[blockCount].active = true;
-                blocks[blockCount].type = selectedBlockType;
-                blockCount++;
+                RegionEdit place = { EDIT_FILL, { target.adjacentX, target.adjacentY, target.adjacentZ, target.adjacentX, target.adjacentY, target.adjacentZ }, selectedBlockType, BLOCK_AIR, NULL };
+                ApplySharedEdit(&world, &history, &place, remote);
             }
         }
 
-        if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT) && hitBlockIndex != -1 && mouseCaptured) {
-            if (fadingBlockCount < fadingBlockCapacity) {
-                fadingBlocks[fadingBlockCount].position = blocks[hitBlockIndex].position;
-                fadingBlocks[fadingBlockCount].type = blocks[hitBlockIndex].type;
-                fadingBlocks[fadingBlockCount].fadeTimer = FADE_TIME;
-                fadingBlocks[fadingBlockCount].active = true;
-                fadingBlockCount++;
-            }
-            blocks[hitBlockIndex].active = false;
-            _gc();
-            hitBlockIndex = -1;
+        if (InputMousePressed(&input, MOUSE_BUTTON_RIGHT) && hitBlock && mouseCaptured) {
+            BlockType dug = GetBlock(&world, target.x, target.y, target.z);
+            PushFadingBlock(CellCenter(target.x, target.y, target.z), dug);
+            if (remote == NULL) SpawnItem(&entities, dug, target.x, target.y, target.z);
+            RegionEdit dig = { EDIT_FILL, { target.x, target.y, target.z, target.x, target.y, target.z }, BLOCK_AIR, BLOCK_AIR, NULL };
+            ApplySharedEdit(&world, &history, &dig, remote);
+            hitBlock = false;
         }
 
-        skip_mouse_input:
+        // Corners snap to the targeted block, or the cell in front of the
+        // ground. Replace swaps the targeted block's type for the selected one.
+        int pickX = hitBlock ? target.x : target.adjacentX;
+        int pickY = hitBlock ? target.y : target.adjacentY;
+        int pickZ = hitBlock ? target.z : target.adjacentZ;
+        if (InputPressed(&input, KEY_Q) && target.hit) {
+            cornerA[0] = pickX; cornerA[1] = pickY; cornerA[2] = pickZ;
+            hasCornerA = true;
+        }
+        if (InputPressed(&input, KEY_E) && target.hit) {
+            cornerB[0] = pickX; cornerB[1] = pickY; cornerB[2] = pickZ;
+            hasCornerB = true;
+        }
+        if (InputPressed(&input, KEY_G)) hasCornerA = hasCornerB = false;
 
-        for (int i = 0; i < fadingBlockCount; i++) {
-            if (fadingBlocks[i].active) {
-                fadingBlocks[i].fadeTimer -= deltaTime;
-                if (fadingBlocks[i].fadeTimer <= 0) {
-                    fadingBlocks[i].active = false;
-                }
+        bool hasSelection = hasCornerA && hasCornerB;
+        selection = RegionFromCorners(cornerA[0], cornerA[1], cornerA[2], cornerB[0], cornerB[1], cornerB[2]);
+        bool control = InputDown(&input, KEY_LEFT_CONTROL) || InputDown(&input, KEY_RIGHT_CONTROL);
+        bool shift = InputDown(&input, KEY_LEFT_SHIFT) || InputDown(&input, KEY_RIGHT_SHIFT);
+
+        if (control && InputPressed(&input, KEY_Z)) {
+            if (shift) RedoSharedEdit(&world, &history, remote);
+            else UndoSharedEdit(&world, &history, remote);
+        }
+        if (control && InputPressed(&input, KEY_Y)) RedoSharedEdit(&world, &history, remote);
+
+        if (hasSelection && !control) {
+            RegionEdit region = { EDIT_FILL, selection, selectedBlockType, BLOCK_AIR, NULL };
+            if (InputPressed(&input, KEY_F)) ApplySharedEdit(&world, &history, &region, remote);
+            if (InputPressed(&input, KEY_H)) {
+                region.kind = EDIT_HOLLOW;
+                ApplySharedEdit(&world, &history, &region, remote);
+            }
+            if (InputPressed(&input, KEY_R) && target.hit) {
+                region.kind = EDIT_REPLACE;
+                region.match = hitBlock ? GetBlock(&world, target.x, target.y, target.z) : BLOCK_AIR;
+                ApplySharedEdit(&world, &history, &region, remote);
+            }
+            if (InputPressed(&input, KEY_X)) {
+                region.type = BLOCK_AIR;
+                ApplySharedEdit(&world, &history, &region, remote);
             }
+            if (InputPressed(&input, KEY_C)) CopyRegion(&world, selection, &clipboard);
         }
-        _gc();
+        if (InputPressed(&input, KEY_V) && !control && clipboard.voxels != NULL && target.hit) {
+            int x = target.adjacentX, y = target.adjacentY, z = target.adjacentZ;
+            RegionEdit paste = { EDIT_PASTE, { x, y, z, x + clipboard.sizeX - 1, y + clipboard.sizeY - 1, z + clipboard.sizeZ - 1 }, BLOCK_AIR, BLOCK_AIR, &clipboard };
+            ApplySharedEdit(&world, &history, &paste, remote);
+        }
+
+        skip_mouse_input:
 
+        UpdateFadingBlocks(deltaTime);
+
+        // Everything that changed this frame is relit at once, and the
+        // chunks it touched are meshed with the rest.
+        BeginProfileStage(&profiler, PROFILE_LIGHT);
+        UpdateWorldLight(&lightEngine, &world);
+
+        BeginProfileStage(&profiler, PROFILE_MESH);
+        if (drawRadius > viewRadius) UpdateChunkLods(&world, camera.position, viewRadius);
+        QueueDirtyChunkMeshes(&meshBuilder, &world);
+        UploadFinishedMeshes(&meshBuilder, &world);
+
+        BeginProfileStage(&profiler, PROFILE_DRAW);
         BeginDrawing();
+        if (targetFps > 0) BeginScaledScene(&resolution);
         ClearBackground(SKYBLUE);
 
         BeginMode3D(camera);
 
+        // The ground plane is endless; repeat one tile far enough around the
+        // camera to cover the draw radius. It is the one surface without
+        // outlines.
+        float outlineAlpha = 0.0f;
+        SetShaderValue(blockMaterial.shader, outlineLocation, &outlineAlpha, SHADER_UNIFORM_FLOAT);
+        int groundTiles = drawRadius * CHUNK_SIZE / GROUND_TILE_SIZE + 1;
+        int groundX = (int)floorf(camera.position.x / GROUND_TILE_SIZE);
+        int groundZ = (int)floorf(camera.position.z / GROUND_TILE_SIZE);
         rlDisableBackfaceCulling();
-        DrawModel(groundModel, (Vector3){(float)BOARD_SIZE/2.0f-0.5f, 0.0f, (float)BOARD_SIZE/2.0f-0.5f}, 1.0f, WHITE);
+        for (int tz = groundZ - groundTiles; tz <= groundZ + groundTiles; tz++) {
+            for (int tx = groundX - groundTiles; tx <= groundX + groundTiles; tx++) {
+                DrawMesh(groundMesh, blockMaterial, MatrixTranslate((float)(tx * GROUND_TILE_SIZE), 0.0f, (float)(tz * GROUND_TILE_SIZE)));
+            }
+        }
         rlEnableBackfaceCulling();
 
-        for (int i = 0; i < blockCount; i++) {
-            if (blocks[i].active) {
-                Vector3 pos = blocks[i].position;
-                blockModel.materials[0] = *blockMaterials[blocks[i].type];
-                DrawModel(blockModel, pos, 1.0f, WHITE);
-            }
+        BeginProfileStage(&profiler, PROFILE_CULL);
+        CollectVisibleChunks(&world, camera, (float)screenWidth / (float)screenHeight, drawRadius, &visibility);
+        BeginProfileStage(&profiler, PROFILE_DRAW);
+
+        outlineAlpha = showOutlines ? OUTLINE_ALPHA : 0.0f;
+        SetShaderValue(blockMaterial.shader, outlineLocation, &outlineAlpha, SHADER_UNIFORM_FLOAT);
+        for (int c = 0; c < visibility.count; c++) {
+            Chunk* chunk = visibility.chunks[c];
+            Matrix transform = MatrixTranslate((float)(chunk->cx * CHUNK_SIZE), (float)(chunk->cy * CHUNK_SIZE), (float)(chunk->cz * CHUNK_SIZE));
+            DrawMesh(chunk->mesh.mesh, blockMaterial, transform);
+        }
+
+        Frustum frustum = CameraFrustum(camera, (float)screenWidth / (float)screenHeight);
+        DrawEntities(&entityMesh, &entities, &frustum, blockMaterial);
+
+        if (hitBlock && mouseCaptured) {
+            DrawCubeWires(CellCenter(target.x, target.y, target.z), CUBE_WIRE_OFFSET, CUBE_WIRE_OFFSET, CUBE_WIRE_OFFSET, BLACK);
         }
 
         rlDisableBackfaceCulling();
         for (int i = 0; i < fadingBlockCount; i++) {
-            if (fadingBlocks[i].active) {
-                float alpha = fadingBlocks[i].fadeTimer / FADE_TIME;
-                Color fadeColor = (Color){255, 255, 255, (unsigned char)(alpha * 255)};
-                blockModel.materials[0] = *blockMaterials[fadingBlocks[i].type];
-                DrawModel(blockModel, fadingBlocks[i].position, 1.0f, fadeColor);
-            }
+            FadingBlock* fading = &fadingBlocks[(fadingBlockHead + i) % MAX_FADING_BLOCKS];
+            float alpha = fading->fadeTimer / FADE_TIME;
+            Vector3 pos = fading->position;
+            blockMaterial.maps[MATERIAL_MAP_DIFFUSE].color = (Color){255, 255, 255, (unsigned char)(alpha * 255)};
+            DrawMesh(blockMeshes[fading->type], blockMaterial, MatrixTranslate(pos.x, pos.y - 0.5f, pos.z));
         }
+        blockMaterial.maps[MATERIAL_MAP_DIFFUSE].color = WHITE;
         rlEnableBackfaceCulling();
 
+        if (hasCornerA || hasCornerB) {
+            int* a = hasCornerA ? cornerA : cornerB;
+            int* b = hasCornerB ? cornerB : cornerA;
+            DrawBoundingBox(RegionBox(RegionFromCorners(a[0], a[1], a[2], b[0], b[1], b[2])), SELECTION_COLOR);
+        }
+
         if (showGhostBlock && mouseCaptured) {
             float t = fmodf(GetTime() * GHOST_BLOCK_SPEED, 1.0f);
             float triangle = (t < 0.5f) ? (t * 2.0f) : (1.0f - (t - 0.5f) * 2.0f);
             float alpha = GHOST_BLOCK_MIN_ALPHA + (GHOST_BLOCK_MAX_ALPHA - GHOST_BLOCK_MIN_ALPHA) * triangle;
 
-            Color ghostColor = (Color){ 255, 255, 255, (unsigned char)(alpha * 255) };
-            ghostBlockModel.materials[0] = *blockMaterials[selectedBlockType];
-            DrawModel(ghostBlockModel, ghostBlockPos, 1.0f, ghostColor);
+            blockMaterial.maps[MATERIAL_MAP_DIFFUSE].color = (Color){ 255, 255, 255, (unsigned char)(alpha * 255) };
+            DrawMesh(blockMeshes[selectedBlockType], blockMaterial, MatrixTranslate(ghostBlockPos.x, ghostBlockPos.y - 0.5f, ghostBlockPos.z));
+            blockMaterial.maps[MATERIAL_MAP_DIFFUSE].color = WHITE;
         }
 
         EndMode3D();
+        if (targetFps > 0) DrawScaledScene(&resolution, screenWidth, screenHeight);
 
-        DrawBlockPreview(blockTextures[selectedBlockType]);
+        DrawBlockPreview(atlasTexture, blockTiles[selectedBlockType][FACE_TOP]);
 
-        DrawText(TextFormat("FPS: %i", displayedFPS), 10, 10, FPS_TEXT_SIZE, WHITE);
-        DrawText(TextFormat("Blocks: %i", blockCount), 10, 10 + FPS_TEXT_SIZE, FPS_TEXT_SIZE, WHITE);
+        if (targetFps > 0) {
+            DrawText(TextFormat("FPS: %i, 3D at %ix%i", displayedFPS, ScaledSceneWidth(&resolution), ScaledSceneHeight(&resolution)),
+                     10, 10, FPS_TEXT_SIZE, WHITE);
+        } else {
+            DrawText(TextFormat("FPS: %i", displayedFPS), 10, 10, FPS_TEXT_SIZE, WHITE);
+        }
+        DrawText(TextFormat("Blocks: %i", world.blockCount), 10, 10 + FPS_TEXT_SIZE, FPS_TEXT_SIZE, WHITE);
+        DrawText(TextFormat("Chunks: %i visible, %i culled, %i loaded, %i cached (%.1f MB)", visibility.count, visibility.culledCount,
+                            world.chunkCount, cache.count, cache.bytes / (1024.0f * 1024.0f)), 10, 10 + 2 * FPS_TEXT_SIZE, FPS_TEXT_SIZE, WHITE);
+        if (streamer.pending > 0) {
+            DrawText(TextFormat("Generating terrain: %i chunks left", streamer.pending), 10, 10 + 4 * FPS_TEXT_SIZE, FPS_TEXT_SIZE, WHITE);
+        }
+        if (hasCornerA && hasCornerB) {
+            DrawText(TextFormat("Selection: %ix%ix%i, history %i/%i (%.1f KB)", selection.x1 - selection.x0 + 1, selection.y1 - selection.y0 + 1,
+                                selection.z1 - selection.z0 + 1, history.position, history.count, history.bytes / 1024.0f),
+                     10, 10 + 5 * FPS_TEXT_SIZE, FPS_TEXT_SIZE, WHITE);
+        }
+        if (remote != NULL) {
+            DrawText(TextFormat("Server: %s, %.1f KB down, %.1f KB up, %llu changes", remote->connection.closed ? "disconnected" : "connected",
+                                remote->connection.bytesReceived / 1024.0f, remote->connection.bytesSent / 1024.0f,
+                                (unsigned long long)remote->changesReceived), 10, 10 + 3 * FPS_TEXT_SIZE, FPS_TEXT_SIZE, WHITE);
+        }
+        if (meshBuilder.inFlight + meshBuilder.waitingCount > 0) {
+            DrawText(TextFormat("Meshing: %i building, %i waiting, %i uploaded", meshBuilder.inFlight, meshBuilder.waitingCount,
+                                meshBuilder.uploadsLastFrame), 10, 10 + 6 * FPS_TEXT_SIZE, FPS_TEXT_SIZE, WHITE);
+        }
+        if (entities.count > 0 || itemsCollected > 0) {
+            DrawText(TextFormat("Entities: %i, %i drawn in %i calls, %i items picked up", entities.count, entityMesh.drawnLastFrame,
+                                entityMesh.callsLastFrame, itemsCollected), 10, 10 + 7 * FPS_TEXT_SIZE, FPS_TEXT_SIZE, WHITE);
+        }
+        if (ticker.count > 0) {
+            DrawText(TextFormat("Block ticks: %i scheduled, %i run last frame", ticker.count, ticker.ranLastFrame), 10, 10 + 8 * FPS_TEXT_SIZE,
+                     FPS_TEXT_SIZE, WHITE);
+        }
+        if (hasSaveTimes) {
+            DrawText(TextFormat("Save: %.3f ms snapshot, %.1f ms total%s", saveSnapshotMs, saveTotalMs, autosave.succeeded ? "" : " (failed)"),
+                     10, 10 + 3 * FPS_TEXT_SIZE, FPS_TEXT_SIZE, WHITE);
+        }
 
         if (mouseCaptured) {
             DrawLine(screenWidth / 2 - CROSSHAIR_SIZE, screenHeight / 2, screenWidth / 2 + CROSSHAIR_SIZE, screenHeight / 2, WHITE);
             DrawLine(screenWidth / 2, screenHeight / 2 - CROSSHAIR_SIZE, screenWidth / 2, screenHeight / 2 + CROSSHAIR_SIZE, WHITE);
         }
 
+        if (profiler.visible) DrawProfilerOverlay(&profiler, 10, screenHeight - PROFILE_OVERLAY_HEIGHT - 10);
+
+        BeginProfileStage(&profiler, PROFILE_PRESENT);
         EndDrawing();
+        EndProfileFrame(&profiler);
+        const ProfileFrame* lastFrame = &profiler.frames[(profiler.head + PROFILE_HISTORY - 1) % PROFILE_HISTORY];
+        if (replaying) AddReplayFrame(&replayStats, lastFrame);
+        // Drawing and presenting are the parts of the frame that wait on the GPU.
+        if (targetFps > 0 && !fixedStep) {
+            UpdateDynamicResolution(&resolution, lastFrame->frameMs, lastFrame->stageMs[PROFILE_DRAW] + lastFrame->stageMs[PROFILE_PRESENT]);
+        }
+
+        // GetTime() counts from InitWindow, which is where startup begins.
+        if (!startupReported) {
+            printf("startup: %.1f ms to first frame (atlas and shader %.2f ms)\n", GetTime() * 1000.0, atlasMs);
+            startupReported = true;
+        }
     }
 
-    UnloadModel(blockModel);
-    UnloadModel(ghostBlockModel);
-    UnloadModel(groundModel);
-    UnloadTexture(grassTexture);
-    UnloadTexture(stoneTexture);
-    UnloadTexture(dirtTexture);
-    UnloadTexture(woodTexture);
-    UnloadMaterial(stoneMaterial);
-    UnloadMaterial(grassMaterial);
-    UnloadMaterial(dirtMaterial);
-    UnloadMaterial(woodMaterial);
-    UnloadMaterial(groundMaterial);
-
-    free(blocks);
-    free(fadingBlocks);
+    // The final position and block count show whether two builds replayed
+    // the session the same way.
+    if (replaying) {
+        PrintReplayStats(&replayStats);
+        printf("final: %i blocks, player at (%.3f, %.3f, %.3f)\n", world.blockCount, player.position.x, player.position.y, player.position.z);
+    } else if (recordPath != NULL) {
+        if (WriteInputRecording(&recording, recordPath)) printf("recorded %i frames, %zu bytes\n", recording.frameCount, recording.size);
+        else fprintf(stderr, "could not write %s\n", recordPath);
+    }
+    FreeInputRecording(&recording);
+    FreeReplayStats(&replayStats);
+
+    // The trace format follows the file extension.
+    if (tracePath != NULL) {
+        size_t length = strlen(tracePath);
+        if (length >= 5 && strcmp(tracePath + length - 5, ".json") == 0) WriteProfileTrace(&profiler, tracePath);
+        else WriteProfileCsv(&profiler, tracePath);
+    }
+
+    for (int t = 1; t < BLOCK_TYPE_COUNT; t++) {
+        UnloadMesh(blockMeshes[t]);
+    }
+    UnloadMesh(groundMesh);
+    UnloadEntityMesh(&entityMesh);
+    UnloadMaterial(blockMaterial);
+    UnloadDynamicResolution(&resolution);
+
+    StopTerrainGenerator(&terrain);
+    StopMeshBuilder(&meshBuilder);
+    if (remote != NULL) CloseNetClient(remote);
+    if (useSave) {
+        FinishAutosave(&autosave, &world);
+        SaveWorld(&world, SAVE_PATH);
+    }
+    FreeEditHistory(&history);
+    FreeEntitySet(&entities);
+    FreeBlockTicker(&ticker);
+    FreeClipboard(&clipboard);
+    FreeChunkStreamer(&streamer);
+    FreeWorld(&world);
+    FreeLightEngine(&lightEngine);
+    FreeChunkCache(&cache);
+    FreeChunkVisibility(&visibility);
 
     EnableCursor();
     CloseWindow();
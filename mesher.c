@@ -0,0 +1,493 @@
+#include "mesher.h"
+#include "light.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+const unsigned char blockTiles[BLOCK_TYPE_COUNT][3] = {
+    [BLOCK_STONE] = { TILE_STONE, TILE_STONE, TILE_STONE },
+    [BLOCK_GRASS] = { TILE_GRASS_TOP, TILE_GRASS_SIDE, TILE_DIRT },
+    [BLOCK_DIRT] = { TILE_DIRT, TILE_DIRT, TILE_DIRT },
+    [BLOCK_WOOD] = { TILE_WOOD, TILE_WOOD, TILE_WOOD },
+    [BLOCK_LEAVES] = { TILE_LEAVES, TILE_LEAVES, TILE_LEAVES },
+    [BLOCK_SAND] = { TILE_SAND, TILE_SAND, TILE_SAND },
+    [BLOCK_GRAVEL] = { TILE_GRAVEL, TILE_GRAVEL, TILE_GRAVEL },
+    [BLOCK_LAMP] = { TILE_LAMP, TILE_LAMP, TILE_LAMP }
+};
+
+const float occlusionShade[4] = { 1.0f, 0.8f, 0.65f, 0.5f };
+
+int PaddedVoxelIndex(int px, int py, int pz) {
+    return (py * PADDED_CHUNK_SIZE + pz) * PADDED_CHUNK_SIZE + px;
+}
+
+// The chunk and its 26 neighbors, indexed by NeighborIndex; missing chunks
+// are NULL and read as air.
+int NeighborIndex(int dx, int dy, int dz) {
+    return ((dy + 1) * 3 + (dz + 1)) * 3 + (dx + 1);
+}
+
+void CollectNeighborVoxels(World* world, int cx, int cy, int cz, VoxelBuffer** neighbors) {
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                Chunk* chunk = FindChunk(world, cx + dx, cy + dy, cz + dz);
+                neighbors[NeighborIndex(dx, dy, dz)] = (chunk != NULL) ? chunk->voxels : NULL;
+            }
+        }
+    }
+}
+
+// Copies the chunk plus a one voxel border from its neighbors so the mesher
+// never needs a hash lookup in its inner loop. Ground cells are marked as
+// occluders so faces resting on the ground plane are dropped. Only the
+// buffers are read, so this runs on worker threads against retained
+// snapshots.
+void GatherSnapshotVoxels(VoxelBuffer* const* neighbors, int cy, unsigned char* padded) {
+    int baseY = cy * CHUNK_SIZE - 1;
+
+    for (int py = 0; py < PADDED_CHUNK_SIZE; py++) {
+        int dy = (py == 0) ? -1 : (py > CHUNK_SIZE) ? 1 : 0;
+        for (int pz = 0; pz < PADDED_CHUNK_SIZE; pz++) {
+            int dz = (pz == 0) ? -1 : (pz > CHUNK_SIZE) ? 1 : 0;
+            for (int px = 0; px < PADDED_CHUNK_SIZE; px++) {
+                int dx = (px == 0) ? -1 : (px > CHUNK_SIZE) ? 1 : 0;
+                const VoxelBuffer* buffer = neighbors[NeighborIndex(dx, dy, dz)];
+                unsigned char type = (buffer != NULL)
+                    ? buffer->data[ChunkVoxelIndex((px - 1) & CHUNK_MASK, (py - 1) & CHUNK_MASK, (pz - 1) & CHUNK_MASK)]
+                    : BLOCK_AIR;
+                if (type == BLOCK_AIR && IsGroundCell(baseY + py)) {
+                    type = PADDED_GROUND;
+                }
+                padded[PaddedVoxelIndex(px, py, pz)] = type;
+            }
+        }
+    }
+}
+
+void GatherPaddedVoxels(World* world, Chunk* chunk, unsigned char* padded) {
+    VoxelBuffer* neighbors[CHUNK_NEIGHBORHOOD];
+    CollectNeighborVoxels(world, chunk->cx, chunk->cy, chunk->cz, neighbors);
+    GatherSnapshotVoxels(neighbors, chunk->cy, padded);
+}
+
+// Light buffers of the chunk and its neighbors, laid out like the voxels;
+// empty chunks the light engine holds give theirs, unlit and missing ones
+// are NULL.
+void CollectNeighborLight(World* world, int cx, int cy, int cz, LightBuffer** lights) {
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                Chunk* chunk = FindChunk(world, cx + dx, cy + dy, cz + dz);
+                if (chunk == NULL && world->light != NULL) chunk = FindAirChunk(world->light, cx + dx, cy + dy, cz + dz);
+                lights[NeighborIndex(dx, dy, dz)] = (chunk != NULL) ? chunk->light : NULL;
+            }
+        }
+    }
+}
+
+// Cells without light, as in a world with no light engine, read as open sky.
+void GatherSnapshotLight(LightBuffer* const* lights, unsigned char* paddedLight) {
+    for (int py = 0; py < PADDED_CHUNK_SIZE; py++) {
+        int dy = (py == 0) ? -1 : (py > CHUNK_SIZE) ? 1 : 0;
+        for (int pz = 0; pz < PADDED_CHUNK_SIZE; pz++) {
+            int dz = (pz == 0) ? -1 : (pz > CHUNK_SIZE) ? 1 : 0;
+            for (int px = 0; px < PADDED_CHUNK_SIZE; px++) {
+                int dx = (px == 0) ? -1 : (px > CHUNK_SIZE) ? 1 : 0;
+                const LightBuffer* buffer = lights[NeighborIndex(dx, dy, dz)];
+                paddedLight[PaddedVoxelIndex(px, py, pz)] = (buffer != NULL)
+                    ? buffer->data[ChunkVoxelIndex((px - 1) & CHUNK_MASK, (py - 1) & CHUNK_MASK, (pz - 1) & CHUNK_MASK)]
+                    : LIGHT_OPEN_SKY;
+            }
+        }
+    }
+}
+
+// Solid cells around one corner of the face looking into the padded cell,
+// on the cell's side of the face. Two solid sides hide the corner whatever
+// is diagonal to it.
+int CornerOcclusion(const unsigned char* padded, const int* cell, int u, int v, int cornerU, int cornerV) {
+    int side1[3] = { cell[0], cell[1], cell[2] };
+    int side2[3] = { cell[0], cell[1], cell[2] };
+    side1[u] += cornerU ? 1 : -1;
+    side2[v] += cornerV ? 1 : -1;
+    int corner[3] = { side1[0], side1[1], side1[2] };
+    corner[v] = side2[v];
+
+    int a = padded[PaddedVoxelIndex(side1[0], side1[1], side1[2])] != BLOCK_AIR;
+    int b = padded[PaddedVoxelIndex(side2[0], side2[1], side2[2])] != BLOCK_AIR;
+    int c = padded[PaddedVoxelIndex(corner[0], corner[1], corner[2])] != BLOCK_AIR;
+    return (a && b) ? 3 : a + b + c;
+}
+
+// Mask entry for a face of the given type looking into the padded cell.
+// Faces only merge when type, light and the occlusion of every corner
+// match; a merged quad stretches one face's corner shading over its size.
+int FaceMaskValue(const unsigned char* padded, const unsigned char* paddedLight, const int* cell, int d, int type) {
+    int u = (d + 1) % 3;
+    int v = (d + 2) % 3;
+    int light = (paddedLight != NULL) ? LightLevel(paddedLight[PaddedVoxelIndex(cell[0], cell[1], cell[2])]) : LIGHT_MAX;
+    int occlusion = 0;
+    for (int corner = 0; corner < 4; corner++) {
+        occlusion |= CornerOcclusion(padded, cell, u, v, corner & 1, corner >> 1) << (2 * corner);
+    }
+    return type | light << 8 | occlusion << 12;
+}
+
+// Hidden-face culling plus greedy merging: for every slice along each axis a
+// 2D mask of exposed faces is built, then grown into maximal rectangles of
+// the same block type, facing and shading. paddedLight may be NULL, which
+// lights every face fully.
+int BuildChunkQuads(const unsigned char* padded, const unsigned char* paddedLight, ChunkQuad* quads) {
+    int quadCount = 0;
+    int mask[CHUNK_SIZE * CHUNK_SIZE];
+
+    for (int d = 0; d < 3; d++) {
+        int u = (d + 1) % 3;
+        int v = (d + 2) % 3;
+
+        for (int s = 0; s <= CHUNK_SIZE; s++) {
+            for (int j = 0; j < CHUNK_SIZE; j++) {
+                for (int i = 0; i < CHUNK_SIZE; i++) {
+                    int p[3];
+                    p[d] = s;
+                    p[u] = i + 1;
+                    p[v] = j + 1;
+                    unsigned char a = padded[PaddedVoxelIndex(p[0], p[1], p[2])];
+                    p[d] = s + 1;
+                    unsigned char b = padded[PaddedVoxelIndex(p[0], p[1], p[2])];
+
+                    int m = 0;
+                    if (s > 0 && a != BLOCK_AIR && a != PADDED_GROUND && b == BLOCK_AIR) {
+                        m = FaceMaskValue(padded, paddedLight, p, d, a);
+                    } else if (s < CHUNK_SIZE && b != BLOCK_AIR && b != PADDED_GROUND && a == BLOCK_AIR) {
+                        p[d] = s;
+                        m = -FaceMaskValue(padded, paddedLight, p, d, b);
+                    }
+                    mask[j * CHUNK_SIZE + i] = m;
+                }
+            }
+
+            for (int j = 0; j < CHUNK_SIZE; j++) {
+                for (int i = 0; i < CHUNK_SIZE; ) {
+                    int m = mask[j * CHUNK_SIZE + i];
+                    if (m == 0) {
+                        i++;
+                        continue;
+                    }
+
+                    int width = 1;
+                    while (i + width < CHUNK_SIZE && mask[j * CHUNK_SIZE + i + width] == m) width++;
+
+                    int height = 1;
+                    while (j + height < CHUNK_SIZE) {
+                        bool rowMatches = true;
+                        for (int k = 0; k < width; k++) {
+                            if (mask[(j + height) * CHUNK_SIZE + i + k] != m) {
+                                rowMatches = false;
+                                break;
+                            }
+                        }
+                        if (!rowMatches) break;
+                        height++;
+                    }
+
+                    int face = (m > 0) ? m : -m;
+                    quads[quadCount++] = (ChunkQuad){
+                        (unsigned char)d, m > 0, (unsigned char)(face & 0xFF), (unsigned char)s,
+                        (unsigned char)i, (unsigned char)j, (unsigned char)width, (unsigned char)height,
+                        (unsigned char)((face >> 8) & LIGHT_MAX), (unsigned char)(face >> 12)
+                    };
+
+                    for (int h = 0; h < height; h++) {
+                        for (int k = 0; k < width; k++) {
+                            mask[(j + h) * CHUNK_SIZE + i + k] = 0;
+                        }
+                    }
+                    i += width;
+                }
+            }
+        }
+    }
+
+    return quadCount;
+}
+
+// Occlusion of the quad's corner in EmitQuadVertices order, which walks u
+// first on positive faces and v first on negative ones.
+int QuadCornerOcclusion(const ChunkQuad* quad, int corner) {
+    int cornerU = (corner == 1) ? quad->positive : (corner == 2) ? 1 : (corner == 3) ? !quad->positive : 0;
+    int cornerV = (corner == 1) ? !quad->positive : (corner == 2) ? 1 : (corner == 3) ? quad->positive : 0;
+    return (quad->occlusion >> (2 * (cornerV * 2 + cornerU))) & 3;
+}
+
+// Grid corner (gx, gy, gz) in chunk space maps to the block layout used by
+// CellBox, where cells are centered on integer x/z and start at integer y.
+// Each light level below the maximum darkens by a fifth.
+void EmitQuadVertices(const ChunkQuad* quad, float* vertices, float* texcoords, float* texcoords2, float* normals, unsigned char* colors) {
+    int d = quad->axis;
+    int u = (d + 1) % 3;
+    int v = (d + 2) % 3;
+
+    int corner[4][3];
+    int du[3] = { 0 }, dv[3] = { 0 };
+    du[u] = quad->width;
+    dv[v] = quad->height;
+
+    int base[3];
+    base[d] = quad->slice;
+    base[u] = quad->u;
+    base[v] = quad->v;
+
+    for (int k = 0; k < 3; k++) {
+        corner[0][k] = base[k];
+        corner[1][k] = base[k] + (quad->positive ? du[k] : dv[k]);
+        corner[2][k] = base[k] + du[k] + dv[k];
+        corner[3][k] = base[k] + (quad->positive ? dv[k] : du[k]);
+    }
+
+    float normal[3] = { 0.0f, 0.0f, 0.0f };
+    normal[d] = quad->positive ? 1.0f : -1.0f;
+
+    BlockFace face = (d != 1) ? FACE_SIDE : (quad->positive ? FACE_TOP : FACE_BOTTOM);
+    int tile = blockTiles[quad->type][face];
+    float light = powf(0.8f, (float)(LIGHT_MAX - quad->light));
+
+    for (int c = 0; c < 4; c++) {
+        int gx = corner[c][0], gy = corner[c][1], gz = corner[c][2];
+        vertices[c * 3 + 0] = gx - 0.5f;
+        vertices[c * 3 + 1] = (float)gy;
+        vertices[c * 3 + 2] = gz - 0.5f;
+
+        if (d == 1) {
+            texcoords[c * 2 + 0] = (float)gx;
+            texcoords[c * 2 + 1] = (float)gz;
+        } else {
+            texcoords[c * 2 + 0] = (float)((d == 0) ? gz : gx);
+            texcoords[c * 2 + 1] = (float)-gy;
+        }
+
+        texcoords2[c * 2 + 0] = (float)(tile % ATLAS_COLUMNS);
+        texcoords2[c * 2 + 1] = (float)(tile / ATLAS_COLUMNS);
+
+        normals[c * 3 + 0] = normal[0];
+        normals[c * 3 + 1] = normal[1];
+        normals[c * 3 + 2] = normal[2];
+
+        unsigned char shade = (unsigned char)(255.0f * light * occlusionShade[QuadCornerOcclusion(quad, c)] + 0.5f);
+        colors[c * 4 + 0] = shade;
+        colors[c * 4 + 1] = shade;
+        colors[c * 4 + 2] = shade;
+        colors[c * 4 + 3] = 255;
+    }
+}
+
+// Flood fills every air region of the chunk and records which chunk faces
+// each region touches; the visibility search uses this to skip chunks that
+// can't be seen through (Checchi's cave culling).
+void ComputeChunkFaceLinks(const unsigned char* padded, unsigned char* faceLinks) {
+    static _Thread_local bool visited[CHUNK_VOLUME];
+    static _Thread_local short stack[CHUNK_VOLUME];
+
+    memset(visited, 0, sizeof(visited));
+    memset(faceLinks, 0, CHUNK_FACE_COUNT);
+
+    for (int start = 0; start < CHUNK_VOLUME; start++) {
+        int sx = start & CHUNK_MASK;
+        int sz = (start >> CHUNK_SHIFT) & CHUNK_MASK;
+        int sy = start >> (2 * CHUNK_SHIFT);
+        if (visited[start] || padded[PaddedVoxelIndex(sx + 1, sy + 1, sz + 1)] != BLOCK_AIR) continue;
+
+        unsigned char touched = 0;
+        int top = 0;
+        stack[top++] = (short)start;
+        visited[start] = true;
+
+        while (top > 0) {
+            int index = stack[--top];
+            int x = index & CHUNK_MASK;
+            int z = (index >> CHUNK_SHIFT) & CHUNK_MASK;
+            int y = index >> (2 * CHUNK_SHIFT);
+
+            if (x == 0) touched |= 1 << 0;
+            if (x == CHUNK_MASK) touched |= 1 << 1;
+            if (y == 0) touched |= 1 << 2;
+            if (y == CHUNK_MASK) touched |= 1 << 3;
+            if (z == 0) touched |= 1 << 4;
+            if (z == CHUNK_MASK) touched |= 1 << 5;
+
+            const int offsets[6][3] = { {-1,0,0}, {1,0,0}, {0,-1,0}, {0,1,0}, {0,0,-1}, {0,0,1} };
+            for (int f = 0; f < CHUNK_FACE_COUNT; f++) {
+                int nx = x + offsets[f][0];
+                int ny = y + offsets[f][1];
+                int nz = z + offsets[f][2];
+                if (nx < 0 || nx >= CHUNK_SIZE || ny < 0 || ny >= CHUNK_SIZE || nz < 0 || nz >= CHUNK_SIZE) continue;
+
+                int next = ChunkVoxelIndex(nx, ny, nz);
+                if (visited[next] || padded[PaddedVoxelIndex(nx + 1, ny + 1, nz + 1)] != BLOCK_AIR) continue;
+
+                visited[next] = true;
+                stack[top++] = (short)next;
+            }
+        }
+
+        for (int f = 0; f < CHUNK_FACE_COUNT; f++) {
+            if (touched & (1 << f)) faceLinks[f] |= touched;
+        }
+    }
+}
+
+// A block of size^3 voxels is drawn at a lower level of detail as the type
+// of its highest solid voxel, so grass stays on top, when at least half of it
+// is solid, and as air otherwise.
+unsigned char CoarseVoxelType(const VoxelBuffer* buffer, int x0, int y0, int z0, int size) {
+    if (buffer == NULL) return BLOCK_AIR;
+    unsigned char top = BLOCK_AIR;
+    int solid = 0;
+    for (int y = y0 + size - 1; y >= y0; y--) {
+        for (int z = z0; z < z0 + size; z++) {
+            for (int x = x0; x < x0 + size; x++) {
+                unsigned char type = buffer->data[ChunkVoxelIndex(x, y, z)];
+                if (type == BLOCK_AIR) continue;
+                if (top == BLOCK_AIR) top = type;
+                solid++;
+            }
+        }
+    }
+    return (solid * 2 >= size * size * size) ? top : BLOCK_AIR;
+}
+
+// Fills the padded grid with the chunk at 1/2^lod resolution, every coarse
+// block repeated over its voxels so BuildChunkQuads merges it into few
+// quads. Chunks above and below are sampled the same way, as a whole column
+// always shares one level. The sides are left as air: the faces kept on them
+// are the skirts that close any gap to a neighbor drawn at another level.
+void DownsampleSnapshotVoxels(VoxelBuffer* const* neighbors, int cy, int lod, unsigned char* padded) {
+    int size = 1 << lod;
+    memset(padded, BLOCK_AIR, PADDED_CHUNK_VOLUME);
+
+    for (int by = -size; by < CHUNK_SIZE + size; by += size) {
+        int dy = (by < 0) ? -1 : (by >= CHUNK_SIZE) ? 1 : 0;
+        const VoxelBuffer* buffer = neighbors[NeighborIndex(0, dy, 0)];
+        int y0 = (by < -1) ? -1 : by;
+        int y1 = (by + size > CHUNK_SIZE + 1) ? CHUNK_SIZE + 1 : by + size;
+        for (int bz = 0; bz < CHUNK_SIZE; bz += size) {
+            for (int bx = 0; bx < CHUNK_SIZE; bx += size) {
+                unsigned char type = CoarseVoxelType(buffer, bx, by & CHUNK_MASK, bz, size);
+                if (type == BLOCK_AIR) continue;
+                for (int y = y0; y < y1; y++) {
+                    for (int z = bz; z < bz + size; z++) {
+                        for (int x = bx; x < bx + size; x++) {
+                            padded[PaddedVoxelIndex(x + 1, y + 1, z + 1)] = type;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    int baseY = cy * CHUNK_SIZE - 1;
+    for (int py = 0; py < PADDED_CHUNK_SIZE; py++) {
+        for (int pz = 0; pz < PADDED_CHUNK_SIZE; pz++) {
+            for (int px = 0; px < PADDED_CHUNK_SIZE; px++) {
+                int index = PaddedVoxelIndex(px, py, pz);
+                if (padded[index] == BLOCK_AIR && IsGroundCell(baseY + py)) padded[index] = PADDED_GROUND;
+            }
+        }
+    }
+}
+
+Mesh GenQuadGeometry(const ChunkQuad* quads, int quadCount) {
+    Mesh mesh = { 0 };
+    mesh.vertexCount = quadCount * 4;
+    mesh.triangleCount = quadCount * 2;
+    mesh.vertices = (float*)RL_MALLOC(mesh.vertexCount * 3 * sizeof(float));
+    mesh.texcoords = (float*)RL_MALLOC(mesh.vertexCount * 2 * sizeof(float));
+    mesh.texcoords2 = (float*)RL_MALLOC(mesh.vertexCount * 2 * sizeof(float));
+    mesh.normals = (float*)RL_MALLOC(mesh.vertexCount * 3 * sizeof(float));
+    mesh.colors = (unsigned char*)RL_MALLOC(mesh.vertexCount * 4 * sizeof(unsigned char));
+    mesh.indices = (unsigned short*)RL_MALLOC(mesh.triangleCount * 3 * sizeof(unsigned short));
+
+    // Quads are split along the diagonal with less occluded corners, so a
+    // dark corner shades its own triangle rather than a stripe across.
+    for (int q = 0; q < quadCount; q++) {
+        const ChunkQuad* quad = &quads[q];
+        EmitQuadVertices(quad, &mesh.vertices[q * 12], &mesh.texcoords[q * 8], &mesh.texcoords2[q * 8], &mesh.normals[q * 12], &mesh.colors[q * 16]);
+
+        unsigned short first = (unsigned short)(q * 4);
+        unsigned short* indices = &mesh.indices[q * 6];
+        bool flip = QuadCornerOcclusion(quad, 0) + QuadCornerOcclusion(quad, 2) > QuadCornerOcclusion(quad, 1) + QuadCornerOcclusion(quad, 3);
+        if (flip) {
+            indices[0] = first;
+            indices[1] = first + 1;
+            indices[2] = first + 3;
+            indices[3] = first + 1;
+            indices[4] = first + 2;
+            indices[5] = first + 3;
+        } else {
+            indices[0] = first;
+            indices[1] = first + 1;
+            indices[2] = first + 2;
+            indices[3] = first;
+            indices[4] = first + 2;
+            indices[5] = first + 3;
+        }
+    }
+
+    return mesh;
+}
+
+// A single cell's six faces, used for the ghost and fading blocks.
+Mesh GenBlockGeometry(BlockType type) {
+    ChunkQuad quads[6];
+    for (int d = 0; d < 3; d++) {
+        quads[d * 2 + 0] = (ChunkQuad){ (unsigned char)d, true, (unsigned char)type, 1, 0, 0, 1, 1, LIGHT_MAX, 0 };
+        quads[d * 2 + 1] = (ChunkQuad){ (unsigned char)d, false, (unsigned char)type, 0, 0, 0, 1, 1, LIGHT_MAX, 0 };
+    }
+    return GenQuadGeometry(quads, 6);
+}
+
+// One GROUND_TILE_SIZE square of the ground plane; the renderer repeats it
+// around the player.
+Mesh GenGroundGeometry(void) {
+    ChunkQuad quad = { 1, true, BLOCK_GRASS, 0, 0, 0, GROUND_TILE_SIZE, GROUND_TILE_SIZE, LIGHT_MAX, 0 };
+    return GenQuadGeometry(&quad, 1);
+}
+
+bool BuildChunkGeometry(World* world, Chunk* chunk, Mesh* mesh) {
+    static _Thread_local unsigned char padded[PADDED_CHUNK_VOLUME];
+    static _Thread_local unsigned char paddedLight[PADDED_CHUNK_VOLUME];
+    static _Thread_local ChunkQuad quads[MAX_CHUNK_QUADS];
+
+    chunk->dirty = false;
+    if (chunk->blockCount == 0) {
+        memset(chunk->faceLinks, ALL_CHUNK_FACES, sizeof(chunk->faceLinks));
+        return false;
+    }
+
+    LightBuffer* lights[CHUNK_NEIGHBORHOOD];
+    GatherPaddedVoxels(world, chunk, padded);
+    CollectNeighborLight(world, chunk->cx, chunk->cy, chunk->cz, lights);
+    GatherSnapshotLight(lights, paddedLight);
+    ComputeChunkFaceLinks(padded, chunk->faceLinks);
+    int quadCount = BuildChunkQuads(padded, paddedLight, quads);
+    if (quadCount == 0) return false;
+
+    *mesh = GenQuadGeometry(quads, quadCount);
+    return true;
+}
+
+void FreeMeshGeometry(Mesh* mesh) {
+    RL_FREE(mesh->vertices);
+    RL_FREE(mesh->texcoords);
+    RL_FREE(mesh->texcoords2);
+    RL_FREE(mesh->normals);
+    RL_FREE(mesh->colors);
+    RL_FREE(mesh->indices);
+    mesh->vertices = NULL;
+    mesh->texcoords = NULL;
+    mesh->texcoords2 = NULL;
+    mesh->normals = NULL;
+    mesh->colors = NULL;
+    mesh->indices = NULL;
+}
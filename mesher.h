@@ -0,0 +1,75 @@
+#ifndef MESHER_H
+#define MESHER_H
+
+#include "world.h"
+
+typedef enum {
+    FACE_TOP = 0,
+    FACE_SIDE = 1,
+    FACE_BOTTOM = 2
+} BlockFace;
+
+typedef enum {
+    TILE_STONE = 0,
+    TILE_GRASS_TOP,
+    TILE_GRASS_SIDE,
+    TILE_DIRT,
+    TILE_WOOD,
+    TILE_LEAVES,
+    TILE_SAND,
+    TILE_GRAVEL,
+    TILE_LAMP,
+    TILE_COUNT
+} AtlasTile;
+
+#define ATLAS_COLUMNS 4
+#define TILE_PIXELS 64
+#define ATLAS_PIXELS (TILE_PIXELS * ATLAS_COLUMNS)
+
+#define PADDED_CHUNK_SIZE (CHUNK_SIZE + 2)
+#define PADDED_CHUNK_VOLUME (PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE * PADDED_CHUNK_SIZE)
+#define PADDED_GROUND 0xFF
+#define CHUNK_NEIGHBORHOOD 27
+#define MAX_CHUNK_LOD 3
+#define MAX_CHUNK_QUADS (CHUNK_VOLUME * 3)
+#define GROUND_TILE_SIZE 128
+
+// light is the level of the cell the face looks into; occlusion holds two
+// bits per corner, the number of solid cells around it, for the corners at
+// (u, v), (u + width, v), (u, v + height) and (u + width, v + height).
+typedef struct {
+    unsigned char axis;
+    bool positive;
+    unsigned char type;
+    unsigned char slice;
+    unsigned char u, v, width, height;
+    unsigned char light;
+    unsigned char occlusion;
+} ChunkQuad;
+
+extern const unsigned char blockTiles[BLOCK_TYPE_COUNT][3];
+
+int PaddedVoxelIndex(int px, int py, int pz);
+int NeighborIndex(int dx, int dy, int dz);
+void CollectNeighborVoxels(World* world, int cx, int cy, int cz, VoxelBuffer** neighbors);
+void GatherSnapshotVoxels(VoxelBuffer* const* neighbors, int cy, unsigned char* padded);
+void GatherPaddedVoxels(World* world, Chunk* chunk, unsigned char* padded);
+void CollectNeighborLight(World* world, int cx, int cy, int cz, LightBuffer** lights);
+void GatherSnapshotLight(LightBuffer* const* lights, unsigned char* paddedLight);
+int CornerOcclusion(const unsigned char* padded, const int* cell, int u, int v, int cornerU, int cornerV);
+int BuildChunkQuads(const unsigned char* padded, const unsigned char* paddedLight, ChunkQuad* quads);
+void ComputeChunkFaceLinks(const unsigned char* padded, unsigned char* faceLinks);
+unsigned char CoarseVoxelType(const VoxelBuffer* buffer, int x0, int y0, int z0, int size);
+void DownsampleSnapshotVoxels(VoxelBuffer* const* neighbors, int cy, int lod, unsigned char* padded);
+int QuadCornerOcclusion(const ChunkQuad* quad, int corner);
+void EmitQuadVertices(const ChunkQuad* quad, float* vertices, float* texcoords, float* texcoords2, float* normals, unsigned char* colors);
+
+// Geometry is built into the CPU arrays of a Mesh; the caller uploads it (or
+// not, for headless use) and releases the arrays with FreeMeshGeometry.
+Mesh GenQuadGeometry(const ChunkQuad* quads, int quadCount);
+Mesh GenBlockGeometry(BlockType type);
+Mesh GenGroundGeometry(void);
+bool BuildChunkGeometry(World* world, Chunk* chunk, Mesh* mesh);
+void FreeMeshGeometry(Mesh* mesh);
+
+#endif
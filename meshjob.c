@@ -0,0 +1,220 @@
+#include "meshjob.h"
+#include "raylib.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+void RunMeshJob(void* data) {
+    static _Thread_local unsigned char padded[PADDED_CHUNK_VOLUME];
+    static _Thread_local unsigned char paddedLight[PADDED_CHUNK_VOLUME];
+    static _Thread_local ChunkQuad quads[MAX_CHUNK_QUADS];
+    MeshJob* job = (MeshJob*)data;
+
+    if (job->blockCount == 0) {
+        memset(job->faceLinks, ALL_CHUNK_FACES, sizeof(job->faceLinks));
+    } else {
+        // Visibility always follows the full-detail voxels. Distant chunks
+        // are drawn fully lit, with occlusion from the coarse blocks only.
+        GatherSnapshotVoxels(job->neighbors, job->cy, padded);
+        ComputeChunkFaceLinks(padded, job->faceLinks);
+        if (job->lod > 0) DownsampleSnapshotVoxels(job->neighbors, job->cy, job->lod, padded);
+        else GatherSnapshotLight(job->lights, paddedLight);
+        int quadCount = BuildChunkQuads(padded, (job->lod > 0) ? NULL : paddedLight, quads);
+        if (quadCount > 0) {
+            job->mesh = GenQuadGeometry(quads, quadCount);
+            job->hasMesh = true;
+        }
+    }
+
+    MeshBuilder* builder = job->builder;
+    MeshJob* head = atomic_load_explicit(&builder->finished, memory_order_relaxed);
+    do {
+        job->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&builder->finished, &head, job, memory_order_release, memory_order_relaxed));
+}
+
+// Also used for jobs that never ran, from StopJobPool; always on the main
+// thread, which is the only one that touches reference counts and the GPU.
+void FreeMeshJob(void* data) {
+    MeshJob* job = (MeshJob*)data;
+    for (int i = 0; i < CHUNK_NEIGHBORHOOD; i++) {
+        if (job->neighbors[i] != NULL) ReleaseVoxelBuffer(job->neighbors[i]);
+        if (job->lights[i] != NULL) ReleaseLightBuffer(job->lights[i]);
+    }
+    if (job->uploaded) UnloadMesh(job->mesh);
+    else if (job->hasMesh) FreeMeshGeometry(&job->mesh);
+    if (--job->batch->jobCount == 0) RL_FREE(job->batch);
+    RL_FREE(job);
+}
+
+bool StartMeshBuilder(MeshBuilder* builder, int threadCount, float uploadBudgetMs) {
+    *builder = (MeshBuilder){ 0 };
+    atomic_init(&builder->finished, NULL);
+    builder->uploadBudgetMs = uploadBudgetMs;
+    builder->running = StartJobPool(&builder->pool, threadCount);
+    return builder->running;
+}
+
+// Full detail out to fullRadius columns from the camera, then each coarser
+// level out to twice the distance of the one before.
+int ChunkLodForDistance(float distance, int fullRadius) {
+    int lod = 0;
+    float limit = fullRadius + 0.5f;
+    while (lod < MAX_CHUNK_LOD && distance > limit) {
+        lod++;
+        limit *= 2.0f;
+    }
+    return lod;
+}
+
+// Marks chunks whose column has moved into another ring for a rebuild. A
+// chunk keeps its level until the camera is MESH_LOD_HYSTERESIS chunks past
+// the ring edge, so walking along one does not rebuild it back and forth.
+void UpdateChunkLods(World* world, Vector3 position, int fullRadius) {
+    for (int i = 0; i < world->chunkCount; i++) {
+        Chunk* chunk = world->chunks[i];
+        float dx = fabsf((chunk->cx + 0.5f) * CHUNK_SIZE - position.x);
+        float dz = fabsf((chunk->cz + 0.5f) * CHUNK_SIZE - position.z);
+        float distance = fmaxf(dx, dz) / CHUNK_SIZE;
+
+        int lod = chunk->mesh.lod;
+        if (ChunkLodForDistance(distance - MESH_LOD_HYSTERESIS, fullRadius) > lod ||
+            ChunkLodForDistance(distance + MESH_LOD_HYSTERESIS, fullRadius) < lod) {
+            lod = ChunkLodForDistance(distance, fullRadius);
+        }
+        if (lod != chunk->mesh.lod) {
+            chunk->mesh.lod = (unsigned char)lod;
+            chunk->dirty = true;
+        }
+    }
+}
+
+// A chunk already being built stays dirty until that build is swapped in,
+// so no chunk ever has more than one build out however often it is edited,
+// and a waiting build is never overtaken by a newer one.
+// Returns the number of jobs queued.
+int QueueDirtyChunkMeshes(MeshBuilder* builder, World* world) {
+    MeshBatch* batch = NULL;
+    for (int i = 0; i < world->chunkCount; i++) {
+        Chunk* chunk = world->chunks[i];
+        if (!chunk->dirty || chunk->mesh.building) continue;
+        chunk->dirty = false;
+
+        if (batch == NULL) batch = (MeshBatch*)RL_CALLOC(1, sizeof(MeshBatch));
+        MeshJob* job = (MeshJob*)RL_CALLOC(1, sizeof(MeshJob));
+        job->builder = builder;
+        job->batch = batch;
+        job->cx = chunk->cx;
+        job->cy = chunk->cy;
+        job->cz = chunk->cz;
+        job->ticket = ++builder->nextTicket;
+        job->lod = chunk->mesh.lod;
+        job->blockCount = chunk->blockCount;
+        CollectNeighborVoxels(world, chunk->cx, chunk->cy, chunk->cz, job->neighbors);
+        CollectNeighborLight(world, chunk->cx, chunk->cy, chunk->cz, job->lights);
+        for (int n = 0; n < CHUNK_NEIGHBORHOOD; n++) {
+            if (job->neighbors[n] != NULL) RetainVoxelBuffer(job->neighbors[n]);
+            if (job->lights[n] != NULL) RetainLightBuffer(job->lights[n]);
+        }
+        chunk->mesh.ticket = job->ticket;
+        chunk->mesh.building = true;
+        batch->jobCount++;
+        builder->inFlight++;
+        if (builder->running) SubmitJob(&builder->pool, RunMeshJob, job);
+        else RunMeshJob(job);
+    }
+    return batch != NULL ? batch->jobCount : 0;
+}
+
+// The chunk the job was built for, if it still exists and wants this build.
+Chunk* FindMeshJobChunk(World* world, const MeshJob* job) {
+    Chunk* chunk = FindChunk(world, job->cx, job->cy, job->cz);
+    return (chunk != NULL && chunk->mesh.ticket == job->ticket) ? chunk : NULL;
+}
+
+void TakeFinishedMeshJobs(MeshBuilder* builder) {
+    MeshJob* taken = atomic_exchange_explicit(&builder->finished, NULL, memory_order_acquire);
+
+    // The stack hands them over newest first.
+    MeshJob* ordered = NULL;
+    while (taken != NULL) {
+        MeshJob* next = taken->next;
+        taken->next = ordered;
+        ordered = taken;
+        taken = next;
+    }
+    for (MeshJob* job = ordered; job != NULL; job = job->next) {
+        if (builder->waitingCount == builder->waitingCapacity) {
+            builder->waitingCapacity = builder->waitingCapacity ? builder->waitingCapacity * 2 : CHUNK_TABLE_INITIAL_CAPACITY;
+            builder->waiting = (MeshJob**)RL_REALLOC(builder->waiting, builder->waitingCapacity * sizeof(MeshJob*));
+        }
+        builder->waiting[builder->waitingCount++] = job;
+        builder->inFlight--;
+    }
+}
+
+// Uploads waiting meshes oldest first until the budget is spent, at least
+// one per frame, then swaps in every batch that is completely uploaded.
+// Builds for chunks that have since gone skip the upload and are dropped.
+void UploadFinishedMeshes(MeshBuilder* builder, World* world) {
+    TakeFinishedMeshJobs(builder);
+
+    double start = GetTime();
+    double budget = builder->uploadBudgetMs / 1000.0;
+    builder->uploadsLastFrame = 0;
+    for (int i = 0; i < builder->waitingCount; i++) {
+        MeshJob* job = builder->waiting[i];
+        if (job->ready) continue;
+        if (job->hasMesh && FindMeshJobChunk(world, job) != NULL) {
+            if (builder->uploadsLastFrame > 0 && GetTime() - start >= budget) break;
+            UploadMesh(&job->mesh, false);
+            job->uploaded = true;
+            builder->uploadsLastFrame++;
+        }
+        job->ready = true;
+        job->batch->readyCount++;
+    }
+
+    int kept = 0;
+    for (int i = 0; i < builder->waitingCount; i++) {
+        MeshJob* job = builder->waiting[i];
+        if (job->batch->readyCount < job->batch->jobCount) {
+            builder->waiting[kept++] = job;
+            continue;
+        }
+
+        Chunk* chunk = FindMeshJobChunk(world, job);
+        if (chunk != NULL) {
+            chunk->mesh.building = false;
+            UnloadChunkMesh(chunk);
+            if (job->uploaded) {
+                // Geometry lives on the GPU from here on; drop the CPU copy.
+                FreeMeshGeometry(&job->mesh);
+                chunk->mesh.mesh = job->mesh;
+                chunk->mesh.hasMesh = true;
+                job->uploaded = false;
+                job->hasMesh = false;
+            }
+            memcpy(chunk->faceLinks, job->faceLinks, sizeof(chunk->faceLinks));
+        }
+        FreeMeshJob(job);
+    }
+    builder->waitingCount = kept;
+}
+
+void UnloadChunkMesh(Chunk* chunk) {
+    if (chunk->mesh.hasMesh) {
+        UnloadMesh(chunk->mesh.mesh);
+        chunk->mesh.hasMesh = false;
+    }
+}
+
+void StopMeshBuilder(MeshBuilder* builder) {
+    if (builder->running) StopJobPool(&builder->pool, FreeMeshJob);
+    TakeFinishedMeshJobs(builder);
+    for (int i = 0; i < builder->waitingCount; i++) {
+        FreeMeshJob(builder->waiting[i]);
+    }
+    RL_FREE(builder->waiting);
+    *builder = (MeshBuilder){ 0 };
+}
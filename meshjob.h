@@ -0,0 +1,70 @@
+#ifndef MESHJOB_H
+#define MESHJOB_H
+
+#include "world.h"
+#include "mesher.h"
+#include "jobpool.h"
+
+#define MESH_UPLOAD_BUDGET_MS 2.0f
+#define MESH_LOD_HYSTERESIS 0.25f
+
+// All chunks queued in the same frame: their new meshes are swapped in
+// together, so an edit on a chunk border never shows one side remeshed and
+// the other not. Only a chunk whose previous build is still being built or
+// waiting to be swapped in misses the batch, and follows one build later.
+typedef struct {
+    int jobCount;
+    int readyCount;
+} MeshBatch;
+
+struct MeshBuilder;
+
+// Workers see only the retained voxel and light buffers of the chunk and
+// its neighbors, which edits copy rather than change; the buffers are
+// released on the main thread once the result is used.
+typedef struct MeshJob {
+    struct MeshJob* next;
+    struct MeshBuilder* builder;
+    MeshBatch* batch;
+    int cx, cy, cz;
+    unsigned int ticket;
+    int lod;
+    int blockCount;
+    VoxelBuffer* neighbors[CHUNK_NEIGHBORHOOD];
+    LightBuffer* lights[CHUNK_NEIGHBORHOOD];
+
+    Mesh mesh;
+    bool hasMesh;
+    bool uploaded;
+    bool ready;
+    unsigned char faceLinks[CHUNK_FACE_COUNT];
+} MeshJob;
+
+// Workers push finished jobs onto a lock-free stack; the main thread takes
+// the whole stack at once, so neither side ever waits on the other. Taken
+// jobs wait in arrival order until they are uploaded, within
+// uploadBudgetMs per frame, and their whole batch is ready.
+typedef struct MeshBuilder {
+    JobPool pool;
+    bool running;
+    _Atomic(MeshJob*) finished;
+
+    MeshJob** waiting;
+    int waitingCount;
+    int waitingCapacity;
+
+    unsigned int nextTicket;
+    int inFlight;
+    float uploadBudgetMs;
+    int uploadsLastFrame;
+} MeshBuilder;
+
+bool StartMeshBuilder(MeshBuilder* builder, int threadCount, float uploadBudgetMs);
+int ChunkLodForDistance(float distance, int fullRadius);
+void UpdateChunkLods(World* world, Vector3 position, int fullRadius);
+int QueueDirtyChunkMeshes(MeshBuilder* builder, World* world);
+void UploadFinishedMeshes(MeshBuilder* builder, World* world);
+void UnloadChunkMesh(Chunk* chunk);
+void StopMeshBuilder(MeshBuilder* builder);
+
+#endif
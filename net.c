@@ -0,0 +1,277 @@
+#include "net.h"
+#include "raylib.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+void ReserveNetBuffer(NetBuffer* buffer, size_t extra) {
+    if (buffer->size + extra <= buffer->capacity) return;
+
+    size_t capacity = buffer->capacity ? buffer->capacity : 256;
+    while (capacity < buffer->size + extra) capacity *= 2;
+    buffer->data = (unsigned char*)RL_REALLOC(buffer->data, capacity);
+    buffer->capacity = capacity;
+}
+
+void PutNetU8(NetBuffer* buffer, unsigned int value) {
+    ReserveNetBuffer(buffer, 1);
+    buffer->data[buffer->size++] = (unsigned char)value;
+}
+
+void PutNetVarint(NetBuffer* buffer, uint64_t value) {
+    ReserveNetBuffer(buffer, 10);
+    while (value >= 0x80) {
+        buffer->data[buffer->size++] = (unsigned char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    buffer->data[buffer->size++] = (unsigned char)value;
+}
+
+void PutNetSigned(NetBuffer* buffer, int64_t value) {
+    PutNetVarint(buffer, ((uint64_t)value << 1) ^ (uint64_t)(value >> 63));
+}
+
+void PutNetBytes(NetBuffer* buffer, const void* data, size_t size) {
+    ReserveNetBuffer(buffer, size);
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+}
+
+void FreeNetBuffer(NetBuffer* buffer) {
+    RL_FREE(buffer->data);
+    *buffer = (NetBuffer){ 0 };
+}
+
+unsigned int GetNetU8(NetReader* reader) {
+    if (reader->pos >= reader->size) {
+        reader->ok = false;
+        return 0;
+    }
+    return reader->data[reader->pos++];
+}
+
+uint64_t GetNetVarint(NetReader* reader) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        unsigned int byte = GetNetU8(reader);
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    reader->ok = false;
+    return 0;
+}
+
+int64_t GetNetSigned(NetReader* reader) {
+    uint64_t value = GetNetVarint(reader);
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+// Coordinates and counts; anything outside int range is malformed.
+int GetNetInt(NetReader* reader) {
+    int64_t value = GetNetSigned(reader);
+    if (value < -0x7FFFFFFF || value > 0x7FFFFFFF) reader->ok = false;
+    return reader->ok ? (int)value : 0;
+}
+
+const unsigned char* GetNetBytes(NetReader* reader, size_t size) {
+    if (size > reader->size - reader->pos) {
+        reader->ok = false;
+        return NULL;
+    }
+    const unsigned char* bytes = reader->data + reader->pos;
+    reader->pos += size;
+    return bytes;
+}
+
+#ifdef _WIN32
+
+// Local sockets are only implemented for POSIX systems so far.
+int NetListen(const char* path) { return -1; }
+bool NetAccept(int listenFd, NetConnection* connection) { return false; }
+bool NetConnect(const char* path, NetConnection* connection) { return false; }
+void NetUnlisten(int listenFd, const char* path) { }
+bool FlushNetConnection(NetConnection* connection) { return false; }
+bool ReceiveNetData(NetConnection* connection) { return false; }
+
+void CloseNetConnection(NetConnection* connection) {
+    FreeNetBuffer(&connection->in);
+    FreeNetBuffer(&connection->out);
+    connection->closed = true;
+}
+
+#else
+
+bool SetNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool FillSocketAddress(struct sockaddr_un* address, const char* path) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path)) return false;
+    strcpy(address->sun_path, path);
+    return true;
+}
+
+// A socket file left behind by a server that crashed is removed first.
+int NetListen(const char* path) {
+    struct sockaddr_un address;
+    if (!FillSocketAddress(&address, path)) return -1;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 64) != 0 || !SetNonBlocking(fd)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool NetAccept(int listenFd, NetConnection* connection) {
+    int fd = accept(listenFd, NULL, NULL);
+    if (fd < 0) return false;
+    if (!SetNonBlocking(fd)) {
+        close(fd);
+        return false;
+    }
+    *connection = (NetConnection){ 0 };
+    connection->fd = fd;
+    return true;
+}
+
+// Connects blocking, then switches to non-blocking like the server side.
+bool NetConnect(const char* path, NetConnection* connection) {
+    struct sockaddr_un address;
+    if (!FillSocketAddress(&address, path)) return false;
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || !SetNonBlocking(fd)) {
+        close(fd);
+        return false;
+    }
+    *connection = (NetConnection){ 0 };
+    connection->fd = fd;
+    return true;
+}
+
+void NetUnlisten(int listenFd, const char* path) {
+    if (listenFd < 0) return;
+    close(listenFd);
+    unlink(path);
+}
+
+// Writes as much as the socket takes without blocking. A peer that lets
+// NET_MAX_PENDING bytes pile up is cut off rather than buffered forever.
+bool FlushNetConnection(NetConnection* connection) {
+    if (connection->closed) return false;
+
+    size_t written = 0;
+    while (written < connection->out.size) {
+        ssize_t count = send(connection->fd, connection->out.data + written, connection->out.size - written, MSG_NOSIGNAL);
+        if (count > 0) {
+            written += (size_t)count;
+        } else if (count < 0 && errno == EINTR) {
+            continue;
+        } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else {
+            connection->closed = true;
+            return false;
+        }
+    }
+
+    if (written > 0) {
+        connection->bytesSent += written;
+        memmove(connection->out.data, connection->out.data + written, connection->out.size - written);
+        connection->out.size -= written;
+    }
+    if (connection->out.size > NET_MAX_PENDING) connection->closed = true;
+    return !connection->closed;
+}
+
+// Appends whatever has arrived. Messages returned by NextNetMessage point
+// into the receive buffer, so they must be handled before the next call.
+bool ReceiveNetData(NetConnection* connection) {
+    if (connection->closed) return false;
+
+    NetBuffer* in = &connection->in;
+    if (connection->inStart > 0) {
+        memmove(in->data, in->data + connection->inStart, in->size - connection->inStart);
+        in->size -= connection->inStart;
+        connection->inStart = 0;
+    }
+
+    // Stop once a full frame's worth is queued; the rest waits in the socket.
+    while (in->size < NET_MAX_MESSAGE + 4) {
+        ReserveNetBuffer(in, NET_READ_SIZE);
+        ssize_t count = recv(connection->fd, in->data + in->size, in->capacity - in->size, 0);
+        if (count > 0) {
+            in->size += (size_t)count;
+            connection->bytesReceived += (uint64_t)count;
+        } else if (count < 0 && errno == EINTR) {
+            continue;
+        } else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        } else {
+            connection->closed = true;
+            return false;
+        }
+    }
+    return true;
+}
+
+void CloseNetConnection(NetConnection* connection) {
+    if (connection->fd >= 0) close(connection->fd);
+    connection->fd = -1;
+    FreeNetBuffer(&connection->in);
+    FreeNetBuffer(&connection->out);
+    connection->closed = true;
+}
+
+#endif
+
+NetBuffer* BeginNetMessage(NetConnection* connection, NetMessageType type) {
+    NetBuffer* out = &connection->out;
+    connection->messageStart = out->size;
+    ReserveNetBuffer(out, 5);
+    out->size += 4;
+    out->data[out->size++] = (unsigned char)type;
+    return out;
+}
+
+void EndNetMessage(NetConnection* connection) {
+    NetBuffer* out = &connection->out;
+    size_t length = out->size - connection->messageStart - 4;
+    for (int i = 0; i < 4; i++) out->data[connection->messageStart + i] = (unsigned char)(length >> (8 * i));
+}
+
+// A frame that claims to be empty or larger than NET_MAX_MESSAGE closes the
+// connection; the stream cannot be resynchronised after it.
+bool NextNetMessage(NetConnection* connection, NetMessageType* type, NetReader* reader) {
+    const NetBuffer* in = &connection->in;
+    size_t available = in->size - connection->inStart;
+    if (connection->closed || available < 4) return false;
+
+    const unsigned char* frame = in->data + connection->inStart;
+    size_t length = (size_t)frame[0] | (size_t)frame[1] << 8 | (size_t)frame[2] << 16 | (size_t)frame[3] << 24;
+    if (length == 0 || length > NET_MAX_MESSAGE) {
+        connection->closed = true;
+        return false;
+    }
+    if (available - 4 < length) return false;
+
+    *type = (NetMessageType)frame[4];
+    *reader = (NetReader){ frame + 5, length - 1, 0, true };
+    connection->inStart += 4 + length;
+    return true;
+}
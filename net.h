@@ -0,0 +1,87 @@
+#ifndef NET_H
+#define NET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Messages travel over a local stream socket as frames: u32 length of what
+// follows, u8 type, payload. Integers in payloads are varints, signed ones
+// zigzag-encoded, so small deltas cost a byte.
+#define NET_DEFAULT_SOCKET "box.sock"
+#define NET_MAX_MESSAGE (1024 * 1024)
+#define NET_MAX_PENDING (16 * 1024 * 1024)
+#define NET_READ_SIZE (64 * 1024)
+#define NET_MAX_EDITS_PER_MESSAGE 16384
+
+typedef enum {
+    // Client to server.
+    NET_HELLO = 1,        // view radius
+    NET_POSITION,         // cell x, y, z
+    NET_EDITS,            // count, then per edit: x, y, z delta from the last one, type
+
+    // Server to client.
+    NET_WELCOME = 64,     // client id
+    NET_COLUMN,           // cx, cz, number of NET_CHUNK messages that follow
+    NET_CHUNK,            // cx, cy, cz, block count, save blob
+    NET_DROP_COLUMN,      // cx, cz
+    NET_CHANGES           // tick, chunk count, then per chunk: cx, cy, cz delta, change count,
+                          // then per change: voxel index delta - 1, type
+} NetMessageType;
+
+typedef struct {
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+} NetBuffer;
+
+// A reader that turns every overrun into ok = false instead of a crash, so a
+// malformed message is simply dropped.
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    size_t pos;
+    bool ok;
+} NetReader;
+
+// in holds received bytes not yet parsed from inStart on; out holds framed
+// messages not yet written. messageStart is where the frame being built
+// begins.
+typedef struct {
+    int fd;
+    NetBuffer in;
+    size_t inStart;
+    NetBuffer out;
+    size_t messageStart;
+    bool closed;
+
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+} NetConnection;
+
+void ReserveNetBuffer(NetBuffer* buffer, size_t extra);
+void PutNetU8(NetBuffer* buffer, unsigned int value);
+void PutNetVarint(NetBuffer* buffer, uint64_t value);
+void PutNetSigned(NetBuffer* buffer, int64_t value);
+void PutNetBytes(NetBuffer* buffer, const void* data, size_t size);
+void FreeNetBuffer(NetBuffer* buffer);
+
+unsigned int GetNetU8(NetReader* reader);
+uint64_t GetNetVarint(NetReader* reader);
+int64_t GetNetSigned(NetReader* reader);
+int GetNetInt(NetReader* reader);
+const unsigned char* GetNetBytes(NetReader* reader, size_t size);
+
+int NetListen(const char* path);
+bool NetAccept(int listenFd, NetConnection* connection);
+bool NetConnect(const char* path, NetConnection* connection);
+void NetUnlisten(int listenFd, const char* path);
+
+NetBuffer* BeginNetMessage(NetConnection* connection, NetMessageType type);
+void EndNetMessage(NetConnection* connection);
+bool FlushNetConnection(NetConnection* connection);
+bool ReceiveNetData(NetConnection* connection);
+bool NextNetMessage(NetConnection* connection, NetMessageType* type, NetReader* reader);
+void CloseNetConnection(NetConnection* connection);
+
+#endif
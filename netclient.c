@@ -0,0 +1,211 @@
+#include "netclient.h"
+#include "save.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool ConnectNetClient(NetClient* client, const char* path, World* world, int viewRadius) {
+    *client = (NetClient){ 0 };
+    client->world = world;
+    if (!NetConnect(path, &client->connection)) {
+        client->connection.fd = -1;
+        client->connection.closed = true;
+        return false;
+    }
+
+    NetBuffer* out = BeginNetMessage(&client->connection, NET_HELLO);
+    PutNetVarint(out, (uint64_t)viewRadius);
+    EndNetMessage(&client->connection);
+    return FlushNetConnection(&client->connection);
+}
+
+// Only column changes matter to the server, so that is all that is sent.
+void SendNetPosition(NetClient* client, Vector3 position) {
+    int x, y, z;
+    CellFromPosition(position, &x, &y, &z);
+    if (client->sentPosition && x >> CHUNK_SHIFT == client->positionX && z >> CHUNK_SHIFT == client->positionZ) return;
+
+    NetBuffer* out = BeginNetMessage(&client->connection, NET_POSITION);
+    PutNetSigned(out, x);
+    PutNetSigned(out, y);
+    PutNetSigned(out, z);
+    EndNetMessage(&client->connection);
+    client->sentPosition = true;
+    client->positionX = x >> CHUNK_SHIFT;
+    client->positionZ = z >> CHUNK_SHIFT;
+}
+
+void FlushNetEdits(NetClient* client) {
+    if (client->editCount == 0) return;
+
+    NetBuffer* out = BeginNetMessage(&client->connection, NET_EDITS);
+    PutNetVarint(out, (uint64_t)client->editCount);
+    PutNetBytes(out, client->edits.data, client->edits.size);
+    EndNetMessage(&client->connection);
+
+    client->edits.size = 0;
+    client->editCount = 0;
+    client->lastEditX = client->lastEditY = client->lastEditZ = 0;
+}
+
+void QueueNetEdit(NetClient* client, int x, int y, int z, BlockType type) {
+    PutNetSigned(&client->edits, x - client->lastEditX);
+    PutNetSigned(&client->edits, y - client->lastEditY);
+    PutNetSigned(&client->edits, z - client->lastEditZ);
+    PutNetU8(&client->edits, type);
+    client->lastEditX = x;
+    client->lastEditY = y;
+    client->lastEditZ = z;
+    if (++client->editCount >= NET_MAX_EDITS_PER_MESSAGE) FlushNetEdits(client);
+}
+
+// Sends one side of an edit's diffs, which is exactly the set of cells it
+// changed.
+void QueueEditRecord(NetClient* client, const EditRecord* record, bool undo) {
+    for (int c = 0; c < record->chunkCount; c++) {
+        const ChunkDiff* diff = &record->chunks[c];
+        const unsigned char* values = undo ? diff->before : diff->after;
+        int v = 0;
+        for (int r = 0; r < diff->runCount; r++) {
+            int start = diff->runs[2 * r];
+            for (int i = start; i < start + diff->runs[2 * r + 1]; i++, v++) {
+                int x = diff->cx * CHUNK_SIZE + (i & CHUNK_MASK);
+                int y = diff->cy * CHUNK_SIZE + (i >> (2 * CHUNK_SHIFT));
+                int z = diff->cz * CHUNK_SIZE + ((i >> CHUNK_SHIFT) & CHUNK_MASK);
+                QueueNetEdit(client, x, y, z, (BlockType)values[v]);
+            }
+        }
+    }
+}
+
+void RemoveColumnChunks(World* world, int cx, int cz) {
+    for (int cy = world->minChunkY; world->hasBounds && cy <= world->maxChunkY; cy++) {
+        Chunk* chunk = FindChunk(world, cx, cy, cz);
+        if (chunk == NULL) continue;
+        RemoveChunk(world, chunk);
+        MarkNeighborsDirty(world, cx, cy, cz);
+    }
+}
+
+void ReceiveNetChunk(NetClient* client, NetReader* reader) {
+    static unsigned char voxels[CHUNK_VOLUME];
+    int cx = GetNetInt(reader);
+    int cy = GetNetInt(reader);
+    int cz = GetNetInt(reader);
+    int blockCount = (int)GetNetVarint(reader);
+    size_t blobSize = reader->ok ? reader->size - reader->pos : 0;
+    const unsigned char* blob = GetNetBytes(reader, blobSize);
+
+    int* remaining = FindCoord(&client->columns, cx, 0, cz);
+    if (!reader->ok || remaining == NULL || *remaining == 0) return;
+    (*remaining)--;
+    client->chunksReceived++;
+
+    World* world = client->world;
+    if (world == NULL || blockCount <= 0 || blockCount > CHUNK_VOLUME) return;
+    if (!DecodeChunk(blob, blobSize, voxels)) return;
+
+    // A chunk sent again replaces what is here; only the cells that differ
+    // need relighting.
+    Chunk* chunk = FindChunk(world, cx, cy, cz);
+    if (chunk == NULL) {
+        chunk = CreateChunk(world, cx, cy, cz);
+    } else {
+        for (int i = 0; i < CHUNK_VOLUME; i++) {
+            if (chunk->voxels->data[i] == voxels[i]) continue;
+            MarkLightDirty(world, cx * CHUNK_SIZE + (i & CHUNK_MASK), cy * CHUNK_SIZE + (i >> (2 * CHUNK_SHIFT)),
+                           cz * CHUNK_SIZE + ((i >> CHUNK_SHIFT) & CHUNK_MASK));
+        }
+    }
+    memcpy(GetWritableVoxels(chunk), voxels, CHUNK_VOLUME);
+    world->blockCount += blockCount - chunk->blockCount;
+    chunk->blockCount = blockCount;
+    chunk->dirty = true;
+    MarkNeighborsDirty(world, cx, cy, cz);
+}
+
+// Changes come in per-chunk batches in the order the server encoded them;
+// see NET_CHANGES.
+void ReceiveNetChanges(NetClient* client, NetReader* reader) {
+    GetNetVarint(reader);
+    int batchCount = (int)GetNetVarint(reader);
+    int cx = 0, cy = 0, cz = 0;
+
+    for (int b = 0; b < batchCount && reader->ok; b++) {
+        cx += GetNetInt(reader);
+        cy += GetNetInt(reader);
+        cz += GetNetInt(reader);
+        int count = (int)GetNetVarint(reader);
+        int index = -1;
+        for (int i = 0; i < count && reader->ok; i++) {
+            index += (int)GetNetVarint(reader) + 1;
+            unsigned int type = GetNetU8(reader);
+            if (!reader->ok || index >= CHUNK_VOLUME || type >= BLOCK_TYPE_COUNT) {
+                reader->ok = false;
+                break;
+            }
+            client->changesReceived++;
+            if (client->world == NULL) continue;
+
+            int x = cx * CHUNK_SIZE + (index & CHUNK_MASK);
+            int y = cy * CHUNK_SIZE + (index >> (2 * CHUNK_SHIFT));
+            int z = cz * CHUNK_SIZE + ((index >> CHUNK_SHIFT) & CHUNK_MASK);
+            SetBlock(client->world, x, y, z, (BlockType)type);
+        }
+    }
+}
+
+void HandleServerMessage(NetClient* client, NetMessageType type, NetReader* reader) {
+    World* world = client->world;
+    if (type == NET_WELCOME) {
+        client->id = (int)GetNetVarint(reader);
+        client->welcomed = reader->ok;
+    } else if (type == NET_COLUMN) {
+        int cx = GetNetInt(reader);
+        int cz = GetNetInt(reader);
+        int count = (int)GetNetVarint(reader);
+        if (!reader->ok) return;
+
+        // Whatever the column held before, including predicted edits, is
+        // replaced by the snapshot.
+        if (world != NULL) RemoveColumnChunks(world, cx, cz);
+        int* remaining = InsertCoord(&client->columns, cx, 0, cz, count);
+        *remaining = count;
+    } else if (type == NET_CHUNK) {
+        ReceiveNetChunk(client, reader);
+    } else if (type == NET_DROP_COLUMN) {
+        int cx = GetNetInt(reader);
+        int cz = GetNetInt(reader);
+        if (!reader->ok) return;
+        if (world != NULL) RemoveColumnChunks(world, cx, cz);
+        RemoveCoord(&client->columns, cx, 0, cz);
+    } else if (type == NET_CHANGES) {
+        ReceiveNetChanges(client, reader);
+    }
+}
+
+// Sends queued edits and applies everything the server has sent since the
+// last call. Returns false once the connection is gone.
+bool UpdateNetClient(NetClient* client) {
+    FlushNetEdits(client);
+    FlushNetConnection(&client->connection);
+    ReceiveNetData(&client->connection);
+
+    NetMessageType type;
+    NetReader reader;
+    while (NextNetMessage(&client->connection, &type, &reader)) {
+        HandleServerMessage(client, type, &reader);
+    }
+    return !client->connection.closed;
+}
+
+bool IsNetColumnReady(const NetClient* client, int x, int z) {
+    int* remaining = FindCoord(&client->columns, x >> CHUNK_SHIFT, 0, z >> CHUNK_SHIFT);
+    return remaining != NULL && *remaining == 0;
+}
+
+void CloseNetClient(NetClient* client) {
+    CloseNetConnection(&client->connection);
+    FreeCoordMap(&client->columns);
+    FreeNetBuffer(&client->edits);
+    *client = (NetClient){ 0 };
+}
@@ -0,0 +1,40 @@
+#ifndef NETCLIENT_H
+#define NETCLIENT_H
+
+#include "world.h"
+#include "edit.h"
+#include "net.h"
+
+// The client side of a server connection. Chunks arrive into world, which
+// holds nothing else; with world NULL messages are only parsed and counted,
+// as the load test does. columns maps each column being received or held
+// (cy = 0) to the number of its chunks still on the way. Edits are applied
+// locally right away and queued as intents; the server's answer overwrites
+// any that lost a race or were refused.
+typedef struct {
+    NetConnection connection;
+    World* world;
+    int id;
+    bool welcomed;
+    CoordMap columns;
+
+    bool sentPosition;
+    int positionX, positionZ;
+
+    NetBuffer edits;
+    int editCount;
+    int lastEditX, lastEditY, lastEditZ;
+
+    uint64_t changesReceived;
+    uint64_t chunksReceived;
+} NetClient;
+
+bool ConnectNetClient(NetClient* client, const char* path, World* world, int viewRadius);
+void SendNetPosition(NetClient* client, Vector3 position);
+void QueueNetEdit(NetClient* client, int x, int y, int z, BlockType type);
+void QueueEditRecord(NetClient* client, const EditRecord* record, bool undo);
+bool UpdateNetClient(NetClient* client);
+bool IsNetColumnReady(const NetClient* client, int x, int z);
+void CloseNetClient(NetClient* client);
+
+#endif
@@ -0,0 +1,191 @@
+#include "raylib.h"
+#include "mesher.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Build-time tool: bakes the block textures into assets.h so the game starts
+// without touching the disk. The atlas is stored as RGBA8 with its whole mip
+// chain after the base level, the layout LoadTextureFromImage uploads as is.
+
+#define GRASS_SIDE_DEPTH 12
+#define PACK_BYTES_PER_LINE 16
+
+Image LoadTileImage(const char* fileName) {
+    Image image = LoadImage(fileName);
+    if (image.data == NULL) {
+        fprintf(stderr, "pack: cannot load %s\n", fileName);
+        exit(1);
+    }
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    if (image.width != TILE_PIXELS || image.height != TILE_PIXELS) {
+        ImageResizeNN(&image, TILE_PIXELS, TILE_PIXELS);
+    }
+    return image;
+}
+
+// Grass sides are dirt with a ragged strip of the grass texture along the top.
+Image GenGrassSideImage(Image grass, Image dirt) {
+    Image side = ImageCopy(dirt);
+    Color* sidePixels = (Color*)side.data;
+    Color* grassPixels = (Color*)grass.data;
+
+    for (int x = 0; x < TILE_PIXELS; x++) {
+        int depth = GRASS_SIDE_DEPTH + (int)((x * 7u + (x >> 2) * 13u) % 5u) - 2;
+        for (int y = 0; y < depth; y++) {
+            sidePixels[y * TILE_PIXELS + x] = grassPixels[y * TILE_PIXELS + x];
+        }
+    }
+    return side;
+}
+
+Image GenLeavesImage(Image grass) {
+    Image leaves = ImageCopy(grass);
+    ImageColorTint(&leaves, (Color){ 110, 170, 100, 255 });
+
+    Color* pixels = (Color*)leaves.data;
+    for (int i = 0; i < TILE_PIXELS * TILE_PIXELS; i++) {
+        if ((i * 2654435761u >> 28) < 3) {
+            pixels[i] = (Color){ pixels[i].r / 2, pixels[i].g / 2, pixels[i].b / 2, 255 };
+        }
+    }
+    return leaves;
+}
+
+// Sand keeps the grain of the dirt texture at its own pale colour.
+Image GenSandImage(Image dirt) {
+    Image sand = ImageCopy(dirt);
+    Color* pixels = (Color*)sand.data;
+    for (int i = 0; i < TILE_PIXELS * TILE_PIXELS; i++) {
+        int light = 160 + (pixels[i].r + pixels[i].g + pixels[i].b) / 8;
+        pixels[i] = (Color){ (unsigned char)(light * 230 / 255), (unsigned char)(light * 205 / 255), (unsigned char)(light * 145 / 255), 255 };
+    }
+    return sand;
+}
+
+// Gravel is stone broken into 8x8 pebbles of random brightness.
+Image GenGravelImage(Image stone) {
+    Image gravel = ImageCopy(stone);
+    Color* pixels = (Color*)gravel.data;
+    for (int y = 0; y < TILE_PIXELS; y++) {
+        for (int x = 0; x < TILE_PIXELS; x++) {
+            unsigned int pebble = ((x >> 3) + (y >> 3) * 16 + ((x >> 2) & 1)) * 2654435761u;
+            int scale = 70 + (int)(pebble >> 27) * 3;
+            Color* p = &pixels[y * TILE_PIXELS + x];
+            *p = (Color){ (unsigned char)(p->r * scale / 100 > 255 ? 255 : p->r * scale / 100),
+                          (unsigned char)(p->g * scale / 100 > 255 ? 255 : p->g * scale / 100),
+                          (unsigned char)(p->b * scale / 100 > 255 ? 255 : p->b * scale / 100), 255 };
+        }
+    }
+    return gravel;
+}
+
+// Lamps are warm light behind a grid of stone bars.
+Image GenLampImage(Image stone) {
+    Image lamp = ImageCopy(stone);
+    Color* pixels = (Color*)lamp.data;
+    for (int y = 0; y < TILE_PIXELS; y++) {
+        for (int x = 0; x < TILE_PIXELS; x++) {
+            if ((x & 15) < 3 || (y & 15) < 3) continue;
+            Color* p = &pixels[y * TILE_PIXELS + x];
+            int glow = 200 + (p->r + p->g + p->b) / 15;
+            *p = (Color){ 255, (unsigned char)(glow * 220 / 255), (unsigned char)(glow * 140 / 255), 255 };
+        }
+    }
+    return lamp;
+}
+
+// Each level is a 2x2 box filter of the one above. Tiles are power-of-two
+// sized and aligned, so no tile bleeds into its neighbour until it shrinks
+// below one texel; the game never samples past that level, but GL wants the
+// chain to reach 1x1.
+int GenAtlasMipmaps(const Color* base, Color* out) {
+    memcpy(out, base, ATLAS_PIXELS * ATLAS_PIXELS * sizeof(Color));
+
+    int levels = 1;
+    const Color* src = out;
+    Color* dst = out + ATLAS_PIXELS * ATLAS_PIXELS;
+    for (int size = ATLAS_PIXELS / 2; size >= 1; size /= 2) {
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                const Color* a = &src[(2 * y) * (2 * size) + 2 * x];
+                const Color* b = a + 2 * size;
+                dst[y * size + x] = (Color){
+                    (unsigned char)((a[0].r + a[1].r + b[0].r + b[1].r + 2) / 4),
+                    (unsigned char)((a[0].g + a[1].g + b[0].g + b[1].g + 2) / 4),
+                    (unsigned char)((a[0].b + a[1].b + b[0].b + b[1].b + 2) / 4),
+                    (unsigned char)((a[0].a + a[1].a + b[0].a + b[1].a + 2) / 4)
+                };
+            }
+        }
+        src = dst;
+        dst += size * size;
+        levels++;
+    }
+    return levels;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s OUTPUT.h\n", argv[0]);
+        return 1;
+    }
+    SetTraceLogLevel(LOG_ERROR);
+
+    Image tiles[TILE_COUNT];
+    tiles[TILE_STONE] = LoadTileImage("stone.png");
+    tiles[TILE_GRASS_TOP] = LoadTileImage("grass.png");
+    tiles[TILE_DIRT] = LoadTileImage("dirt.png");
+    tiles[TILE_WOOD] = LoadTileImage("wood.png");
+    tiles[TILE_GRASS_SIDE] = GenGrassSideImage(tiles[TILE_GRASS_TOP], tiles[TILE_DIRT]);
+    tiles[TILE_LEAVES] = GenLeavesImage(tiles[TILE_GRASS_TOP]);
+    tiles[TILE_SAND] = GenSandImage(tiles[TILE_DIRT]);
+    tiles[TILE_GRAVEL] = GenGravelImage(tiles[TILE_STONE]);
+    tiles[TILE_LAMP] = GenLampImage(tiles[TILE_STONE]);
+
+    static Color atlas[ATLAS_PIXELS * ATLAS_PIXELS];
+    for (int i = 0; i < TILE_COUNT; i++) {
+        const Color* pixels = (const Color*)tiles[i].data;
+        int originX = (i % ATLAS_COLUMNS) * TILE_PIXELS;
+        int originY = (i / ATLAS_COLUMNS) * TILE_PIXELS;
+        for (int y = 0; y < TILE_PIXELS; y++) {
+            memcpy(&atlas[(originY + y) * ATLAS_PIXELS + originX], &pixels[y * TILE_PIXELS], TILE_PIXELS * sizeof(Color));
+        }
+        UnloadImage(tiles[i]);
+    }
+
+    // A full chain is at most 4/3 of the base level.
+    static Color chain[ATLAS_PIXELS * ATLAS_PIXELS * 4 / 3 + 1];
+    int mipmaps = GenAtlasMipmaps(atlas, chain);
+    size_t size = 0;
+    for (int level = 0; level < mipmaps; level++) {
+        size_t side = ATLAS_PIXELS >> level;
+        size += side * side * sizeof(Color);
+    }
+
+    FILE* file = fopen(argv[1], "w");
+    if (file == NULL) {
+        fprintf(stderr, "pack: cannot write %s\n", argv[1]);
+        return 1;
+    }
+
+    fprintf(file, "// Generated by pack.c from stone.png, grass.png, dirt.png and wood.png. Do not edit.\n");
+    fprintf(file, "#ifndef ASSETS_H\n#define ASSETS_H\n\n");
+    fprintf(file, "#define ASSET_ATLAS_PIXELS %i\n", ATLAS_PIXELS);
+    fprintf(file, "#define ASSET_ATLAS_MIPMAPS %i\n\n", mipmaps);
+    fprintf(file, "static const unsigned char assetAtlas[%zu] = {\n", size);
+
+    const unsigned char* bytes = (const unsigned char*)chain;
+    for (size_t i = 0; i < size; i++) {
+        fprintf(file, "%s0x%02x,%s", (i % PACK_BYTES_PER_LINE == 0) ? "    " : "", bytes[i],
+                (i % PACK_BYTES_PER_LINE == PACK_BYTES_PER_LINE - 1 || i + 1 == size) ? "\n" : "");
+    }
+    fprintf(file, "};\n\n#endif\n");
+
+    if (fclose(file) != 0) {
+        fprintf(stderr, "pack: cannot write %s\n", argv[1]);
+        remove(argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "physics.h"
+#include <math.h>
+
+bool CheckAABBCollision(BoundingBox box1, BoundingBox box2) {
+    return (box1.min.x <= box2.max.x && box1.max.x >= box2.min.x) &&
+           (box1.min.y <= box2.max.y && box1.max.y >= box2.min.y) &&
+           (box1.min.z <= box2.max.z && box1.max.z >= box2.min.z);
+}
+
+BoundingBox PlayerBox(Vector3 position) {
+    return (BoundingBox){
+        (Vector3){ position.x - PLAYER_RADIUS, position.y - PLAYER_HEIGHT / 2.0f, position.z - PLAYER_RADIUS },
+        (Vector3){ position.x + PLAYER_RADIUS, position.y + PLAYER_HEIGHT / 2.0f, position.z + PLAYER_RADIUS }
+    };
+}
+
+bool CheckPlayerCollision(Vector3 playerPos, World* world) {
+    BoundingBox playerBox = PlayerBox(playerPos);
+
+    int x0, y0, z0, x1, y1, z1;
+    CellRangeForBox(playerBox, &x0, &y0, &z0, &x1, &y1, &z1);
+
+    for (int y = y0; y <= y1; y++) {
+        for (int z = z0; z <= z1; z++) {
+            for (int x = x0; x <= x1; x++) {
+                if (GetBlock(world, x, y, z) != BLOCK_AIR && CheckAABBCollision(playerBox, CellBox(x, y, z))) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+float AxisComponent(Vector3 v, int axis) {
+    return (axis == 0) ? v.x : ((axis == 1) ? v.y : v.z);
+}
+
+bool IsSolidCell(World* world, int x, int y, int z) {
+    return GetBlock(world, x, y, z) != BLOCK_AIR || IsGroundCell(y);
+}
+
+// Swept AABB along one axis: every solid cell the box would pass through is
+// considered and the move is clipped to the nearest one, so fast or long
+// steps can't skip over thin walls and all contacts on the axis are resolved.
+float SweepBoxAxis(World* world, BoundingBox box, int axis, float distance) {
+    if (distance == 0.0f) return 0.0f;
+
+    BoundingBox swept = box;
+    if (axis == 0) { if (distance > 0) swept.max.x += distance; else swept.min.x += distance; }
+    if (axis == 1) { if (distance > 0) swept.max.y += distance; else swept.min.y += distance; }
+    if (axis == 2) { if (distance > 0) swept.max.z += distance; else swept.min.z += distance; }
+
+    int x0, y0, z0, x1, y1, z1;
+    CellRangeForBox(swept, &x0, &y0, &z0, &x1, &y1, &z1);
+
+    float boxMin = AxisComponent(box.min, axis);
+    float boxMax = AxisComponent(box.max, axis);
+
+    for (int y = y0; y <= y1; y++) {
+        for (int z = z0; z <= z1; z++) {
+            for (int x = x0; x <= x1; x++) {
+                if (!IsSolidCell(world, x, y, z)) continue;
+
+                BoundingBox cell = CellBox(x, y, z);
+                bool overlapsOtherAxes = true;
+                for (int other = 0; other < 3; other++) {
+                    if (other == axis) continue;
+                    if (AxisComponent(box.max, other) <= AxisComponent(cell.min, other) + COLLISION_EPSILON ||
+                        AxisComponent(box.min, other) >= AxisComponent(cell.max, other) - COLLISION_EPSILON) {
+                        overlapsOtherAxes = false;
+                        break;
+                    }
+                }
+                if (!overlapsOtherAxes) continue;
+
+                float cellMin = AxisComponent(cell.min, axis);
+                float cellMax = AxisComponent(cell.max, axis);
+                if (distance > 0.0f && cellMin >= boxMax - COLLISION_EPSILON) {
+                    distance = fminf(distance, cellMin - boxMax);
+                } else if (distance < 0.0f && cellMax <= boxMin + COLLISION_EPSILON) {
+                    distance = fmaxf(distance, cellMax - boxMin);
+                }
+            }
+        }
+    }
+
+    return distance;
+}
+
+// One fixed PHYSICS_TIMESTEP of player movement: horizontal axes first, then
+// gravity and the vertical sweep, which also decides whether we are grounded.
+void StepPlayer(Player* player, World* world, Vector3 moveDir, bool jump, float dt) {
+    player->previousPosition = player->position;
+
+    float dx = SweepBoxAxis(world, PlayerBox(player->position), 0, moveDir.x * CAMERA_SPEED * dt);
+    player->position.x += dx;
+    float dz = SweepBoxAxis(world, PlayerBox(player->position), 2, moveDir.z * CAMERA_SPEED * dt);
+    player->position.z += dz;
+
+    if (player->isGrounded && jump) {
+        player->velocityY = JUMP_FORCE;
+    }
+    player->velocityY += GRAVITY * dt;
+
+    float wantedY = player->velocityY * dt;
+    float dy = SweepBoxAxis(world, PlayerBox(player->position), 1, wantedY);
+    player->position.y += dy;
+
+    bool blocked = fabsf(dy - wantedY) > COLLISION_EPSILON;
+    player->isGrounded = blocked && wantedY < 0.0f;
+    if (blocked) {
+        player->velocityY = 0.0f;
+    }
+
+    if (player->position.y < RESPAWN_Y_THRESHOLD) {
+        player->position = player->spawnPosition;
+        player->previousPosition = player->position;
+        player->velocityY = 0.0f;
+    }
+}
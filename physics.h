@@ -0,0 +1,35 @@
+#ifndef PHYSICS_H
+#define PHYSICS_H
+
+#include "world.h"
+
+#define GRAVITY -35.0f
+#define JUMP_FORCE 10.0f
+#define RESPAWN_Y_THRESHOLD -10.0f
+
+#define CAMERA_HEIGHT 2.0f
+#define CAMERA_SPEED 4.0f
+#define PLAYER_RADIUS 0.3f
+#define PLAYER_HEIGHT 2.0f
+#define SPAWN_POSITION (Vector3){ 50.0f, CAMERA_HEIGHT, 50.0f }
+
+#define PHYSICS_TIMESTEP (1.0f / 120.0f)
+#define MAX_PHYSICS_STEPS 8
+#define COLLISION_EPSILON 0.0001f
+
+typedef struct {
+    Vector3 position;
+    Vector3 previousPosition;
+    Vector3 spawnPosition;
+    float velocityY;
+    bool isGrounded;
+} Player;
+
+bool CheckAABBCollision(BoundingBox box1, BoundingBox box2);
+BoundingBox PlayerBox(Vector3 position);
+bool CheckPlayerCollision(Vector3 playerPos, World* world);
+bool IsSolidCell(World* world, int x, int y, int z);
+float SweepBoxAxis(World* world, BoundingBox box, int axis, float distance);
+void StepPlayer(Player* player, World* world, Vector3 moveDir, bool jump, float dt);
+
+#endif
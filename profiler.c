@@ -0,0 +1,184 @@
+#include "profiler.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const char* profileStageNames[PROFILE_STAGE_COUNT] = {
+    "input", "save", "stream", "physics", "entity", "tick", "raycast", "edit", "light", "mesh", "cull", "draw", "present"
+};
+
+const Color profileStageColors[PROFILE_STAGE_COUNT] = {
+    { 200, 200, 200, 255 }, { 255, 161, 0, 255 }, { 0, 228, 48, 255 }, { 0, 121, 241, 255 }, { 127, 106, 79, 255 },
+    { 0, 117, 44, 255 }, { 253, 249, 0, 255 }, { 255, 109, 194, 255 }, { 255, 203, 0, 255 }, { 230, 41, 55, 255 },
+    { 102, 191, 255, 255 }, { 135, 60, 190, 255 }, { 80, 80, 80, 255 }
+};
+
+void InitProfiler(Profiler* profiler) {
+    memset(profiler, 0, sizeof(Profiler));
+    profiler->stage = -1;
+    profiler->origin = GetTime();
+}
+
+// Oldest first, i in [0, count).
+const ProfileFrame* ProfileFrameAt(const Profiler* profiler, int i) {
+    int first = (profiler->head - profiler->count + PROFILE_HISTORY) % PROFILE_HISTORY;
+    return &profiler->frames[(first + i) % PROFILE_HISTORY];
+}
+
+void BeginProfileFrame(Profiler* profiler) {
+    ProfileFrame* frame = &profiler->frames[profiler->head];
+    memset(frame, 0, sizeof(ProfileFrame));
+    frame->start = GetTime();
+
+    profiler->current = frame;
+    profiler->stage = -1;
+}
+
+void CloseProfileStage(Profiler* profiler, double now) {
+    if (profiler->stage < 0) return;
+
+    ProfileFrame* frame = profiler->current;
+    float duration = (float)((now - profiler->stageStart) * 1000.0);
+    frame->stageMs[profiler->stage] += duration;
+    if (frame->spanCount < PROFILE_MAX_SPANS) {
+        frame->spans[frame->spanCount++] = (ProfileSpan){
+            (unsigned char)profiler->stage, (float)((profiler->stageStart - frame->start) * 1000.0), duration
+        };
+    }
+    profiler->stage = -1;
+}
+
+void BeginProfileStage(Profiler* profiler, ProfileStage stage) {
+    if (profiler->current == NULL) return;
+
+    double now = GetTime();
+    CloseProfileStage(profiler, now);
+    profiler->stage = stage;
+    profiler->stageStart = now;
+}
+
+int CompareFloats(const void* a, const void* b) {
+    float fa = *(const float*)a;
+    float fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Index PROFILE_STAGE_COUNT holds the whole frame.
+void UpdateProfileStats(Profiler* profiler) {
+    float samples[PROFILE_HISTORY];
+
+    for (int s = 0; s <= PROFILE_STAGE_COUNT; s++) {
+        float sum = 0.0f;
+        for (int i = 0; i < profiler->count; i++) {
+            const ProfileFrame* frame = ProfileFrameAt(profiler, i);
+            samples[i] = (s < PROFILE_STAGE_COUNT) ? frame->stageMs[s] : frame->frameMs;
+            sum += samples[i];
+        }
+        qsort(samples, profiler->count, sizeof(float), CompareFloats);
+
+        int p99 = (profiler->count * 99 + 99) / 100 - 1;
+        profiler->averageMs[s] = profiler->count ? sum / profiler->count : 0.0f;
+        profiler->p99Ms[s] = profiler->count ? samples[(p99 < 0) ? 0 : p99] : 0.0f;
+    }
+}
+
+void EndProfileFrame(Profiler* profiler) {
+    ProfileFrame* frame = profiler->current;
+    if (frame == NULL) return;
+
+    double now = GetTime();
+    CloseProfileStage(profiler, now);
+    frame->frameMs = (float)((now - frame->start) * 1000.0);
+
+    profiler->head = (profiler->head + 1) % PROFILE_HISTORY;
+    if (profiler->count < PROFILE_HISTORY) profiler->count++;
+    profiler->frameIndex++;
+    profiler->current = NULL;
+
+    if (++profiler->framesSinceStats >= PROFILE_STATS_INTERVAL) {
+        profiler->framesSinceStats = 0;
+        UpdateProfileStats(profiler);
+    }
+}
+
+// Stage table on top, then one stacked bar per frame with lines at 60 and
+// 30 FPS.
+void DrawProfilerOverlay(Profiler* profiler, int x, int y) {
+    int lineHeight = PROFILE_TEXT_SIZE + 2;
+    int width = PROFILE_GRAPH_FRAMES;
+    int tableHeight = (PROFILE_STAGE_COUNT + 2) * lineHeight;
+
+    DrawRectangle(x - 4, y - 4, width + 8, PROFILE_OVERLAY_HEIGHT + 8, Fade(BLACK, 0.6f));
+
+    DrawText(TextFormat("%-8s %7s %7s", "stage", "avg ms", "p99 ms"), x, y, PROFILE_TEXT_SIZE, WHITE);
+    for (int s = 0; s <= PROFILE_STAGE_COUNT; s++) {
+        int rowY = y + (s + 1) * lineHeight;
+        const char* name = (s < PROFILE_STAGE_COUNT) ? profileStageNames[s] : "frame";
+        if (s < PROFILE_STAGE_COUNT) DrawRectangle(x, rowY + 1, PROFILE_TEXT_SIZE - 2, PROFILE_TEXT_SIZE - 2, profileStageColors[s]);
+        DrawText(TextFormat("  %-8s %7.3f %7.3f", name, profiler->averageMs[s], profiler->p99Ms[s]), x, rowY, PROFILE_TEXT_SIZE, WHITE);
+    }
+
+    int graphBottom = y + tableHeight + PROFILE_GRAPH_HEIGHT;
+    float scale = PROFILE_GRAPH_HEIGHT / PROFILE_GRAPH_MAX_MS;
+    int shown = (profiler->count < PROFILE_GRAPH_FRAMES) ? profiler->count : PROFILE_GRAPH_FRAMES;
+
+    for (int i = 0; i < shown; i++) {
+        const ProfileFrame* frame = ProfileFrameAt(profiler, profiler->count - shown + i);
+        int barX = x + width - shown + i;
+        float stacked = 0.0f;
+        for (int s = 0; s < PROFILE_STAGE_COUNT && stacked < PROFILE_GRAPH_HEIGHT; s++) {
+            float top = stacked + frame->stageMs[s] * scale;
+            if (top > PROFILE_GRAPH_HEIGHT) top = PROFILE_GRAPH_HEIGHT;
+            DrawLine(barX, graphBottom - (int)stacked, barX, graphBottom - (int)top, profileStageColors[s]);
+            stacked = top;
+        }
+    }
+
+    DrawLine(x, graphBottom - (int)(16.7f * scale), x + width, graphBottom - (int)(16.7f * scale), Fade(WHITE, 0.5f));
+    DrawLine(x, graphBottom - (int)(33.3f * scale), x + width, graphBottom - (int)(33.3f * scale), Fade(RED, 0.5f));
+}
+
+bool WriteProfileCsv(const Profiler* profiler, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) return false;
+
+    fprintf(file, "frame,start_ms,frame_ms");
+    for (int s = 0; s < PROFILE_STAGE_COUNT; s++) fprintf(file, ",%s_ms", profileStageNames[s]);
+    fprintf(file, "\n");
+
+    long firstIndex = profiler->frameIndex - profiler->count;
+    for (int i = 0; i < profiler->count; i++) {
+        const ProfileFrame* frame = ProfileFrameAt(profiler, i);
+        fprintf(file, "%ld,%.3f,%.3f", firstIndex + i, (frame->start - profiler->origin) * 1000.0, frame->frameMs);
+        for (int s = 0; s < PROFILE_STAGE_COUNT; s++) fprintf(file, ",%.3f", frame->stageMs[s]);
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+
+// Chrome trace event format (chrome://tracing, Perfetto): one complete event
+// per frame with its stages nested inside, timestamps in microseconds.
+bool WriteProfileTrace(const Profiler* profiler, const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) return false;
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    long firstIndex = profiler->frameIndex - profiler->count;
+    for (int i = 0; i < profiler->count; i++) {
+        const ProfileFrame* frame = ProfileFrameAt(profiler, i);
+        double frameUs = (frame->start - profiler->origin) * 1e6;
+
+        fprintf(file, "%s{\"name\":\"frame %ld\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.1f,\"dur\":%.1f}",
+                first ? "" : ",\n", firstIndex + i, frameUs, frame->frameMs * 1000.0);
+        first = false;
+
+        for (int j = 0; j < frame->spanCount; j++) {
+            const ProfileSpan* span = &frame->spans[j];
+            fprintf(file, ",\n{\"name\":\"%s\",\"cat\":\"stage\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.1f,\"dur\":%.1f}",
+                    profileStageNames[span->stage], frameUs + span->startMs * 1000.0, span->durationMs * 1000.0);
+        }
+    }
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
@@ -0,0 +1,81 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "raylib.h"
+#include <stdbool.h>
+
+#define PROFILE_HISTORY 512
+#define PROFILE_STATS_INTERVAL 30
+#define PROFILE_MAX_SPANS 24
+#define PROFILE_GRAPH_FRAMES 240
+#define PROFILE_GRAPH_HEIGHT 80
+#define PROFILE_GRAPH_MAX_MS 33.3f
+#define PROFILE_TEXT_SIZE 10
+#define PROFILE_OVERLAY_HEIGHT ((PROFILE_STAGE_COUNT + 2) * (PROFILE_TEXT_SIZE + 2) + PROFILE_GRAPH_HEIGHT)
+
+typedef enum {
+    PROFILE_INPUT = 0,
+    PROFILE_SAVE,
+    PROFILE_STREAM,
+    PROFILE_PHYSICS,
+    PROFILE_ENTITY,
+    PROFILE_TICK,
+    PROFILE_RAYCAST,
+    PROFILE_EDIT,
+    PROFILE_LIGHT,
+    PROFILE_MESH,
+    PROFILE_CULL,
+    PROFILE_DRAW,
+    PROFILE_PRESENT,
+    PROFILE_STAGE_COUNT
+} ProfileStage;
+
+// Times are in ms, span starts relative to the start of the frame. A stage
+// entered more than once in a frame gets a span each time; stageMs sums them.
+typedef struct {
+    unsigned char stage;
+    float startMs;
+    float durationMs;
+} ProfileSpan;
+
+typedef struct {
+    double start;
+    float frameMs;
+    float stageMs[PROFILE_STAGE_COUNT];
+    ProfileSpan spans[PROFILE_MAX_SPANS];
+    int spanCount;
+} ProfileFrame;
+
+// The main loop is divided into consecutive stages: entering one closes the
+// one before it, so a stage skipped by an early jump simply records nothing.
+// The last PROFILE_HISTORY frames are kept in a ring buffer; averages and
+// p99 are refreshed every PROFILE_STATS_INTERVAL frames, not every frame.
+typedef struct {
+    ProfileFrame frames[PROFILE_HISTORY];
+    int head;
+    int count;
+    long frameIndex;
+    double origin;
+
+    ProfileFrame* current;
+    int stage;
+    double stageStart;
+
+    float averageMs[PROFILE_STAGE_COUNT + 1];
+    float p99Ms[PROFILE_STAGE_COUNT + 1];
+    int framesSinceStats;
+
+    bool visible;
+} Profiler;
+
+extern const char* profileStageNames[PROFILE_STAGE_COUNT];
+
+void InitProfiler(Profiler* profiler);
+void BeginProfileFrame(Profiler* profiler);
+void BeginProfileStage(Profiler* profiler, ProfileStage stage);
+void EndProfileFrame(Profiler* profiler);
+void DrawProfilerOverlay(Profiler* profiler, int x, int y);
+bool WriteProfileCsv(const Profiler* profiler, const char* path);
+bool WriteProfileTrace(const Profiler* profiler, const char* path);
+
+#endif
@@ -0,0 +1,77 @@
+#include "resolution.h"
+#include "rlgl.h"
+#include <math.h>
+
+void InitDynamicResolution(DynamicResolution* resolution, int targetFps, int width, int height) {
+    *resolution = (DynamicResolution){ 0 };
+    resolution->scale = 1.0f;
+    resolution->targetMs = 1000.0f / (float)targetFps;
+    ResizeDynamicResolution(resolution, width, height);
+}
+
+void ResizeDynamicResolution(DynamicResolution* resolution, int width, int height) {
+    if (width == resolution->width && height == resolution->height) return;
+    if (resolution->width > 0) UnloadRenderTexture(resolution->target);
+    resolution->target = LoadRenderTexture(width, height);
+    SetTextureFilter(resolution->target.texture, TEXTURE_FILTER_BILINEAR);
+    resolution->width = width;
+    resolution->height = height;
+}
+
+// Rendering is taken to cost in proportion to the pixel count and the rest
+// of the frame not at all, so the area left for rendering sets the scale.
+void UpdateDynamicResolution(DynamicResolution* resolution, float frameMs, float renderMs) {
+    if (resolution->frameMs <= 0.0f) {
+        resolution->frameMs = frameMs;
+        resolution->renderMs = renderMs;
+    }
+    resolution->frameMs += (frameMs - resolution->frameMs) * RESOLUTION_SMOOTHING;
+    resolution->renderMs += (renderMs - resolution->renderMs) * RESOLUTION_SMOOTHING;
+    if (++resolution->framesSinceUpdate < RESOLUTION_INTERVAL) return;
+    resolution->framesSinceUpdate = 0;
+
+    float targetMs = resolution->targetMs;
+    if (fabsf(resolution->frameMs - targetMs) <= targetMs * RESOLUTION_TOLERANCE) return;
+
+    float availableMs = targetMs - (resolution->frameMs - resolution->renderMs);
+    float ratio = (resolution->renderMs > 0.0f) ? fmaxf(availableMs, 0.0f) / resolution->renderMs : 4.0f;
+    float scale = resolution->scale * sqrtf(ratio);
+    scale = fminf(fmaxf(scale, resolution->scale - RESOLUTION_MAX_STEP), resolution->scale + RESOLUTION_MAX_STEP);
+    resolution->scale = fminf(fmaxf(scale, RESOLUTION_MIN_SCALE), 1.0f);
+}
+
+int ScaledSceneWidth(const DynamicResolution* resolution) {
+    int width = (int)(resolution->width * resolution->scale + 0.5f);
+    return (width < 1) ? 1 : width;
+}
+
+int ScaledSceneHeight(const DynamicResolution* resolution) {
+    int height = (int)(resolution->height * resolution->scale + 0.5f);
+    return (height < 1) ? 1 : height;
+}
+
+// BeginMode3D takes its aspect ratio from the whole texture, which matches
+// the scaled viewport.
+void BeginScaledScene(DynamicResolution* resolution) {
+    BeginTextureMode(resolution->target);
+    rlViewport(0, 0, ScaledSceneWidth(resolution), ScaledSceneHeight(resolution));
+}
+
+// Translucent blocks leave the texture's alpha below one, so it is copied
+// without blending. Render textures are stored bottom up, hence the
+// negative source height.
+void DrawScaledScene(DynamicResolution* resolution, int screenWidth, int screenHeight) {
+    EndTextureMode();
+    Rectangle source = { 0.0f, 0.0f, (float)ScaledSceneWidth(resolution), -(float)ScaledSceneHeight(resolution) };
+    Rectangle dest = { 0.0f, 0.0f, (float)screenWidth, (float)screenHeight };
+    rlDrawRenderBatchActive();
+    rlDisableColorBlend();
+    DrawTexturePro(resolution->target.texture, source, dest, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
+    rlDrawRenderBatchActive();
+    rlEnableColorBlend();
+}
+
+void UnloadDynamicResolution(DynamicResolution* resolution) {
+    if (resolution->width > 0) UnloadRenderTexture(resolution->target);
+    *resolution = (DynamicResolution){ 0 };
+}
@@ -0,0 +1,39 @@
+#ifndef RESOLUTION_H
+#define RESOLUTION_H
+
+#include "raylib.h"
+
+#define RESOLUTION_MIN_SCALE 0.5f
+#define RESOLUTION_MAX_STEP 0.1f
+#define RESOLUTION_INTERVAL 15
+#define RESOLUTION_SMOOTHING 0.1f
+#define RESOLUTION_TOLERANCE 0.05f
+
+// The 3D pass is drawn into the bottom left corner of a window-sized render
+// texture, scale times the window on each side, and stretched over the
+// window before the HUD is drawn at full resolution. The aspect ratio never
+// changes, so neither does the projection. Frame and render times are
+// smoothed, and the scale is revisited every RESOLUTION_INTERVAL frames,
+// only when the frame is off its target by more than RESOLUTION_TOLERANCE.
+typedef struct {
+    RenderTexture2D target;
+    int width;
+    int height;
+    float scale;
+    float targetMs;
+
+    float frameMs;
+    float renderMs;
+    int framesSinceUpdate;
+} DynamicResolution;
+
+void InitDynamicResolution(DynamicResolution* resolution, int targetFps, int width, int height);
+void ResizeDynamicResolution(DynamicResolution* resolution, int width, int height);
+void UpdateDynamicResolution(DynamicResolution* resolution, float frameMs, float renderMs);
+int ScaledSceneWidth(const DynamicResolution* resolution);
+int ScaledSceneHeight(const DynamicResolution* resolution);
+void BeginScaledScene(DynamicResolution* resolution);
+void DrawScaledScene(DynamicResolution* resolution, int screenWidth, int screenHeight);
+void UnloadDynamicResolution(DynamicResolution* resolution);
+
+#endif
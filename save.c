@@ -0,0 +1,560 @@
+#include "save.h"
+#include "stream.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+void PutU32(unsigned char* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+void PutU64(unsigned char* out, uint64_t value) {
+    for (int i = 0; i < 8; i++) out[i] = (unsigned char)(value >> (8 * i));
+}
+
+uint32_t GetU32(const unsigned char* in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) value |= (uint32_t)in[i] << (8 * i);
+    return value;
+}
+
+uint64_t GetU64(const unsigned char* in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) value |= (uint64_t)in[i] << (8 * i);
+    return value;
+}
+
+// Voxels are stored as runs over a per-chunk palette; a uniform chunk is
+// just its palette.
+size_t EncodeChunk(const unsigned char* voxels, unsigned char* out) {
+    int paletteIndex[256];
+    unsigned char palette[256];
+    int paletteCount = 0;
+
+    memset(paletteIndex, 0xFF, sizeof(paletteIndex));
+    for (int i = 0; i < CHUNK_VOLUME; i++) {
+        unsigned char type = voxels[i];
+        if (paletteIndex[type] < 0) {
+            paletteIndex[type] = paletteCount;
+            palette[paletteCount++] = type;
+        }
+    }
+
+    size_t size = 0;
+    out[size++] = (unsigned char)(paletteCount - 1);
+    memcpy(out + size, palette, paletteCount);
+    size += paletteCount;
+    if (paletteCount == 1) return size;
+
+    for (int i = 0; i < CHUNK_VOLUME;) {
+        unsigned char type = voxels[i];
+        int run = 1;
+        while (i + run < CHUNK_VOLUME && voxels[i + run] == type) run++;
+
+        out[size++] = (unsigned char)paletteIndex[type];
+        unsigned int length = (unsigned int)run - 1;
+        while (length >= 0x80) {
+            out[size++] = (unsigned char)((length & 0x7F) | 0x80);
+            length >>= 7;
+        }
+        out[size++] = (unsigned char)length;
+        i += run;
+    }
+    return size;
+}
+
+bool DecodeChunk(const unsigned char* data, size_t size, unsigned char* voxels) {
+    if (size < 1) return false;
+
+    int paletteCount = data[0] + 1;
+    if (size < 1 + (size_t)paletteCount) return false;
+
+    const unsigned char* palette = data + 1;
+    for (int i = 0; i < paletteCount; i++) {
+        if (palette[i] >= BLOCK_TYPE_COUNT) return false;
+    }
+
+    size_t pos = 1 + paletteCount;
+    if (paletteCount == 1) {
+        memset(voxels, palette[0], CHUNK_VOLUME);
+        return pos == size;
+    }
+
+    int filled = 0;
+    while (pos < size) {
+        int index = data[pos++];
+        if (index >= paletteCount) return false;
+
+        unsigned int length = 0;
+        int shift = 0;
+        for (;;) {
+            if (pos >= size || shift > 14) return false;
+            unsigned char byte = data[pos++];
+            length |= (unsigned int)(byte & 0x7F) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) break;
+        }
+
+        int run = (int)length + 1;
+        if (run > CHUNK_VOLUME - filled) return false;
+        memset(voxels + filled, palette[index], run);
+        filled += run;
+    }
+    return filled == CHUNK_VOLUME;
+}
+
+// The file is mapped read-only so opening a world costs one index parse;
+// blobs are only touched when their chunk is first accessed.
+bool MapSaveFile(WorldSave* save) {
+#ifdef _WIN32
+    FILE* file = fopen(save->path, "rb");
+    if (file == NULL) return false;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char* data = (size > 0) ? (unsigned char*)RL_MALLOC(size) : NULL;
+    bool ok = data != NULL && fread(data, 1, size, file) == (size_t)size;
+    fclose(file);
+    if (!ok) {
+        RL_FREE(data);
+        return false;
+    }
+    save->data = data;
+    save->dataSize = (size_t)size;
+#else
+    int fd = open(save->path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return false;
+
+    save->data = (const unsigned char*)data;
+    save->dataSize = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+void UnmapSaveFile(WorldSave* save) {
+    if (save->data == NULL) return;
+#ifdef _WIN32
+    RL_FREE((void*)save->data);
+#else
+    munmap((void*)save->data, save->dataSize);
+#endif
+    save->data = NULL;
+    save->dataSize = 0;
+}
+
+int FindSaveEntry(const WorldSave* save, int cx, int cy, int cz) {
+    if (save->tableCapacity == 0) return -1;
+
+    unsigned int mask = (unsigned int)save->tableCapacity - 1;
+    unsigned int slot = ChunkHash(cx, cy, cz) & mask;
+    while (save->table[slot] >= 0) {
+        const SaveEntry* entry = &save->entries[save->table[slot]];
+        if (entry->cx == cx && entry->cy == cy && entry->cz == cz) {
+            return save->table[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+void BuildSaveTable(WorldSave* save) {
+    int capacity = CHUNK_TABLE_INITIAL_CAPACITY;
+    while (capacity < save->entryCount * 2) capacity *= 2;
+
+    if (capacity != save->tableCapacity) {
+        RL_FREE(save->table);
+        save->table = (int*)RL_MALLOC(capacity * sizeof(int));
+        save->tableCapacity = capacity;
+    }
+    memset(save->table, 0xFF, capacity * sizeof(int));
+
+    unsigned int mask = (unsigned int)capacity - 1;
+    for (int i = 0; i < save->entryCount; i++) {
+        const SaveEntry* entry = &save->entries[i];
+        unsigned int slot = ChunkHash(entry->cx, entry->cy, entry->cz) & mask;
+        while (save->table[slot] >= 0) {
+            slot = (slot + 1) & mask;
+        }
+        save->table[slot] = i;
+    }
+}
+
+SaveEntry* PushSaveEntry(WorldSave* save) {
+    if (save->entryCount >= save->entryCapacity) {
+        save->entryCapacity = save->entryCapacity ? save->entryCapacity * 2 : CHUNK_TABLE_INITIAL_CAPACITY;
+        save->entries = (SaveEntry*)RL_REALLOC(save->entries, save->entryCapacity * sizeof(SaveEntry));
+    }
+    SaveEntry* entry = &save->entries[save->entryCount++];
+    memset(entry, 0, sizeof(SaveEntry));
+    return entry;
+}
+
+bool ReadSaveIndex(WorldSave* save) {
+    const unsigned char* data = save->data;
+    if (save->dataSize < SAVE_V1_HEADER_SIZE || memcmp(data, SAVE_MAGIC, 4) != 0) return false;
+
+    save->version = (int)GetU32(data + 4);
+    if (save->version < 1 || save->version > SAVE_VERSION || GetU32(data + 8) != CHUNK_SIZE) return false;
+    if (save->version >= 2) {
+        if (save->dataSize < SAVE_HEADER_SIZE) return false;
+        save->hasTerrain = (GetU32(data + 24) & SAVE_FLAG_TERRAIN) != 0;
+        save->terrainSeed = GetU32(data + 28);
+    }
+
+    uint64_t indexOffset = GetU64(data + 12);
+    uint32_t count = GetU32(data + 20);
+    if (indexOffset > save->dataSize || (save->dataSize - indexOffset) / SAVE_ENTRY_SIZE < count) return false;
+
+    save->entryCount = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const unsigned char* p = data + indexOffset + (size_t)i * SAVE_ENTRY_SIZE;
+        uint32_t blockCount = GetU32(p + 12);
+        uint64_t offset = GetU64(p + 16);
+        uint32_t size = GetU32(p + 24);
+        if (blockCount > CHUNK_VOLUME || offset > save->dataSize || size > save->dataSize - offset || size > SAVE_MAX_BLOB_SIZE) {
+            return false;
+        }
+
+        SaveEntry* entry = PushSaveEntry(save);
+        entry->cx = (int32_t)GetU32(p);
+        entry->cy = (int32_t)GetU32(p + 4);
+        entry->cz = (int32_t)GetU32(p + 8);
+        entry->blockCount = (int)blockCount;
+        entry->offset = (size_t)offset;
+        entry->size = size;
+    }
+
+    BuildSaveTable(save);
+    return true;
+}
+
+bool WriteSaveIndex(FILE* file, const WorldSave* save, size_t indexOffset) {
+    unsigned char p[SAVE_ENTRY_SIZE];
+    for (int i = 0; i < save->entryCount; i++) {
+        const SaveEntry* entry = &save->entries[i];
+        PutU32(p, (uint32_t)entry->cx);
+        PutU32(p + 4, (uint32_t)entry->cy);
+        PutU32(p + 8, (uint32_t)entry->cz);
+        PutU32(p + 12, (uint32_t)entry->blockCount);
+        PutU64(p + 16, entry->offset);
+        PutU32(p + 24, (uint32_t)entry->size);
+        if (fwrite(p, 1, SAVE_ENTRY_SIZE, file) != SAVE_ENTRY_SIZE) return false;
+    }
+
+    // The header goes last so a save interrupted before this point still
+    // points at the previous, complete index.
+    unsigned char header[SAVE_HEADER_SIZE];
+    memcpy(header, SAVE_MAGIC, 4);
+    PutU32(header + 4, SAVE_VERSION);
+    PutU32(header + 8, CHUNK_SIZE);
+    PutU64(header + 12, indexOffset);
+    PutU32(header + 20, (uint32_t)save->entryCount);
+    PutU32(header + 24, save->hasTerrain ? SAVE_FLAG_TERRAIN : 0);
+    PutU32(header + 28, save->terrainSeed);
+
+    return fflush(file) == 0 && fseek(file, 0, SEEK_SET) == 0 && fwrite(header, 1, SAVE_HEADER_SIZE, file) == SAVE_HEADER_SIZE;
+}
+
+char* CopyString(const char* text) {
+    size_t length = strlen(text) + 1;
+    char* copy = (char*)RL_MALLOC(length);
+    memcpy(copy, text, length);
+    return copy;
+}
+
+void FreeWorldSave(WorldSave* save) {
+    UnmapSaveFile(save);
+    RL_FREE(save->entries);
+    RL_FREE(save->table);
+    RL_FREE(save->path);
+    RL_FREE(save);
+}
+
+bool OpenWorldSave(World* world, const char* path) {
+    if (world->save != NULL) return false;
+
+    WorldSave* save = (WorldSave*)RL_CALLOC(1, sizeof(WorldSave));
+    save->path = CopyString(path);
+    if (!MapSaveFile(save) || !ReadSaveIndex(save)) {
+        FreeWorldSave(save);
+        return false;
+    }
+
+    // Chunks already in memory win over their saved copies, since GetChunk
+    // only falls back to the file for chunks it cannot find.
+    for (int i = 0; i < save->entryCount; i++) {
+        const SaveEntry* entry = &save->entries[i];
+        if (entry->size > 0) ExtendChunkBounds(world, entry->cx, entry->cy, entry->cz);
+    }
+
+    world->hasTerrain = save->hasTerrain;
+    world->terrainSeed = save->terrainSeed;
+    world->save = save;
+    return true;
+}
+
+void CloseWorldSave(World* world) {
+    if (world->save == NULL) return;
+    FreeWorldSave(world->save);
+    world->save = NULL;
+}
+
+// Can be called again for the same chunk once it has been evicted; the
+// mapped file stays valid until the next save is applied.
+Chunk* LoadSavedChunk(World* world, int cx, int cy, int cz) {
+    WorldSave* save = world->save;
+    int index = FindSaveEntry(save, cx, cy, cz);
+    if (index < 0 || save->entries[index].size == 0 || save->data == NULL) return NULL;
+
+    const SaveEntry* entry = &save->entries[index];
+    Chunk* chunk = CreateChunk(world, cx, cy, cz);
+    bool ok = DecodeChunk(save->data + entry->offset, entry->size, chunk->voxels->data);
+
+    int blockCount = 0;
+    if (ok) {
+        for (int i = 0; i < CHUNK_VOLUME; i++) {
+            if (chunk->voxels->data[i] != BLOCK_AIR) blockCount++;
+        }
+    }
+
+    // A blob that fails to decode is treated as dug out, so it is not
+    // decoded again on every access and the next save drops it.
+    chunk->blockCount = blockCount;
+    world->blockCount += blockCount;
+    if (blockCount == 0) {
+        InsertCoord(&world->emptied, cx, cy, cz, 0);
+        RemoveChunk(world, chunk);
+        return NULL;
+    }
+    MarkNeighborsDirty(world, cx, cy, cz);
+    return chunk;
+}
+
+bool SaveNeedsCompaction(const WorldSave* save) {
+    size_t live = SAVE_HEADER_SIZE + (size_t)save->entryCount * SAVE_ENTRY_SIZE;
+    for (int i = 0; i < save->entryCount; i++) {
+        live += save->entries[i].size;
+    }
+    return save->dataSize > SAVE_COMPACT_MIN_BYTES && save->dataSize - live > live;
+}
+
+// Whether a chunk that is in memory or in the eviction cache has to be
+// written: generated ones never are, unmodified ones only when the attached
+// save does not hold them yet.
+bool NeedsSaving(const WorldSave* save, int cx, int cy, int cz, bool modified, bool generated) {
+    if (generated) return false;
+    return modified || save == NULL || FindSaveEntry(save, cx, cy, cz) < 0;
+}
+
+// Runs on the main thread and only bumps reference counts or copies already
+// encoded blobs: in-memory chunks share their voxel buffers with the world
+// until it edits them. Chunks dug out since the last save are written as
+// empty entries. Saving to the open file keeps its index minus the entries
+// being replaced; any other save rewrites the whole file and copies the kept
+// blobs over from the old one.
+SaveSnapshot* TakeSaveSnapshot(World* world, const char* path) {
+    WorldSave* save = world->save;
+    ChunkCache* cache = world->cache;
+    SaveSnapshot* snapshot = (SaveSnapshot*)RL_CALLOC(1, sizeof(SaveSnapshot));
+    snapshot->next = (WorldSave*)RL_CALLOC(1, sizeof(WorldSave));
+    snapshot->next->path = CopyString(path);
+    snapshot->next->version = SAVE_VERSION;
+    snapshot->next->hasTerrain = world->hasTerrain;
+    snapshot->next->terrainSeed = world->terrainSeed;
+    snapshot->rewrite = save == NULL || save->version != SAVE_VERSION || strcmp(save->path, path) != 0 || SaveNeedsCompaction(save);
+
+    int capacity = world->chunkCount + world->emptied.count + (cache != NULL ? cache->count : 0) + 1;
+    snapshot->chunks = (SnapshotChunk*)RL_MALLOC(capacity * sizeof(SnapshotChunk));
+
+    for (int i = 0; i < world->chunkCount; i++) {
+        Chunk* chunk = world->chunks[i];
+        if (!NeedsSaving(save, chunk->cx, chunk->cy, chunk->cz, chunk->modified, chunk->generated)) continue;
+
+        snapshot->chunks[snapshot->chunkCount++] = (SnapshotChunk){
+            chunk->cx, chunk->cy, chunk->cz, chunk->blockCount, chunk->revision, RetainVoxelBuffer(chunk->voxels), NULL, 0
+        };
+    }
+
+    for (int i = 0; cache != NULL && i < cache->count; i++) {
+        const CachedChunk* cached = &cache->entries[i];
+        if (!NeedsSaving(save, cached->cx, cached->cy, cached->cz, cached->modified, cached->generated)) continue;
+
+        unsigned char* blob = (unsigned char*)RL_MALLOC(cached->size);
+        memcpy(blob, cached->blob, cached->size);
+        snapshot->chunks[snapshot->chunkCount++] = (SnapshotChunk){
+            cached->cx, cached->cy, cached->cz, cached->blockCount, cached->revision, NULL, blob, cached->size
+        };
+    }
+
+    for (int i = 0; i < world->emptied.capacity; i++) {
+        const CoordSlot* slot = &world->emptied.slots[i];
+        if (!slot->used) continue;
+        snapshot->chunks[snapshot->chunkCount++] = (SnapshotChunk){ slot->cx, slot->cy, slot->cz, 0, 0, NULL, NULL, 0 };
+    }
+
+    if (save != NULL) {
+        bool* replaced = (bool*)RL_CALLOC(save->entryCount + 1, sizeof(bool));
+        for (int i = 0; i < snapshot->chunkCount; i++) {
+            const SnapshotChunk* chunk = &snapshot->chunks[i];
+            int index = FindSaveEntry(save, chunk->cx, chunk->cy, chunk->cz);
+            if (index >= 0) replaced[index] = true;
+        }
+        for (int i = 0; i < save->entryCount; i++) {
+            if (!replaced[i]) *PushSaveEntry(snapshot->next) = save->entries[i];
+        }
+        RL_FREE(replaced);
+
+        if (snapshot->rewrite) snapshot->source = save->data;
+    }
+
+    world->modified = false;
+    return snapshot;
+}
+
+// Touches nothing but the snapshot and the file, so it can run on a worker
+// while the world keeps changing. Flat worlds have nothing to regenerate, so
+// a rewrite leaves their empty entries out.
+bool WriteSaveSnapshot(SaveSnapshot* snapshot) {
+    WorldSave* next = snapshot->next;
+    bool keepEmpty = next->hasTerrain || !snapshot->rewrite;
+    char* tempPath = NULL;
+    FILE* file;
+    long end = SAVE_HEADER_SIZE;
+    bool ok;
+
+    if (snapshot->rewrite) {
+        size_t pathLength = strlen(next->path);
+        tempPath = (char*)RL_MALLOC(pathLength + 5);
+        memcpy(tempPath, next->path, pathLength);
+        memcpy(tempPath + pathLength, ".tmp", 5);
+
+        file = fopen(tempPath, "wb");
+        unsigned char header[SAVE_HEADER_SIZE] = { 0 };
+        ok = file != NULL && fwrite(header, 1, SAVE_HEADER_SIZE, file) == SAVE_HEADER_SIZE;
+
+        int kept = 0;
+        for (int i = 0; ok && i < next->entryCount; i++) {
+            SaveEntry entry = next->entries[i];
+            if (entry.size == 0 && !keepEmpty) continue;
+
+            ok = entry.size == 0 || fwrite(snapshot->source + entry.offset, 1, entry.size, file) == entry.size;
+            entry.offset = (size_t)end;
+            end += (long)entry.size;
+            next->entries[kept++] = entry;
+        }
+        next->entryCount = kept;
+    } else {
+        file = fopen(next->path, "r+b");
+        ok = file != NULL && fseek(file, 0, SEEK_END) == 0;
+        end = ok ? ftell(file) : -1;
+        ok = ok && end >= SAVE_HEADER_SIZE;
+    }
+
+    unsigned char* scratch = (unsigned char*)RL_MALLOC(SAVE_MAX_BLOB_SIZE);
+    for (int i = 0; ok && i < snapshot->chunkCount; i++) {
+        const SnapshotChunk* chunk = &snapshot->chunks[i];
+        const unsigned char* blob = chunk->blob;
+        size_t size = chunk->blobSize;
+        if (chunk->voxels != NULL) {
+            size = EncodeChunk(chunk->voxels->data, scratch);
+            blob = scratch;
+        } else if (blob == NULL && !keepEmpty) {
+            continue;
+        }
+        ok = size == 0 || fwrite(blob, 1, size, file) == size;
+
+        *PushSaveEntry(next) = (SaveEntry){ chunk->cx, chunk->cy, chunk->cz, chunk->blockCount, (size_t)end, size };
+        end += (long)size;
+    }
+    RL_FREE(scratch);
+
+    ok = ok && WriteSaveIndex(file, next, (size_t)end);
+    if (file != NULL) ok = (fclose(file) == 0) && ok;
+
+    if (tempPath != NULL) {
+#ifdef _WIN32
+        if (ok) remove(next->path);
+#endif
+        ok = ok && rename(tempPath, next->path) == 0;
+        if (!ok) remove(tempPath);
+        RL_FREE(tempPath);
+    }
+
+    snapshot->ok = ok;
+    return ok;
+}
+
+void FreeSaveSnapshot(SaveSnapshot* snapshot) {
+    for (int i = 0; i < snapshot->chunkCount; i++) {
+        if (snapshot->chunks[i].voxels != NULL) ReleaseVoxelBuffer(snapshot->chunks[i].voxels);
+        RL_FREE(snapshot->chunks[i].blob);
+    }
+    RL_FREE(snapshot->chunks);
+    if (snapshot->next != NULL) FreeWorldSave(snapshot->next);
+    RL_FREE(snapshot);
+}
+
+// Back on the main thread: swap the written file in as the attached save and
+// mark everything written as saved, unless it was edited again meanwhile. A
+// failed save changes nothing, so the next one writes the same chunks again.
+bool ApplySaveSnapshot(World* world, SaveSnapshot* snapshot) {
+    WorldSave* next = snapshot->next;
+    bool ok = snapshot->ok;
+
+    if (ok) {
+        BuildSaveTable(next);
+        ok = MapSaveFile(next);
+    }
+
+    if (!ok) {
+        world->modified = true;
+        FreeSaveSnapshot(snapshot);
+        return false;
+    }
+
+    for (int i = 0; i < snapshot->chunkCount; i++) {
+        const SnapshotChunk* saved = &snapshot->chunks[i];
+        if (saved->voxels == NULL && saved->blob == NULL) {
+            RemoveCoord(&world->emptied, saved->cx, saved->cy, saved->cz);
+            continue;
+        }
+
+        Chunk* chunk = FindChunk(world, saved->cx, saved->cy, saved->cz);
+        CachedChunk* cached = (world->cache != NULL) ? FindCachedChunk(world->cache, saved->cx, saved->cy, saved->cz) : NULL;
+        if (chunk != NULL && chunk->revision == saved->revision) chunk->modified = false;
+        if (cached != NULL && cached->revision == saved->revision) cached->modified = false;
+    }
+
+    if (world->save != NULL) FreeWorldSave(world->save);
+    world->save = next;
+    snapshot->next = NULL;
+
+    FreeSaveSnapshot(snapshot);
+    return true;
+}
+
+bool SaveWorld(World* world, const char* path) {
+    SaveSnapshot* snapshot = TakeSaveSnapshot(world, path);
+    WriteSaveSnapshot(snapshot);
+    return ApplySaveSnapshot(world, snapshot);
+}
@@ -0,0 +1,90 @@
+#ifndef SAVE_H
+#define SAVE_H
+
+#include "world.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// File layout (little-endian):
+//   header  "BOXW", version, chunk size, index offset, index entry count,
+//           flags, terrain seed
+//   blobs   one per chunk: palette size - 1, palette, then runs of
+//           (palette index, varint run length - 1) in ChunkVoxelIndex order
+//   index   cx, cy, cz, block count, blob offset, blob size per chunk
+// A blob size of zero records a chunk that was dug out, so terrain is not
+// generated there again. Chunks the generator produced and nobody edited are
+// not stored at all. Version 1 files have no flags or seed and open as flat
+// worlds. Incremental saves append the modified blobs and a fresh index, then
+// point the header at it; the old index and replaced blobs become garbage
+// until the next full rewrite.
+#define SAVE_MAGIC "BOXW"
+#define SAVE_VERSION 2
+#define SAVE_HEADER_SIZE 32
+#define SAVE_V1_HEADER_SIZE 24
+#define SAVE_FLAG_TERRAIN 1
+#define SAVE_ENTRY_SIZE 28
+#define SAVE_MAX_BLOB_SIZE (1 + 256 + CHUNK_VOLUME * 3)
+#define SAVE_COMPACT_MIN_BYTES (64 * 1024)
+
+typedef struct {
+    int cx, cy, cz;
+    int blockCount;
+    size_t offset;
+    size_t size;
+} SaveEntry;
+
+typedef struct WorldSave {
+    char* path;
+    const unsigned char* data;
+    size_t dataSize;
+
+    int version;
+    bool hasTerrain;
+    unsigned int terrainSeed;
+
+    SaveEntry* entries;
+    int entryCount;
+    int entryCapacity;
+
+    int* table;
+    int tableCapacity;
+} WorldSave;
+
+// Holds either a shared voxel buffer, a copy of an evicted chunk's encoded
+// blob, or neither for a chunk that was dug out. revision tells the main
+// thread afterwards whether the chunk changed again while being written.
+typedef struct {
+    int cx, cy, cz;
+    int blockCount;
+    unsigned int revision;
+    VoxelBuffer* voxels;
+    unsigned char* blob;
+    size_t blobSize;
+} SnapshotChunk;
+
+// next holds the path and index of the file being written; source is the
+// old file's data, which a rewrite copies unchanged chunks from.
+typedef struct {
+    WorldSave* next;
+    bool rewrite;
+    SnapshotChunk* chunks;
+    int chunkCount;
+    const unsigned char* source;
+    bool ok;
+} SaveSnapshot;
+
+void PutU32(unsigned char* out, uint32_t value);
+uint32_t GetU32(const unsigned char* in);
+size_t EncodeChunk(const unsigned char* voxels, unsigned char* out);
+bool DecodeChunk(const unsigned char* data, size_t size, unsigned char* voxels);
+
+int FindSaveEntry(const WorldSave* save, int cx, int cy, int cz);
+bool OpenWorldSave(World* world, const char* path);
+bool SaveWorld(World* world, const char* path);
+SaveSnapshot* TakeSaveSnapshot(World* world, const char* path);
+bool WriteSaveSnapshot(SaveSnapshot* snapshot);
+bool ApplySaveSnapshot(World* world, SaveSnapshot* snapshot);
+void CloseWorldSave(World* world);
+Chunk* LoadSavedChunk(World* world, int cx, int cy, int cz);
+
+#endif
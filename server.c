@@ -0,0 +1,392 @@
+#include "server.h"
+#include "save.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+double ServerTime(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void SleepServer(double seconds) {
+    if (seconds <= 0.0) return;
+    struct timespec ts = { (time_t)seconds, (long)((seconds - (double)(time_t)seconds) * 1e9) };
+    nanosleep(&ts, NULL);
+}
+
+bool StartServer(Server* server, ServerSettings settings) {
+    *server = (Server){ 0 };
+    server->settings = settings;
+    server->listenFd = NetListen(settings.socketPath);
+    if (server->listenFd < 0) return false;
+
+    if (settings.savePath == NULL || !OpenWorldSave(&server->world, settings.savePath)) {
+        server->world.hasTerrain = !settings.flat;
+        server->world.terrainSeed = settings.seed;
+    }
+    if (server->world.hasTerrain) {
+        StartTerrainGenerator(&server->terrain, (TerrainSettings){ server->world.terrainSeed }, settings.threads);
+    }
+    InitChunkCache(&server->cache, CHUNK_CACHE_DEFAULT_BUDGET);
+    server->cache.hasSave = settings.savePath != NULL;
+    server->world.cache = &server->cache;
+    InitChunkStreamer(&server->streamer, SERVER_MAX_VIEW_RADIUS);
+
+    server->clients = (ServerClient*)RL_CALLOC(SERVER_MAX_CLIENTS, sizeof(ServerClient));
+    server->nextClientId = 1;
+    return true;
+}
+
+void PushBlockChange(Server* server, int x, int y, int z, BlockType type) {
+    if (server->changeCount >= server->changeCapacity) {
+        server->changeCapacity = server->changeCapacity ? server->changeCapacity * 2 : 1024;
+        server->changes = (BlockChange*)RL_REALLOC(server->changes, server->changeCapacity * sizeof(BlockChange));
+    }
+    server->changes[server->changeCount] = (BlockChange){
+        x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT,
+        (unsigned short)ChunkVoxelIndex(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK),
+        (unsigned char)type, (unsigned int)server->changeCount
+    };
+    server->changeCount++;
+}
+
+bool ClientHasColumn(const ServerClient* client, int cx, int cz) {
+    return FindCoord(&client->columns, cx, 0, cz) != NULL;
+}
+
+// Edits outside the client's columns, or at cells no int can hold, are
+// ignored. Invalid ones inside them are refused by sending the cell's real
+// value back, which undoes the client's prediction.
+void ApplyClientEdits(Server* server, ServerClient* client, NetReader* reader) {
+    World* world = &server->world;
+    int count = (int)GetNetVarint(reader);
+    int64_t cellX = 0, cellY = 0, cellZ = 0;
+
+    for (int i = 0; i < count && reader->ok; i++) {
+        cellX += GetNetInt(reader);
+        cellY += GetNetInt(reader);
+        cellZ += GetNetInt(reader);
+        unsigned int type = GetNetU8(reader);
+        if (!reader->ok) break;
+        if (cellX < INT_MIN || cellX > INT_MAX || cellY < INT_MIN || cellY > INT_MAX || cellZ < INT_MIN || cellZ > INT_MAX) continue;
+        int x = (int)cellX, y = (int)cellY, z = (int)cellZ;
+
+        bool held = ClientHasColumn(client, x >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+        if (!held) continue;
+
+        client->editsThisTick++;
+        BlockType current = GetBlock(world, x, y, z);
+        if (y < 0 || y >> CHUNK_SHIFT > WORLD_MAX_CHUNK_Y || type >= BLOCK_TYPE_COUNT) {
+            if (y >= 0) PushBlockChange(server, x, y, z, current);
+            continue;
+        }
+        if (current == (BlockType)type) continue;
+
+        SetBlock(world, x, y, z, (BlockType)type);
+        PushBlockChange(server, x, y, z, (BlockType)type);
+    }
+}
+
+// A client past its edit allowance keeps the rest of its messages queued
+// until the next tick, so a huge paste is spread out instead of stalling
+// everyone else.
+void HandleClientMessages(Server* server, ServerClient* client) {
+    NetMessageType type;
+    NetReader reader;
+    while (client->editsThisTick < SERVER_MAX_EDITS_PER_TICK && NextNetMessage(&client->connection, &type, &reader)) {
+        if (type == NET_HELLO && !client->joined) {
+            int radius = (int)GetNetVarint(&reader);
+            client->viewRadius = (radius < 1) ? 1 : (radius > SERVER_MAX_VIEW_RADIUS) ? SERVER_MAX_VIEW_RADIUS : radius;
+            client->joined = true;
+            NetBuffer* out = BeginNetMessage(&client->connection, NET_WELCOME);
+            PutNetVarint(out, (uint64_t)client->id);
+            EndNetMessage(&client->connection);
+        } else if (type == NET_POSITION && client->joined) {
+            int x = GetNetInt(&reader);
+            GetNetInt(&reader);
+            int z = GetNetInt(&reader);
+            if (!reader.ok) continue;
+            client->centerX = x >> CHUNK_SHIFT;
+            client->centerZ = z >> CHUNK_SHIFT;
+            client->hasPosition = true;
+        } else if (type == NET_EDITS && client->joined) {
+            ApplyClientEdits(server, client, &reader);
+        }
+    }
+}
+
+// The column header says how many chunk messages follow, so the client
+// knows when the column is complete.
+void SendColumn(Server* server, ServerClient* client, int cx, int cz) {
+    static unsigned char blob[SAVE_MAX_BLOB_SIZE];
+    World* world = &server->world;
+
+    int count = 0;
+    for (int cy = world->minChunkY; world->hasBounds && cy <= world->maxChunkY; cy++) {
+        if (FindChunk(world, cx, cy, cz) != NULL) count++;
+    }
+    NetBuffer* out = BeginNetMessage(&client->connection, NET_COLUMN);
+    PutNetSigned(out, cx);
+    PutNetSigned(out, cz);
+    PutNetVarint(out, (uint64_t)count);
+    EndNetMessage(&client->connection);
+
+    for (int cy = world->minChunkY; world->hasBounds && cy <= world->maxChunkY; cy++) {
+        Chunk* chunk = FindChunk(world, cx, cy, cz);
+        if (chunk == NULL) continue;
+
+        size_t size = EncodeChunk(chunk->voxels->data, blob);
+        out = BeginNetMessage(&client->connection, NET_CHUNK);
+        PutNetSigned(out, cx);
+        PutNetSigned(out, cy);
+        PutNetSigned(out, cz);
+        PutNetVarint(out, (uint64_t)chunk->blockCount);
+        PutNetBytes(out, blob, size);
+        EndNetMessage(&client->connection);
+    }
+    InsertCoord(&client->columns, cx, 0, cz, 0);
+}
+
+// Drops columns the client has left behind, then sends the nearest ready
+// ones it lacks and asks for the rest to be loaded or generated.
+void UpdateClientColumns(Server* server, ServerClient* client) {
+    int keep = client->viewRadius + STREAM_HYSTERESIS;
+    CoordMap* columns = &client->columns;
+    for (int slot = 0; slot < columns->capacity; slot++) {
+        CoordSlot column = columns->slots[slot];
+        if (!column.used || ColumnDistance(column.cx, column.cz, client->centerX, client->centerZ) <= keep) continue;
+
+        NetBuffer* out = BeginNetMessage(&client->connection, NET_DROP_COLUMN);
+        PutNetSigned(out, column.cx);
+        PutNetSigned(out, column.cz);
+        EndNetMessage(&client->connection);
+
+        // Backward shifting can move a later entry into this slot; look again.
+        RemoveCoord(columns, column.cx, 0, column.cz);
+        slot--;
+    }
+
+    int sendBudget = SERVER_COLUMN_BUDGET;
+    int requestBudget = STREAM_COLUMN_BUDGET;
+    for (int ring = 0; ring <= client->viewRadius && sendBudget > 0; ring++) {
+        for (int dz = -ring; dz <= ring && sendBudget > 0; dz++) {
+            for (int dx = -ring; dx <= ring && sendBudget > 0; dx++) {
+                if (abs(dx) != ring && abs(dz) != ring) continue;
+                int cx = client->centerX + dx;
+                int cz = client->centerZ + dz;
+                if (ClientHasColumn(client, cx, cz)) continue;
+
+                int* pending = FindCoord(&server->streamer.columns, cx, 0, cz);
+                if (pending == NULL) {
+                    if (requestBudget-- <= 0) continue;
+                    RequestColumn(&server->streamer, &server->world, &server->terrain, cx, cz);
+                    pending = FindCoord(&server->streamer.columns, cx, 0, cz);
+                }
+                if (*pending > 0) continue;
+
+                SendColumn(server, client, cx, cz);
+                sendBudget--;
+            }
+        }
+    }
+}
+
+bool IsColumnWanted(const Server* server, int cx, int cz) {
+    for (int i = 0; i < server->clientCount; i++) {
+        const ServerClient* client = &server->clients[i];
+        if (!client->hasPosition) continue;
+        if (ColumnDistance(cx, cz, client->centerX, client->centerZ) <= client->viewRadius + STREAM_HYSTERESIS) return true;
+    }
+    return false;
+}
+
+// Columns no client is near are forgotten and their chunks evicted, the
+// same way the single-player streamer does it.
+void EvictUnwantedColumns(Server* server) {
+    CoordMap* columns = &server->streamer.columns;
+    for (int slot = 0; slot < columns->capacity; slot++) {
+        CoordSlot column = columns->slots[slot];
+        if (!column.used || IsColumnWanted(server, column.cx, column.cz)) continue;
+
+        server->streamer.pending -= column.value;
+        RemoveCoord(columns, column.cx, 0, column.cz);
+        slot--;
+    }
+
+    World* world = &server->world;
+    for (int i = world->chunkCount - 1; i >= 0; i--) {
+        Chunk* chunk = world->chunks[i];
+        if (FindCoord(columns, chunk->cx, 0, chunk->cz) == NULL) EvictChunk(world, chunk);
+    }
+    TrimChunkCache(&server->cache);
+}
+
+int CompareBlockChanges(const void* a, const void* b) {
+    const BlockChange* ca = (const BlockChange*)a;
+    const BlockChange* cb = (const BlockChange*)b;
+    if (ca->cx != cb->cx) return (ca->cx > cb->cx) - (ca->cx < cb->cx);
+    if (ca->cz != cb->cz) return (ca->cz > cb->cz) - (ca->cz < cb->cz);
+    if (ca->cy != cb->cy) return (ca->cy > cb->cy) - (ca->cy < cb->cy);
+    if (ca->index != cb->index) return (ca->index > cb->index) - (ca->index < cb->index);
+    return (ca->order > cb->order) - (ca->order < cb->order);
+}
+
+// Sorts the tick's changes by chunk and cell and keeps the last write to each
+// cell, so every chunk is one contiguous batch.
+void CoalesceBlockChanges(Server* server) {
+    if (server->changeCount == 0) return;
+    qsort(server->changes, server->changeCount, sizeof(BlockChange), CompareBlockChanges);
+
+    int kept = 0;
+    for (int i = 0; i < server->changeCount; i++) {
+        const BlockChange* change = &server->changes[i];
+        if (i + 1 < server->changeCount) {
+            const BlockChange* next = &server->changes[i + 1];
+            if (next->cx == change->cx && next->cy == change->cy && next->cz == change->cz && next->index == change->index) continue;
+        }
+        server->changes[kept++] = *change;
+    }
+    server->changeCount = kept;
+}
+
+// Chunk coordinates are sent as deltas from the previous batch and voxel
+// indices as gaps from the previous change, which keeps a dense edit near a
+// byte and a half per cell.
+void SendBlockChanges(Server* server, ServerClient* client) {
+    NetBuffer* scratch = &server->scratch;
+    scratch->size = 0;
+    int batchCount = 0;
+    int lastX = 0, lastY = 0, lastZ = 0;
+
+    for (int start = 0; start < server->changeCount;) {
+        const BlockChange* first = &server->changes[start];
+        int end = start + 1;
+        while (end < server->changeCount && server->changes[end].cx == first->cx &&
+               server->changes[end].cy == first->cy && server->changes[end].cz == first->cz) {
+            end++;
+        }
+
+        if (ClientHasColumn(client, first->cx, first->cz)) {
+            PutNetSigned(scratch, first->cx - lastX);
+            PutNetSigned(scratch, first->cy - lastY);
+            PutNetSigned(scratch, first->cz - lastZ);
+            PutNetVarint(scratch, (uint64_t)(end - start));
+            int lastIndex = -1;
+            for (int i = start; i < end; i++) {
+                PutNetVarint(scratch, (uint64_t)(server->changes[i].index - lastIndex - 1));
+                PutNetU8(scratch, server->changes[i].type);
+                lastIndex = server->changes[i].index;
+            }
+            lastX = first->cx;
+            lastY = first->cy;
+            lastZ = first->cz;
+            batchCount++;
+        }
+        start = end;
+    }
+    if (batchCount == 0) return;
+
+    NetBuffer* out = BeginNetMessage(&client->connection, NET_CHANGES);
+    PutNetVarint(out, server->tick);
+    PutNetVarint(out, (uint64_t)batchCount);
+    PutNetBytes(out, scratch->data, scratch->size);
+    EndNetMessage(&client->connection);
+}
+
+void RemoveServerClient(Server* server, int i) {
+    ServerClient* client = &server->clients[i];
+    CloseNetConnection(&client->connection);
+    FreeCoordMap(&client->columns);
+    *client = server->clients[--server->clientCount];
+}
+
+void ServerTick(Server* server, float deltaTime) {
+    double start = ServerTime();
+    World* world = &server->world;
+
+    NetConnection connection;
+    while (server->clientCount < SERVER_MAX_CLIENTS && NetAccept(server->listenFd, &connection)) {
+        ServerClient* client = &server->clients[server->clientCount++];
+        *client = (ServerClient){ 0 };
+        client->connection = connection;
+        client->id = server->nextClientId++;
+    }
+
+    // Edits are applied in arrival order; the change list remembers them
+    // for the broadcast at the end of the tick.
+    server->changeCount = 0;
+    for (int i = 0; i < server->clientCount; i++) {
+        ServerClient* client = &server->clients[i];
+        client->editsThisTick = 0;
+        ReceiveNetData(&client->connection);
+        HandleClientMessages(server, client);
+    }
+
+    if (server->terrain.running) ReceiveTerrainChunks(&server->streamer, world, &server->terrain);
+    for (int i = 0; i < server->clientCount; i++) {
+        if (server->clients[i].hasPosition) UpdateClientColumns(server, &server->clients[i]);
+    }
+    EvictUnwantedColumns(server);
+
+    CoalesceBlockChanges(server);
+    for (int i = server->clientCount - 1; i >= 0; i--) {
+        ServerClient* client = &server->clients[i];
+        if (server->changeCount > 0) SendBlockChanges(server, client);
+        if (!FlushNetConnection(&client->connection)) RemoveServerClient(server, i);
+    }
+
+    server->autosaveTimer += deltaTime;
+    if (server->settings.savePath != NULL) {
+        if ((server->autosaveTimer >= SERVER_AUTOSAVE_INTERVAL && world->modified) || server->cache.needsFlush) {
+            if (StartAutosave(&server->autosave, world, server->settings.savePath)) server->autosaveTimer = 0.0f;
+        }
+        PollAutosave(&server->autosave, world);
+    }
+
+    server->tick++;
+    server->tickMs[server->tickCount++ % SERVER_TICK_HISTORY] = (float)((ServerTime() - start) * 1000.0);
+}
+
+int CompareTickMs(const void* a, const void* b) {
+    float x = *(const float*)a, y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+// Over the last SERVER_TICK_HISTORY ticks.
+ServerTickStats GetServerTickStats(const Server* server) {
+    ServerTickStats stats = { 0 };
+    stats.ticks = server->tickCount < SERVER_TICK_HISTORY ? server->tickCount : SERVER_TICK_HISTORY;
+    if (stats.ticks == 0) return stats;
+
+    float sorted[SERVER_TICK_HISTORY];
+    memcpy(sorted, server->tickMs, stats.ticks * sizeof(float));
+    qsort(sorted, stats.ticks, sizeof(float), CompareTickMs);
+    stats.p50 = sorted[(stats.ticks - 1) / 2];
+    stats.p99 = sorted[(stats.ticks - 1) * 99 / 100];
+    stats.max = sorted[stats.ticks - 1];
+    return stats;
+}
+
+void StopServer(Server* server) {
+    for (int i = server->clientCount - 1; i >= 0; i--) {
+        RemoveServerClient(server, i);
+    }
+    NetUnlisten(server->listenFd, server->settings.socketPath);
+
+    StopTerrainGenerator(&server->terrain);
+    if (server->settings.savePath != NULL) {
+        FinishAutosave(&server->autosave, &server->world);
+        SaveWorld(&server->world, server->settings.savePath);
+    }
+    FreeChunkStreamer(&server->streamer);
+    FreeWorld(&server->world);
+    FreeChunkCache(&server->cache);
+
+    RL_FREE(server->clients);
+    RL_FREE(server->changes);
+    FreeNetBuffer(&server->scratch);
+    *server = (Server){ 0 };
+}
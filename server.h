@@ -0,0 +1,88 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "world.h"
+#include "terrain.h"
+#include "stream.h"
+#include "autosave.h"
+#include "net.h"
+
+#define SERVER_TICK_RATE 30
+#define SERVER_MAX_CLIENTS 64
+#define SERVER_MAX_VIEW_RADIUS 16
+#define SERVER_COLUMN_BUDGET 4
+#define SERVER_MAX_EDITS_PER_TICK 65536
+#define SERVER_AUTOSAVE_INTERVAL 30.0f
+#define SERVER_TICK_HISTORY 1024
+
+typedef struct {
+    const char* socketPath;
+    const char* savePath;
+    bool flat;
+    unsigned int seed;
+    int threads;
+} ServerSettings;
+
+// columns holds the columns this client has been sent; edits are accepted
+// only inside them, and changes are only forwarded for them.
+typedef struct {
+    NetConnection connection;
+    int id;
+    bool joined;
+    int viewRadius;
+    bool hasPosition;
+    int centerX, centerZ;
+    CoordMap columns;
+    int editsThisTick;
+} ServerClient;
+
+// One accepted change, keyed for sorting into per-chunk batches; order
+// breaks ties so the last write to a cell wins.
+typedef struct {
+    int cx, cy, cz;
+    unsigned short index;
+    unsigned char type;
+    unsigned int order;
+} BlockChange;
+
+// The server owns the world: clients only send edit intents, and every
+// change it accepts is forwarded once per tick to each client holding the
+// chunk. The streamer is used as the registry of loaded columns and their
+// pending terrain, kept loaded while any client is near.
+typedef struct {
+    ServerSettings settings;
+    World world;
+    ChunkCache cache;
+    TerrainGenerator terrain;
+    ChunkStreamer streamer;
+    Autosave autosave;
+    float autosaveTimer;
+
+    int listenFd;
+    ServerClient* clients;
+    int clientCount;
+    int nextClientId;
+
+    BlockChange* changes;
+    int changeCount;
+    int changeCapacity;
+    NetBuffer scratch;
+    unsigned int tick;
+
+    float tickMs[SERVER_TICK_HISTORY];
+    int tickCount;
+} Server;
+
+typedef struct {
+    float p50, p99, max;
+    int ticks;
+} ServerTickStats;
+
+double ServerTime(void);
+void SleepServer(double seconds);
+bool StartServer(Server* server, ServerSettings settings);
+void ServerTick(Server* server, float deltaTime);
+ServerTickStats GetServerTickStats(const Server* server);
+void StopServer(Server* server);
+
+#endif
@@ -0,0 +1,281 @@
+#include "stream.h"
+#include "save.h"
+#include "raymath.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+void InitChunkCache(ChunkCache* cache, size_t budget) {
+    *cache = (ChunkCache){ 0 };
+    cache->budget = budget;
+}
+
+CachedChunk* FindCachedChunk(ChunkCache* cache, int cx, int cy, int cz) {
+    int* index = FindCoord(&cache->index, cx, cy, cz);
+    return (index != NULL) ? &cache->entries[*index] : NULL;
+}
+
+// Swap-remove, patching the index of the entry moved into the hole.
+void RemoveCachedEntry(ChunkCache* cache, int i) {
+    CachedChunk* entry = &cache->entries[i];
+    RL_FREE(entry->blob);
+    cache->bytes -= entry->size;
+    RemoveCoord(&cache->index, entry->cx, entry->cy, entry->cz);
+
+    if (i != --cache->count) {
+        *entry = cache->entries[cache->count];
+        *FindCoord(&cache->index, entry->cx, entry->cy, entry->cz) = i;
+    }
+}
+
+// Encodes the chunk and removes it from the world. Runs on the main thread
+// only, so one scratch buffer serves every call.
+void CacheChunk(World* world, Chunk* chunk, bool modified) {
+    static unsigned char scratch[SAVE_MAX_BLOB_SIZE];
+    ChunkCache* cache = world->cache;
+
+    size_t size = EncodeChunk(chunk->voxels->data, scratch);
+    unsigned char* blob = (unsigned char*)RL_MALLOC(size);
+    memcpy(blob, scratch, size);
+
+    CachedChunk* existing = FindCachedChunk(cache, chunk->cx, chunk->cy, chunk->cz);
+    if (existing != NULL) RemoveCachedEntry(cache, (int)(existing - cache->entries));
+
+    if (cache->count >= cache->capacity) {
+        cache->capacity = cache->capacity ? cache->capacity * 2 : CHUNK_TABLE_INITIAL_CAPACITY;
+        cache->entries = (CachedChunk*)RL_REALLOC(cache->entries, cache->capacity * sizeof(CachedChunk));
+    }
+    InsertCoord(&cache->index, chunk->cx, chunk->cy, chunk->cz, cache->count);
+    cache->entries[cache->count++] = (CachedChunk){
+        chunk->cx, chunk->cy, chunk->cz, chunk->blockCount, blob, size,
+        modified, chunk->generated, chunk->revision, cache->clock++
+    };
+    cache->bytes += size;
+
+    RemoveChunk(world, chunk);
+}
+
+Chunk* RestoreCachedChunk(World* world, int cx, int cy, int cz) {
+    ChunkCache* cache = world->cache;
+    int* index = FindCoord(&cache->index, cx, cy, cz);
+    if (index == NULL) return NULL;
+
+    int i = *index;
+    CachedChunk* entry = &cache->entries[i];
+    Chunk* chunk = CreateChunk(world, cx, cy, cz);
+    DecodeChunk(entry->blob, entry->size, chunk->voxels->data);
+    chunk->blockCount = entry->blockCount;
+    chunk->modified = entry->modified;
+    chunk->generated = entry->generated;
+    chunk->revision = entry->revision;
+    world->blockCount += entry->blockCount;
+
+    RemoveCachedEntry(cache, i);
+    MarkNeighborsDirty(world, cx, cy, cz);
+    return chunk;
+}
+
+typedef struct {
+    unsigned int lastUse;
+    int cx, cy, cz;
+} CacheVictim;
+
+int CompareCacheVictims(const void* a, const void* b) {
+    unsigned int ua = ((const CacheVictim*)a)->lastUse;
+    unsigned int ub = ((const CacheVictim*)b)->lastUse;
+    return (ua > ub) - (ua < ub);
+}
+
+// Drops the oldest droppable entries until the cache fits its budget.
+void TrimChunkCache(ChunkCache* cache) {
+    cache->needsFlush = false;
+    if (cache->bytes <= cache->budget) return;
+
+    CacheVictim* victims = (CacheVictim*)RL_MALLOC((cache->count + 1) * sizeof(CacheVictim));
+    int victimCount = 0;
+    for (int i = 0; i < cache->count; i++) {
+        const CachedChunk* entry = &cache->entries[i];
+        if (entry->generated || !entry->modified || !cache->hasSave) {
+            victims[victimCount++] = (CacheVictim){ entry->lastUse, entry->cx, entry->cy, entry->cz };
+        }
+    }
+    qsort(victims, victimCount, sizeof(CacheVictim), CompareCacheVictims);
+
+    for (int i = 0; i < victimCount && cache->bytes > cache->budget; i++) {
+        RemoveCachedEntry(cache, *FindCoord(&cache->index, victims[i].cx, victims[i].cy, victims[i].cz));
+    }
+    RL_FREE(victims);
+
+    cache->needsFlush = cache->bytes > cache->budget;
+}
+
+void FreeChunkCache(ChunkCache* cache) {
+    for (int i = 0; i < cache->count; i++) {
+        RL_FREE(cache->entries[i].blob);
+    }
+    RL_FREE(cache->entries);
+    FreeCoordMap(&cache->index);
+    *cache = (ChunkCache){ 0 };
+}
+
+void InitChunkStreamer(ChunkStreamer* streamer, int viewRadius) {
+    *streamer = (ChunkStreamer){ 0 };
+    streamer->viewRadius = viewRadius;
+    streamer->prefetchSeconds = STREAM_PREFETCH_SECONDS;
+    streamer->columnBudget = STREAM_COLUMN_BUDGET;
+}
+
+// Whether the chunk's contents are already known without the generator: in
+// memory, dug out, evicted to the cache or stored in the save.
+bool IsChunkKnown(World* world, int cx, int cy, int cz) {
+    if (FindChunk(world, cx, cy, cz) != NULL) return true;
+    if (FindCoord(&world->emptied, cx, cy, cz) != NULL) return true;
+    if (world->cache != NULL && FindCachedChunk(world->cache, cx, cy, cz) != NULL) return true;
+    return world->save != NULL && FindSaveEntry(world->save, cx, cy, cz) >= 0;
+}
+
+// Restores whatever the cache or save holds for the column and queues the
+// terrain chunks nobody has seen yet.
+void RequestColumn(ChunkStreamer* streamer, World* world, TerrainGenerator* generator, int cx, int cz) {
+    for (int cy = world->minChunkY; world->hasBounds && cy <= world->maxChunkY; cy++) {
+        GetChunk(world, cx, cy, cz);
+    }
+
+    int pending = 0;
+    if (world->hasTerrain && generator->running) {
+        for (int cy = 0; cy < TERRAIN_CHUNK_LAYERS; cy++) {
+            if (IsChunkKnown(world, cx, cy, cz)) continue;
+            RequestTerrainChunk(generator, cx, cy, cz);
+            pending++;
+        }
+    }
+    InsertCoord(&streamer->columns, cx, 0, cz, pending);
+    streamer->pending += pending;
+}
+
+void ReceiveTerrainChunks(ChunkStreamer* streamer, World* world, TerrainGenerator* generator) {
+    int count;
+    TerrainJob** jobs = TakeTerrainJobs(generator, &count);
+
+    for (int i = 0; i < count; i++) {
+        TerrainJob* job = jobs[i];
+        int* pending = FindCoord(&streamer->columns, job->cx, 0, job->cz);
+        if (pending != NULL && *pending > 0) {
+            (*pending)--;
+            streamer->pending--;
+        }
+
+        // The column may have been dropped, or the player built here first.
+        if (pending != NULL && job->blockCount > 0 && !IsChunkKnown(world, job->cx, job->cy, job->cz)) {
+            InsertTerrainChunk(world, job);
+        }
+        FreeTerrainJob(job);
+    }
+    RL_FREE(jobs);
+}
+
+int ColumnDistance(int ax, int az, int bx, int bz) {
+    int dx = abs(ax - bx);
+    int dz = abs(az - bz);
+    return (dx > dz) ? dx : dz;
+}
+
+// Requests missing columns ring by ring around (centerX, centerZ), nearest
+// first, until the per-frame budget is spent.
+int RequestColumnsAround(ChunkStreamer* streamer, World* world, TerrainGenerator* generator, int centerX, int centerZ, int budget) {
+    for (int ring = 0; ring <= streamer->viewRadius && budget > 0; ring++) {
+        for (int dz = -ring; dz <= ring && budget > 0; dz++) {
+            for (int dx = -ring; dx <= ring && budget > 0; dx++) {
+                if (abs(dx) != ring && abs(dz) != ring) continue;
+                if (FindCoord(&streamer->columns, centerX + dx, 0, centerZ + dz) != NULL) continue;
+                RequestColumn(streamer, world, generator, centerX + dx, centerZ + dz);
+                budget--;
+            }
+        }
+    }
+    return budget;
+}
+
+// Evicted chunks the save already holds unchanged are dropped outright;
+// everything else goes to the cache, where unsaved edits are pinned while
+// there is a save to write them.
+void EvictChunk(World* world, Chunk* chunk) {
+    bool saved = world->save != NULL && FindSaveEntry(world->save, chunk->cx, chunk->cy, chunk->cz) >= 0;
+    bool modified = chunk->modified || (!chunk->generated && !saved);
+
+    if (!chunk->generated && !modified) {
+        RemoveChunk(world, chunk);
+    } else if (world->cache != NULL) {
+        CacheChunk(world, chunk, modified);
+    }
+}
+
+void UpdateStreaming(ChunkStreamer* streamer, World* world, TerrainGenerator* generator, Vector3 position, float deltaTime) {
+    if (streamer->hasPosition && deltaTime > 0.0f) {
+        Vector3 velocity = Vector3Scale(Vector3Subtract(position, streamer->lastPosition), 1.0f / deltaTime);
+        streamer->velocity = Vector3Lerp(streamer->velocity, velocity, STREAM_VELOCITY_SMOOTHING);
+    }
+    streamer->lastPosition = position;
+    streamer->hasPosition = true;
+
+    if (generator->running) ReceiveTerrainChunks(streamer, world, generator);
+
+    int cellX, cellY, cellZ;
+    CellFromPosition(position, &cellX, &cellY, &cellZ);
+    int centerX = cellX >> CHUNK_SHIFT;
+    int centerZ = cellZ >> CHUNK_SHIFT;
+
+    // The lookahead never leaves the loaded square's reach, which is what
+    // keeps memory bounded however fast the player moves.
+    float reach = (float)(streamer->viewRadius * CHUNK_SIZE);
+    float aheadX = Clamp(streamer->velocity.x * streamer->prefetchSeconds, -reach, reach);
+    float aheadZ = Clamp(streamer->velocity.z * streamer->prefetchSeconds, -reach, reach);
+    int aheadCX = (int)floorf(position.x + aheadX + 0.5f) >> CHUNK_SHIFT;
+    int aheadCZ = (int)floorf(position.z + aheadZ + 0.5f) >> CHUNK_SHIFT;
+
+    int budget = RequestColumnsAround(streamer, world, generator, centerX, centerZ, streamer->columnBudget);
+    RequestColumnsAround(streamer, world, generator, aheadCX, aheadCZ, budget);
+
+    int keep = streamer->viewRadius + STREAM_HYSTERESIS;
+    for (int i = world->chunkCount - 1; i >= 0; i--) {
+        Chunk* chunk = world->chunks[i];
+        if (ColumnDistance(chunk->cx, chunk->cz, centerX, centerZ) <= keep) continue;
+        if (ColumnDistance(chunk->cx, chunk->cz, aheadCX, aheadCZ) <= keep) continue;
+        EvictChunk(world, chunk);
+    }
+
+    CoordMap* columns = &streamer->columns;
+    for (int slot = 0; slot < columns->capacity; slot++) {
+        CoordSlot column = columns->slots[slot];
+        if (!column.used) continue;
+        if (ColumnDistance(column.cx, column.cz, centerX, centerZ) <= keep) continue;
+        if (ColumnDistance(column.cx, column.cz, aheadCX, aheadCZ) <= keep) continue;
+
+        // Backward shifting can move a later entry into this slot; look again.
+        streamer->pending -= column.value;
+        RemoveCoord(columns, column.cx, 0, column.cz);
+        slot--;
+    }
+
+    if (world->cache != NULL) TrimChunkCache(world->cache);
+}
+
+// Waits for every chunk the generator was asked for, including those of
+// columns dropped since. Terrain then arrives on the same frame however fast
+// the workers are, which is what input replay needs.
+void FinishTerrainChunks(ChunkStreamer* streamer, World* world, TerrainGenerator* generator) {
+    while (generator->running && generator->pending > 0) {
+        ReceiveTerrainChunks(streamer, world, generator);
+        if (generator->pending > 0) WaitTime(STREAM_WAIT_SECONDS);
+    }
+}
+
+bool IsColumnStreamed(const ChunkStreamer* streamer, int x, int z) {
+    int* pending = FindCoord(&streamer->columns, x >> CHUNK_SHIFT, 0, z >> CHUNK_SHIFT);
+    return pending != NULL && *pending == 0;
+}
+
+void FreeChunkStreamer(ChunkStreamer* streamer) {
+    FreeCoordMap(&streamer->columns);
+    *streamer = (ChunkStreamer){ 0 };
+}
@@ -0,0 +1,82 @@
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "world.h"
+#include "terrain.h"
+
+#define STREAM_DEFAULT_VIEW_RADIUS 6
+#define STREAM_DEFAULT_LOD_RADIUS 16
+#define STREAM_HYSTERESIS 2
+#define STREAM_PREFETCH_SECONDS 2.0f
+#define STREAM_VELOCITY_SMOOTHING 0.1f
+#define STREAM_COLUMN_BUDGET 8
+#define STREAM_WAIT_SECONDS 0.0005
+#define CHUNK_CACHE_DEFAULT_BUDGET (32 * 1024 * 1024)
+
+// A chunk evicted from the world, kept as a save blob. Generated and saved
+// entries can be dropped whenever the cache is over budget; modified ones
+// only after a save has written them.
+typedef struct {
+    int cx, cy, cz;
+    int blockCount;
+    unsigned char* blob;
+    size_t size;
+    bool modified;
+    bool generated;
+    unsigned int revision;
+    unsigned int lastUse;
+} CachedChunk;
+
+// needsFlush is set when unsaved entries alone exceed the budget; the owner
+// should start a save so they become droppable. Unsaved entries are only
+// held for a save when hasSave is set; without one nothing would ever write
+// them, so they are dropped like the rest and their edits are lost.
+typedef struct ChunkCache {
+    CachedChunk* entries;
+    int count;
+    int capacity;
+    CoordMap index;
+
+    size_t bytes;
+    size_t budget;
+    unsigned int clock;
+    bool hasSave;
+    bool needsFlush;
+} ChunkCache;
+
+// Keeps every column within viewRadius chunks of the player loaded, plus the
+// same square around where the player will be prefetchSeconds from now.
+// Columns are only dropped once they are STREAM_HYSTERESIS chunks further
+// out, so walking back and forth over the edge does not thrash. columns maps
+// each loaded column (cy = 0) to the number of its terrain chunks still being
+// generated.
+typedef struct {
+    int viewRadius;
+    float prefetchSeconds;
+    int columnBudget;
+    CoordMap columns;
+
+    Vector3 lastPosition;
+    Vector3 velocity;
+    bool hasPosition;
+    int pending;
+} ChunkStreamer;
+
+void InitChunkCache(ChunkCache* cache, size_t budget);
+CachedChunk* FindCachedChunk(ChunkCache* cache, int cx, int cy, int cz);
+void CacheChunk(World* world, Chunk* chunk, bool modified);
+Chunk* RestoreCachedChunk(World* world, int cx, int cy, int cz);
+void TrimChunkCache(ChunkCache* cache);
+void FreeChunkCache(ChunkCache* cache);
+
+void InitChunkStreamer(ChunkStreamer* streamer, int viewRadius);
+void RequestColumn(ChunkStreamer* streamer, World* world, TerrainGenerator* generator, int cx, int cz);
+void ReceiveTerrainChunks(ChunkStreamer* streamer, World* world, TerrainGenerator* generator);
+int ColumnDistance(int ax, int az, int bx, int bz);
+void EvictChunk(World* world, Chunk* chunk);
+void UpdateStreaming(ChunkStreamer* streamer, World* world, TerrainGenerator* generator, Vector3 position, float deltaTime);
+void FinishTerrainChunks(ChunkStreamer* streamer, World* world, TerrainGenerator* generator);
+bool IsColumnStreamed(const ChunkStreamer* streamer, int x, int z);
+void FreeChunkStreamer(ChunkStreamer* streamer);
+
+#endif
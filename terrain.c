@@ -0,0 +1,251 @@
+#include "terrain.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+unsigned int TerrainHash(unsigned int seed, int x, int z) {
+    unsigned int h = seed ^ ((unsigned int)x * 0x27D4EB2Du) ^ ((unsigned int)z * 0x165667B1u);
+    h ^= h >> 15;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+float NoiseFade(float t) {
+    return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+float LatticeGradient(unsigned int seed, int x, int z, float dx, float dz) {
+    switch (TerrainHash(seed, x, z) & 7) {
+        case 0: return dx + dz;
+        case 1: return dx - dz;
+        case 2: return -dx + dz;
+        case 3: return -dx - dz;
+        case 4: return dx;
+        case 5: return -dx;
+        case 6: return dz;
+        default: return -dz;
+    }
+}
+
+// 2D gradient noise in roughly [-1, 1].
+float GradientNoise(unsigned int seed, float x, float z) {
+    int x0 = (int)floorf(x);
+    int z0 = (int)floorf(z);
+    float fx = x - x0;
+    float fz = z - z0;
+
+    float n00 = LatticeGradient(seed, x0, z0, fx, fz);
+    float n10 = LatticeGradient(seed, x0 + 1, z0, fx - 1.0f, fz);
+    float n01 = LatticeGradient(seed, x0, z0 + 1, fx, fz - 1.0f);
+    float n11 = LatticeGradient(seed, x0 + 1, z0 + 1, fx - 1.0f, fz - 1.0f);
+
+    float u = NoiseFade(fx);
+    float v = NoiseFade(fz);
+    float nx0 = n00 + (n10 - n00) * u;
+    float nx1 = n01 + (n11 - n01) * u;
+    return nx0 + (nx1 - nx0) * v;
+}
+
+float FractalNoise(unsigned int seed, float x, float z, int octaves) {
+    float sum = 0.0f;
+    float amplitude = 1.0f;
+    float total = 0.0f;
+    for (int i = 0; i < octaves; i++) {
+        sum += GradientNoise(seed + (unsigned int)i * 1013u, x, z) * amplitude;
+        total += amplitude;
+        amplitude *= 0.5f;
+        x *= 2.0f;
+        z *= 2.0f;
+    }
+    return sum / total;
+}
+
+// Surface height of column (x, z): the topmost solid block is at height - 1.
+int TerrainHeight(const TerrainSettings* settings, int x, int z) {
+    float hills = FractalNoise(settings->seed, x / TERRAIN_HILL_SCALE, z / TERRAIN_HILL_SCALE, TERRAIN_OCTAVES);
+    float detail = GradientNoise(settings->seed ^ 0x5BD1E995u, x / TERRAIN_DETAIL_SCALE, z / TERRAIN_DETAIL_SCALE);
+    int height = TERRAIN_BASE_HEIGHT + (int)floorf(hills * TERRAIN_HILL_HEIGHT * 2.0f + detail * TERRAIN_DETAIL_HEIGHT);
+    return (height < 1) ? 1 : height;
+}
+
+void SetChunkVoxel(unsigned char* voxels, int baseX, int baseY, int baseZ, int x, int y, int z, BlockType type, bool replace) {
+    int lx = x - baseX, ly = y - baseY, lz = z - baseZ;
+    if (lx < 0 || lx >= CHUNK_SIZE || ly < 0 || ly >= CHUNK_SIZE || lz < 0 || lz >= CHUNK_SIZE) return;
+
+    unsigned char* voxel = &voxels[ChunkVoxelIndex(lx, ly, lz)];
+    if (replace || *voxel == BLOCK_AIR) *voxel = (unsigned char)type;
+}
+
+// One candidate tree per TREE_CELL_SIZE cell, kept far enough from the cell
+// edges that canopies never overlap.
+void PlaceTrees(const TerrainSettings* settings, int cx, int cy, int cz, unsigned char* voxels) {
+    int baseX = cx * CHUNK_SIZE, baseY = cy * CHUNK_SIZE, baseZ = cz * CHUNK_SIZE;
+    int cellX0 = (int)floorf((float)(baseX - TREE_CANOPY_RADIUS) / TREE_CELL_SIZE);
+    int cellZ0 = (int)floorf((float)(baseZ - TREE_CANOPY_RADIUS) / TREE_CELL_SIZE);
+    int cellX1 = (int)floorf((float)(baseX + CHUNK_SIZE + TREE_CANOPY_RADIUS) / TREE_CELL_SIZE);
+    int cellZ1 = (int)floorf((float)(baseZ + CHUNK_SIZE + TREE_CANOPY_RADIUS) / TREE_CELL_SIZE);
+    int span = TREE_CELL_SIZE - 2 * TREE_CANOPY_RADIUS;
+
+    for (int gz = cellZ0; gz <= cellZ1; gz++) {
+        for (int gx = cellX0; gx <= cellX1; gx++) {
+            unsigned int hash = TerrainHash(settings->seed ^ 0x9E3779B9u, gx, gz);
+            if (hash % 100u >= TREE_CHANCE) continue;
+
+            int x = gx * TREE_CELL_SIZE + TREE_CANOPY_RADIUS + (int)((hash >> 8) % (unsigned int)span);
+            int z = gz * TREE_CELL_SIZE + TREE_CANOPY_RADIUS + (int)((hash >> 16) % (unsigned int)span);
+            int ground = TerrainHeight(settings, x, z);
+            int trunk = TREE_MIN_TRUNK + (int)((hash >> 24) % (TREE_MAX_TRUNK - TREE_MIN_TRUNK + 1));
+            int top = ground + trunk;
+            if (top + 1 < baseY || ground - 1 >= baseY + CHUNK_SIZE) continue;
+
+            for (int dy = -2; dy <= 1; dy++) {
+                int radius = (dy < 0) ? TREE_CANOPY_RADIUS : TREE_CANOPY_RADIUS - 1;
+                for (int dz = -radius; dz <= radius; dz++) {
+                    for (int dx = -radius; dx <= radius; dx++) {
+                        bool corner = abs(dx) == radius && abs(dz) == radius;
+                        if (corner && (dy == 1 || (TerrainHash(hash, dx, dz + dy * 8) & 1))) continue;
+                        SetChunkVoxel(voxels, baseX, baseY, baseZ, x + dx, top + dy, z + dz, BLOCK_LEAVES, false);
+                    }
+                }
+            }
+            for (int y = ground; y < top; y++) {
+                SetChunkVoxel(voxels, baseX, baseY, baseZ, x, y, z, BLOCK_WOOD, true);
+            }
+            // Trees stand on dirt, not grass.
+            SetChunkVoxel(voxels, baseX, baseY, baseZ, x, ground - 1, z, BLOCK_DIRT, true);
+        }
+    }
+}
+
+// Fills a chunk with stone, a few layers of dirt and a grass top, then trees.
+// Returns the number of solid voxels.
+int GenerateTerrainChunk(const TerrainSettings* settings, int cx, int cy, int cz, unsigned char* voxels) {
+    int baseX = cx * CHUNK_SIZE, baseY = cy * CHUNK_SIZE, baseZ = cz * CHUNK_SIZE;
+    memset(voxels, BLOCK_AIR, CHUNK_VOLUME);
+    if (baseY >= TERRAIN_MAX_HEIGHT || baseY + CHUNK_SIZE <= 0) return 0;
+
+    for (int lz = 0; lz < CHUNK_SIZE; lz++) {
+        for (int lx = 0; lx < CHUNK_SIZE; lx++) {
+            int height = TerrainHeight(settings, baseX + lx, baseZ + lz);
+            for (int ly = 0; ly < CHUNK_SIZE && baseY + ly < height; ly++) {
+                int y = baseY + ly;
+                BlockType type = (y == height - 1) ? BLOCK_GRASS : (y >= height - 1 - TERRAIN_DIRT_DEPTH) ? BLOCK_DIRT : BLOCK_STONE;
+                voxels[ChunkVoxelIndex(lx, ly, lz)] = (unsigned char)type;
+            }
+        }
+    }
+    PlaceTrees(settings, cx, cy, cz, voxels);
+
+    int blockCount = 0;
+    for (int i = 0; i < CHUNK_VOLUME; i++) {
+        if (voxels[i] != BLOCK_AIR) blockCount++;
+    }
+    return blockCount;
+}
+
+void RunTerrainJob(void* data) {
+    TerrainJob* job = (TerrainJob*)data;
+    TerrainGenerator* generator = job->generator;
+
+    job->voxels = (VoxelBuffer*)RL_MALLOC(sizeof(VoxelBuffer));
+    job->voxels->refCount = 1;
+    job->blockCount = GenerateTerrainChunk(&generator->settings, job->cx, job->cy, job->cz, job->voxels->data);
+
+    pthread_mutex_lock(&generator->lock);
+    if (generator->finishedCount == generator->finishedCapacity) {
+        generator->finishedCapacity = generator->finishedCapacity ? generator->finishedCapacity * 2 : CHUNK_TABLE_INITIAL_CAPACITY;
+        generator->finished = (TerrainJob**)RL_REALLOC(generator->finished, generator->finishedCapacity * sizeof(TerrainJob*));
+    }
+    generator->finished[generator->finishedCount++] = job;
+    pthread_mutex_unlock(&generator->lock);
+}
+
+void FreeTerrainJob(void* data) {
+    TerrainJob* job = (TerrainJob*)data;
+    if (job->voxels != NULL) ReleaseVoxelBuffer(job->voxels);
+    RL_FREE(job);
+}
+
+bool StartTerrainGenerator(TerrainGenerator* generator, TerrainSettings settings, int threadCount) {
+    *generator = (TerrainGenerator){ 0 };
+    generator->settings = settings;
+    pthread_mutex_init(&generator->lock, NULL);
+    generator->running = StartJobPool(&generator->pool, threadCount);
+    if (!generator->running) pthread_mutex_destroy(&generator->lock);
+    return generator->running;
+}
+
+void RequestTerrainChunk(TerrainGenerator* generator, int cx, int cy, int cz) {
+    TerrainJob* job = (TerrainJob*)RL_CALLOC(1, sizeof(TerrainJob));
+    job->generator = generator;
+    job->cx = cx;
+    job->cy = cy;
+    job->cz = cz;
+    generator->pending++;
+    SubmitJob(&generator->pool, RunTerrainJob, job);
+}
+
+// Hands the finished jobs to the caller, who frees them with FreeTerrainJob.
+TerrainJob** TakeTerrainJobs(TerrainGenerator* generator, int* count) {
+    *count = 0;
+    if (!generator->running || generator->pending == 0) return NULL;
+
+    pthread_mutex_lock(&generator->lock);
+    TerrainJob** finished = generator->finished;
+    *count = generator->finishedCount;
+    generator->finished = NULL;
+    generator->finishedCount = 0;
+    generator->finishedCapacity = 0;
+    pthread_mutex_unlock(&generator->lock);
+
+    generator->pending -= *count;
+    return finished;
+}
+
+// Generated chunks are never saved unless edited, since the seed recreates
+// them; neighbors are remeshed so shared faces get culled.
+Chunk* InsertTerrainChunk(World* world, TerrainJob* job) {
+    Chunk* chunk = CreateChunk(world, job->cx, job->cy, job->cz);
+    ReleaseVoxelBuffer(chunk->voxels);
+    chunk->voxels = job->voxels;
+    job->voxels = NULL;
+
+    chunk->blockCount = job->blockCount;
+    chunk->generated = true;
+    world->blockCount += job->blockCount;
+
+    MarkNeighborsDirty(world, job->cx, job->cy, job->cz);
+    return chunk;
+}
+
+// Moves every finished chunk into the world, except where the player
+// already built.
+int CollectTerrainChunks(TerrainGenerator* generator, World* world) {
+    int count;
+    TerrainJob** finished = TakeTerrainJobs(generator, &count);
+
+    for (int i = 0; i < count; i++) {
+        TerrainJob* job = finished[i];
+        if (job->blockCount > 0 && FindChunk(world, job->cx, job->cy, job->cz) == NULL) {
+            InsertTerrainChunk(world, job);
+        }
+        FreeTerrainJob(job);
+    }
+    RL_FREE(finished);
+    return count;
+}
+
+void StopTerrainGenerator(TerrainGenerator* generator) {
+    if (!generator->running) return;
+
+    StopJobPool(&generator->pool, FreeTerrainJob);
+    for (int i = 0; i < generator->finishedCount; i++) {
+        FreeTerrainJob(generator->finished[i]);
+    }
+    RL_FREE(generator->finished);
+    pthread_mutex_destroy(&generator->lock);
+    *generator = (TerrainGenerator){ 0 };
+}
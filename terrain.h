@@ -0,0 +1,65 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include "world.h"
+#include "jobpool.h"
+
+#define TERRAIN_BASE_HEIGHT 12
+#define TERRAIN_HILL_HEIGHT 9.0f
+#define TERRAIN_HILL_SCALE 48.0f
+#define TERRAIN_DETAIL_HEIGHT 3.0f
+#define TERRAIN_DETAIL_SCALE 12.0f
+#define TERRAIN_OCTAVES 4
+#define TERRAIN_DIRT_DEPTH 3
+#define TERRAIN_MAX_HEIGHT 40
+#define TERRAIN_CHUNK_LAYERS ((TERRAIN_MAX_HEIGHT + CHUNK_SIZE - 1) / CHUNK_SIZE)
+
+#define TREE_CELL_SIZE 8
+#define TREE_CHANCE 40
+#define TREE_CANOPY_RADIUS 2
+#define TREE_MIN_TRUNK 4
+#define TREE_MAX_TRUNK 6
+
+// A chunk's contents depend only on the seed and its coordinates, so the
+// world comes out the same whatever the thread count or finishing order.
+typedef struct {
+    unsigned int seed;
+} TerrainSettings;
+
+struct TerrainGenerator;
+
+typedef struct {
+    struct TerrainGenerator* generator;
+    int cx, cy, cz;
+    VoxelBuffer* voxels;
+    int blockCount;
+} TerrainJob;
+
+// Finished jobs wait in a locked list until the main thread takes them.
+typedef struct TerrainGenerator {
+    TerrainSettings settings;
+    JobPool pool;
+    bool running;
+
+    pthread_mutex_t lock;
+    TerrainJob** finished;
+    int finishedCount;
+    int finishedCapacity;
+
+    int pending;
+} TerrainGenerator;
+
+float GradientNoise(unsigned int seed, float x, float z);
+float FractalNoise(unsigned int seed, float x, float z, int octaves);
+int TerrainHeight(const TerrainSettings* settings, int x, int z);
+int GenerateTerrainChunk(const TerrainSettings* settings, int cx, int cy, int cz, unsigned char* voxels);
+
+bool StartTerrainGenerator(TerrainGenerator* generator, TerrainSettings settings, int threadCount);
+void RequestTerrainChunk(TerrainGenerator* generator, int cx, int cy, int cz);
+TerrainJob** TakeTerrainJobs(TerrainGenerator* generator, int* count);
+Chunk* InsertTerrainChunk(World* world, TerrainJob* job);
+void FreeTerrainJob(void* data);
+int CollectTerrainChunks(TerrainGenerator* generator, World* world);
+void StopTerrainGenerator(TerrainGenerator* generator);
+
+#endif
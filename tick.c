@@ -0,0 +1,178 @@
+#include "tick.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Leaves and air let light through to the grass under them.
+bool CoversGrass(BlockType type) {
+    return type != BLOCK_AIR && type != BLOCK_LEAVES;
+}
+
+unsigned int NextTickRandom(BlockTicker* ticker) {
+    unsigned int x = ticker->random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    ticker->random = x;
+    return x;
+}
+
+void InitBlockTicker(BlockTicker* ticker, unsigned int seed, float budgetMs) {
+    *ticker = (BlockTicker){ 0 };
+    ticker->random = seed ? seed : 1;
+    ticker->budgetMs = budgetMs;
+}
+
+bool TickBefore(const ScheduledTick* a, const ScheduledTick* b) {
+    return a->due < b->due || (a->due == b->due && (int)(a->order - b->order) < 0);
+}
+
+// A cell already waiting for a tick keeps the one it has.
+void ScheduleBlockTick(BlockTicker* ticker, int x, int y, int z, int delay) {
+    if (FindCoord(&ticker->pending, x, y, z) != NULL) return;
+    InsertCoord(&ticker->pending, x, y, z, 1);
+
+    if (ticker->count == ticker->capacity) {
+        ticker->capacity = ticker->capacity ? ticker->capacity * 2 : 256;
+        ticker->heap = (ScheduledTick*)RL_REALLOC(ticker->heap, ticker->capacity * sizeof(ScheduledTick));
+    }
+    int i = ticker->count++;
+    ScheduledTick tick = { ticker->tick + delay, ticker->nextOrder++, x, y, z };
+    while (i > 0 && TickBefore(&tick, &ticker->heap[(i - 1) / 2])) {
+        ticker->heap[i] = ticker->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    ticker->heap[i] = tick;
+}
+
+ScheduledTick PopBlockTick(BlockTicker* ticker) {
+    ScheduledTick top = ticker->heap[0];
+    ScheduledTick last = ticker->heap[--ticker->count];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= ticker->count) break;
+        if (child + 1 < ticker->count && TickBefore(&ticker->heap[child + 1], &ticker->heap[child])) child++;
+        if (!TickBefore(&ticker->heap[child], &last)) break;
+        ticker->heap[i] = ticker->heap[child];
+        i = child;
+    }
+    if (ticker->count > 0) ticker->heap[i] = last;
+    RemoveCoord(&ticker->pending, top.x, top.y, top.z);
+    return top;
+}
+
+// Changes made by ticks notify their neighbors like any other.
+void SetTickedBlock(BlockTicker* ticker, World* world, int x, int y, int z, BlockType type) {
+    SetBlock(world, x, y, z, type);
+    NotifyBlockChanged(ticker, world, x, y, z);
+}
+
+// A change only matters to its own cell and the six around it. Of those,
+// only cells with something to do get a tick: grass that is now covered
+// turns to dirt GRASS_DECAY_DELAY game ticks later, if still covered then.
+void NotifyBlockChanged(BlockTicker* ticker, World* world, int x, int y, int z) {
+    const int offsets[7][3] = { {0,0,0}, {-1,0,0}, {1,0,0}, {0,-1,0}, {0,1,0}, {0,0,-1}, {0,0,1} };
+    for (int i = 0; i < 7; i++) {
+        int nx = x + offsets[i][0];
+        int ny = y + offsets[i][1];
+        int nz = z + offsets[i][2];
+        if (GetLoadedBlock(world, nx, ny, nz) == BLOCK_GRASS && CoversGrass(GetLoadedBlock(world, nx, ny + 1, nz))) {
+            ScheduleBlockTick(ticker, nx, ny, nz, GRASS_DECAY_DELAY);
+        }
+    }
+}
+
+void NotifyEditRecord(BlockTicker* ticker, World* world, const EditRecord* record) {
+    for (int c = 0; c < record->chunkCount; c++) {
+        const ChunkDiff* diff = &record->chunks[c];
+        for (int r = 0; r < diff->runCount; r++) {
+            int start = diff->runs[2 * r];
+            for (int index = start; index < start + diff->runs[2 * r + 1]; index++) {
+                int x = diff->cx * CHUNK_SIZE + (index & CHUNK_MASK);
+                int z = diff->cz * CHUNK_SIZE + ((index >> CHUNK_SHIFT) & CHUNK_MASK);
+                int y = diff->cy * CHUNK_SIZE + (index >> (2 * CHUNK_SHIFT));
+                NotifyBlockChanged(ticker, world, x, y, z);
+            }
+        }
+    }
+}
+
+void RunScheduledTick(BlockTicker* ticker, World* world, const ScheduledTick* tick) {
+    int x = tick->x, y = tick->y, z = tick->z;
+    if (GetLoadedBlock(world, x, y, z) == BLOCK_GRASS && CoversGrass(GetLoadedBlock(world, x, y + 1, z))) {
+        SetTickedBlock(ticker, world, x, y, z, BLOCK_DIRT);
+    }
+}
+
+// Covered grass turns to dirt; open grass spreads to one random cell around
+// it, up to a block higher or lower, if that is dirt with nothing on top.
+void RandomTickGrass(BlockTicker* ticker, World* world, int x, int y, int z, unsigned int random) {
+    if (CoversGrass(GetLoadedBlock(world, x, y + 1, z))) {
+        SetTickedBlock(ticker, world, x, y, z, BLOCK_DIRT);
+        return;
+    }
+    int nx = x + (int)(random % 3) - 1;
+    random /= 3;
+    int ny = y + (int)(random % 3) - 1;
+    random /= 3;
+    int nz = z + (int)(random % 3) - 1;
+    if (GetLoadedBlock(world, nx, ny, nz) == BLOCK_DIRT && !CoversGrass(GetLoadedBlock(world, nx, ny + 1, nz))) {
+        SetTickedBlock(ticker, world, nx, ny, nz, BLOCK_GRASS);
+    }
+}
+
+void RandomTickChunk(BlockTicker* ticker, World* world, Chunk* chunk) {
+    if (chunk->blockCount == 0) return;
+    for (int i = 0; i < RANDOM_TICKS_PER_CHUNK; i++) {
+        unsigned int random = NextTickRandom(ticker);
+        int index = (int)(random & (CHUNK_VOLUME - 1));
+        if (chunk->voxels->data[index] != BLOCK_GRASS) continue;
+
+        int x = chunk->cx * CHUNK_SIZE + (index & CHUNK_MASK);
+        int z = chunk->cz * CHUNK_SIZE + ((index >> CHUNK_SHIFT) & CHUNK_MASK);
+        int y = chunk->cy * CHUNK_SIZE + (index >> (2 * CHUNK_SHIFT));
+        RandomTickGrass(ticker, world, x, y, z, random >> (3 * CHUNK_SHIFT));
+    }
+}
+
+// The clock is only read every BLOCK_TICK_CHECK_INTERVAL units of work, and
+// the first unit always runs, so every frame makes progress.
+bool OutOfTickBudget(const BlockTicker* ticker, double start, int ran) {
+    if (ticker->budgetMs <= 0.0f || ran == 0 || ran % BLOCK_TICK_CHECK_INTERVAL != 0) return false;
+    return (GetTime() - start) * 1000.0 >= ticker->budgetMs;
+}
+
+// Advances the game-tick clock by deltaTime, then runs due scheduled ticks
+// and owed random chunk visits until the budget is spent. A budget of zero
+// runs everything, as fixed-step replays need.
+void RunBlockTicks(BlockTicker* ticker, World* world, float deltaTime) {
+    ticker->accumulator += deltaTime;
+    while (ticker->accumulator >= 1.0f / BLOCK_TICK_RATE) {
+        ticker->accumulator -= 1.0f / BLOCK_TICK_RATE;
+        ticker->tick++;
+        ticker->chunkVisitsOwed += world->chunkCount;
+    }
+    long long backlog = (long long)world->chunkCount * BLOCK_TICK_MAX_BACKLOG;
+    if (ticker->chunkVisitsOwed > backlog) ticker->chunkVisitsOwed = backlog;
+
+    double start = GetTime();
+    int ran = 0;
+    while (ticker->count > 0 && ticker->heap[0].due <= ticker->tick && !OutOfTickBudget(ticker, start, ran)) {
+        ScheduledTick tick = PopBlockTick(ticker);
+        RunScheduledTick(ticker, world, &tick);
+        ran++;
+    }
+    while (ticker->chunkVisitsOwed > 0 && world->chunkCount > 0 && !OutOfTickBudget(ticker, start, ran)) {
+        if (ticker->chunkCursor >= world->chunkCount) ticker->chunkCursor = 0;
+        RandomTickChunk(ticker, world, world->chunks[ticker->chunkCursor++]);
+        ticker->chunkVisitsOwed--;
+        ran++;
+    }
+    ticker->ranLastFrame = ran;
+}
+
+void FreeBlockTicker(BlockTicker* ticker) {
+    RL_FREE(ticker->heap);
+    FreeCoordMap(&ticker->pending);
+    *ticker = (BlockTicker){ 0 };
+}
@@ -0,0 +1,53 @@
+#ifndef TICK_H
+#define TICK_H
+
+#include "world.h"
+#include "edit.h"
+
+#define BLOCK_TICK_RATE 20
+#define BLOCK_TICK_BUDGET_MS 1.0f
+#define BLOCK_TICK_MAX_BACKLOG 10
+#define RANDOM_TICKS_PER_CHUNK 3
+#define GRASS_DECAY_DELAY 40
+#define BLOCK_TICK_CHECK_INTERVAL 32
+
+typedef struct {
+    long long due;
+    unsigned int order;
+    int x, y, z;
+} ScheduledTick;
+
+// Scheduled ticks wait in a min-heap on (due, order), so ticks due on the
+// same game tick run in the order they were scheduled; pending holds the
+// cells with a tick queued, at most one each. Random ticks visit every
+// loaded chunk once per game tick, each time at RANDOM_TICKS_PER_CHUNK
+// random cells. Both stop when the frame's budget is spent and go on from
+// where they were on the next frame; random visits owed for more than
+// BLOCK_TICK_MAX_BACKLOG game ticks are dropped rather than caught up.
+typedef struct {
+    ScheduledTick* heap;
+    int count;
+    int capacity;
+    CoordMap pending;
+    unsigned int nextOrder;
+
+    long long tick;
+    float accumulator;
+    unsigned int random;
+    int chunkCursor;
+    long long chunkVisitsOwed;
+
+    float budgetMs;
+    int ranLastFrame;
+} BlockTicker;
+
+bool CoversGrass(BlockType type);
+
+void InitBlockTicker(BlockTicker* ticker, unsigned int seed, float budgetMs);
+void ScheduleBlockTick(BlockTicker* ticker, int x, int y, int z, int delay);
+void NotifyBlockChanged(BlockTicker* ticker, World* world, int x, int y, int z);
+void NotifyEditRecord(BlockTicker* ticker, World* world, const EditRecord* record);
+void RunBlockTicks(BlockTicker* ticker, World* world, float deltaTime);
+void FreeBlockTicker(BlockTicker* ticker);
+
+#endif
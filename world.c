@@ -0,0 +1,475 @@
+#include "world.h"
+#include "save.h"
+#include "stream.h"
+#include "light.h"
+#include "raymath.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Cell (x, y, z) is the unit block centered on (x, y + 0.5, z), so blocks
+// resting on the ground plane live at y = 0.
+Vector3 CellCenter(int x, int y, int z) {
+    return (Vector3){ (float)x, (float)y + 0.5f, (float)z };
+}
+
+BoundingBox CellBox(int x, int y, int z) {
+    return (BoundingBox){
+        (Vector3){ x - 0.5f, (float)y, z - 0.5f },
+        (Vector3){ x + 0.5f, (float)y + 1.0f, z + 0.5f }
+    };
+}
+
+void CellFromPosition(Vector3 position, int* x, int* y, int* z) {
+    *x = (int)floorf(position.x + 0.5f);
+    *y = (int)floorf(position.y);
+    *z = (int)floorf(position.z + 0.5f);
+}
+
+// Conservative range of cells whose boxes can touch the given box; callers do
+// the exact AABB test per cell so touching faces behave like before.
+void CellRangeForBox(BoundingBox box, int* x0, int* y0, int* z0, int* x1, int* y1, int* z1) {
+    *x0 = (int)floorf(box.min.x + 0.5f) - 1;
+    *y0 = (int)floorf(box.min.y) - 1;
+    *z0 = (int)floorf(box.min.z + 0.5f) - 1;
+    *x1 = (int)floorf(box.max.x + 0.5f) + 1;
+    *y1 = (int)floorf(box.max.y) + 1;
+    *z1 = (int)floorf(box.max.z + 0.5f) + 1;
+}
+
+// The ground plane is treated as a solid layer of cells just below y = 0 so
+// it is hit by the same traversal as real blocks.
+bool IsGroundCell(int y) {
+    return y == -1;
+}
+
+unsigned int ChunkHash(int cx, int cy, int cz) {
+    return ((unsigned int)cx * 73856093u) ^ ((unsigned int)cy * 19349663u) ^ ((unsigned int)cz * 83492791u);
+}
+
+int FindCoordSlot(const CoordMap* map, int cx, int cy, int cz) {
+    if (map->capacity == 0) return -1;
+
+    unsigned int mask = (unsigned int)map->capacity - 1;
+    unsigned int slot = ChunkHash(cx, cy, cz) & mask;
+    while (map->slots[slot].used) {
+        const CoordSlot* entry = &map->slots[slot];
+        if (entry->cx == cx && entry->cy == cy && entry->cz == cz) return (int)slot;
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+int* FindCoord(const CoordMap* map, int cx, int cy, int cz) {
+    int slot = FindCoordSlot(map, cx, cy, cz);
+    return (slot >= 0) ? &map->slots[slot].value : NULL;
+}
+
+void InsertCoordSlot(CoordSlot* slots, int capacity, CoordSlot entry) {
+    unsigned int mask = (unsigned int)capacity - 1;
+    unsigned int slot = ChunkHash(entry.cx, entry.cy, entry.cz) & mask;
+    while (slots[slot].used) {
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = entry;
+}
+
+// Returns the existing value when the coordinates are already present.
+int* InsertCoord(CoordMap* map, int cx, int cy, int cz, int value) {
+    int* existing = FindCoord(map, cx, cy, cz);
+    if (existing != NULL) return existing;
+
+    if ((map->count + 1) * 2 > map->capacity) {
+        int newCapacity = map->capacity ? map->capacity * 2 : CHUNK_TABLE_INITIAL_CAPACITY;
+        CoordSlot* newSlots = (CoordSlot*)RL_CALLOC(newCapacity, sizeof(CoordSlot));
+        for (int i = 0; i < map->capacity; i++) {
+            if (map->slots[i].used) InsertCoordSlot(newSlots, newCapacity, map->slots[i]);
+        }
+        RL_FREE(map->slots);
+        map->slots = newSlots;
+        map->capacity = newCapacity;
+    }
+
+    map->count++;
+    InsertCoordSlot(map->slots, map->capacity, (CoordSlot){ cx, cy, cz, value, true });
+    return FindCoord(map, cx, cy, cz);
+}
+
+bool RemoveCoord(CoordMap* map, int cx, int cy, int cz) {
+    int found = FindCoordSlot(map, cx, cy, cz);
+    if (found < 0) return false;
+
+    unsigned int mask = (unsigned int)map->capacity - 1;
+    unsigned int slot = (unsigned int)found;
+    map->slots[slot].used = false;
+    map->count--;
+
+    for (unsigned int next = (slot + 1) & mask; map->slots[next].used; next = (next + 1) & mask) {
+        CoordSlot displaced = map->slots[next];
+        map->slots[next].used = false;
+        InsertCoordSlot(map->slots, map->capacity, displaced);
+    }
+    return true;
+}
+
+void FreeCoordMap(CoordMap* map) {
+    RL_FREE(map->slots);
+    *map = (CoordMap){ 0 };
+}
+
+int ChunkVoxelIndex(int lx, int ly, int lz) {
+    return (ly * CHUNK_SIZE + lz) * CHUNK_SIZE + lx;
+}
+
+Chunk* FindChunk(World* world, int cx, int cy, int cz) {
+    if (world->tableCapacity == 0) return NULL;
+
+    unsigned int mask = (unsigned int)world->tableCapacity - 1;
+    unsigned int slot = ChunkHash(cx, cy, cz) & mask;
+    while (world->table[slot] != NULL) {
+        Chunk* chunk = world->table[slot];
+        if (chunk->cx == cx && chunk->cy == cy && chunk->cz == cz) {
+            return chunk;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return NULL;
+}
+
+// Like FindChunk, but falls back to restoring the chunk from the eviction
+// cache or the attached save, unless it has been dug out since.
+Chunk* GetChunk(World* world, int cx, int cy, int cz) {
+    Chunk* chunk = FindChunk(world, cx, cy, cz);
+    if (chunk != NULL) return chunk;
+    if (FindCoord(&world->emptied, cx, cy, cz) != NULL) return NULL;
+
+    if (world->cache != NULL) chunk = RestoreCachedChunk(world, cx, cy, cz);
+    if (chunk == NULL && world->save != NULL) chunk = LoadSavedChunk(world, cx, cy, cz);
+    return chunk;
+}
+
+void ExtendChunkBounds(World* world, int cx, int cy, int cz) {
+    if (!world->hasBounds || cx < world->minChunkX) world->minChunkX = cx;
+    if (!world->hasBounds || cy < world->minChunkY) world->minChunkY = cy;
+    if (!world->hasBounds || cz < world->minChunkZ) world->minChunkZ = cz;
+    if (!world->hasBounds || cx > world->maxChunkX) world->maxChunkX = cx;
+    if (!world->hasBounds || cy > world->maxChunkY) world->maxChunkY = cy;
+    if (!world->hasBounds || cz > world->maxChunkZ) world->maxChunkZ = cz;
+    world->hasBounds = true;
+}
+
+VoxelBuffer* RetainVoxelBuffer(VoxelBuffer* buffer) {
+    buffer->refCount++;
+    return buffer;
+}
+
+void ReleaseVoxelBuffer(VoxelBuffer* buffer) {
+    if (--buffer->refCount == 0) RL_FREE(buffer);
+}
+
+unsigned char* GetWritableVoxels(Chunk* chunk) {
+    if (chunk->voxels->refCount > 1) {
+        VoxelBuffer* copy = (VoxelBuffer*)RL_MALLOC(sizeof(VoxelBuffer));
+        copy->refCount = 1;
+        memcpy(copy->data, chunk->voxels->data, CHUNK_VOLUME);
+        ReleaseVoxelBuffer(chunk->voxels);
+        chunk->voxels = copy;
+    }
+    return chunk->voxels->data;
+}
+
+LightBuffer* RetainLightBuffer(LightBuffer* buffer) {
+    buffer->refCount++;
+    return buffer;
+}
+
+void ReleaseLightBuffer(LightBuffer* buffer) {
+    if (--buffer->refCount == 0) RL_FREE(buffer);
+}
+
+// A chunk lit for the first time starts out dark.
+unsigned char* GetWritableLight(Chunk* chunk) {
+    if (chunk->light == NULL) {
+        chunk->light = (LightBuffer*)RL_CALLOC(1, sizeof(LightBuffer));
+        chunk->light->refCount = 1;
+    } else if (chunk->light->refCount > 1) {
+        LightBuffer* copy = (LightBuffer*)RL_MALLOC(sizeof(LightBuffer));
+        copy->refCount = 1;
+        memcpy(copy->data, chunk->light->data, CHUNK_VOLUME);
+        ReleaseLightBuffer(chunk->light);
+        chunk->light = copy;
+    }
+    return chunk->light->data;
+}
+
+void InsertChunkSlot(Chunk** table, int tableCapacity, Chunk* chunk) {
+    unsigned int mask = (unsigned int)tableCapacity - 1;
+    unsigned int slot = ChunkHash(chunk->cx, chunk->cy, chunk->cz) & mask;
+    while (table[slot] != NULL) {
+        slot = (slot + 1) & mask;
+    }
+    table[slot] = chunk;
+}
+
+Chunk* CreateChunk(World* world, int cx, int cy, int cz) {
+    if ((world->chunkCount + 1) * 2 > world->tableCapacity) {
+        int newCapacity = world->tableCapacity ? world->tableCapacity * 2 : CHUNK_TABLE_INITIAL_CAPACITY;
+        Chunk** newTable = (Chunk**)RL_CALLOC(newCapacity, sizeof(Chunk*));
+        for (int i = 0; i < world->chunkCount; i++) {
+            InsertChunkSlot(newTable, newCapacity, world->chunks[i]);
+        }
+        RL_FREE(world->table);
+        world->table = newTable;
+        world->tableCapacity = newCapacity;
+    }
+
+    if (world->chunkCount >= world->chunkCapacity) {
+        world->chunkCapacity = world->chunkCapacity ? world->chunkCapacity * 2 : CHUNK_TABLE_INITIAL_CAPACITY;
+        world->chunks = (Chunk**)RL_REALLOC(world->chunks, world->chunkCapacity * sizeof(Chunk*));
+    }
+
+    Chunk* chunk = (Chunk*)RL_CALLOC(1, sizeof(Chunk));
+    chunk->cx = cx;
+    chunk->cy = cy;
+    chunk->cz = cz;
+    chunk->index = world->chunkCount;
+    chunk->dirty = true;
+    chunk->voxels = (VoxelBuffer*)RL_CALLOC(1, sizeof(VoxelBuffer));
+    chunk->voxels->refCount = 1;
+    memset(chunk->faceLinks, ALL_CHUNK_FACES, sizeof(chunk->faceLinks));
+
+    ExtendChunkBounds(world, cx, cy, cz);
+    if (world->emptied.count > 0) RemoveCoord(&world->emptied, cx, cy, cz);
+
+    world->chunks[world->chunkCount++] = chunk;
+    InsertChunkSlot(world->table, world->tableCapacity, chunk);
+    return chunk;
+}
+
+// Backward-shift deletion from the hash table and swap-remove from the
+// chunk list, so dropping a chunk costs O(1) and leaves no tombstones.
+void RemoveChunk(World* world, Chunk* chunk) {
+    unsigned int mask = (unsigned int)world->tableCapacity - 1;
+    unsigned int slot = ChunkHash(chunk->cx, chunk->cy, chunk->cz) & mask;
+    while (world->table[slot] != chunk) {
+        slot = (slot + 1) & mask;
+    }
+    world->table[slot] = NULL;
+
+    for (unsigned int next = (slot + 1) & mask; world->table[next] != NULL; next = (next + 1) & mask) {
+        Chunk* displaced = world->table[next];
+        world->table[next] = NULL;
+        InsertChunkSlot(world->table, world->tableCapacity, displaced);
+    }
+
+    Chunk* last = world->chunks[--world->chunkCount];
+    world->chunks[chunk->index] = last;
+    last->index = chunk->index;
+    world->blockCount -= chunk->blockCount;
+
+    if (world->onChunkRemoved != NULL) world->onChunkRemoved(chunk);
+    ReleaseVoxelBuffer(chunk->voxels);
+    if (chunk->light != NULL) ReleaseLightBuffer(chunk->light);
+    RL_FREE(chunk);
+}
+
+void MarkChunkDirty(World* world, int cx, int cy, int cz) {
+    Chunk* chunk = FindChunk(world, cx, cy, cz);
+    if (chunk != NULL) chunk->dirty = true;
+}
+
+// A chunk arriving next to meshed ones changes which of their border faces
+// are hidden, and the ambient occlusion of cells along their edges and
+// corners too.
+void MarkNeighborsDirty(World* world, int cx, int cy, int cz) {
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dz = -1; dz <= 1; dz++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if (dx != 0 || dy != 0 || dz != 0) MarkChunkDirty(world, cx + dx, cy + dy, cz + dz);
+            }
+        }
+    }
+}
+
+// Every cell whose block changes goes through here; the light engine, when
+// one is attached, relights around them before the next meshes are queued.
+void MarkLightDirty(World* world, int x, int y, int z) {
+    if (world->light != NULL) QueueLightUpdate(world->light, x, y, z);
+}
+
+// Chunks an edit brings back or digs out hand their light to and from the
+// light engine, so neither is ever lit from scratch.
+void RestoreChunkLight(World* world, Chunk* chunk) {
+    if (world->light != NULL) LightCreatedChunk(world->light, world, chunk);
+}
+
+void KeepChunkLight(World* world, Chunk* chunk) {
+    if (world->light != NULL) KeepEmptiedChunk(world->light, chunk);
+}
+
+BlockType GetBlock(World* world, int x, int y, int z) {
+    Chunk* chunk = GetChunk(world, x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+    if (chunk == NULL) return BLOCK_AIR;
+    return (BlockType)chunk->voxels->data[ChunkVoxelIndex(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK)];
+}
+
+// Reads only chunks already in memory, so looking across a border never
+// pulls the neighbor in from the cache or the save.
+BlockType GetLoadedBlock(World* world, int x, int y, int z) {
+    Chunk* chunk = FindChunk(world, x >> CHUNK_SHIFT, y >> CHUNK_SHIFT, z >> CHUNK_SHIFT);
+    if (chunk == NULL) return BLOCK_AIR;
+    return (BlockType)chunk->voxels->data[ChunkVoxelIndex(x & CHUNK_MASK, y & CHUNK_MASK, z & CHUNK_MASK)];
+}
+
+void SetBlock(World* world, int x, int y, int z, BlockType type) {
+    int cx = x >> CHUNK_SHIFT;
+    int cy = y >> CHUNK_SHIFT;
+    int cz = z >> CHUNK_SHIFT;
+
+    Chunk* chunk = GetChunk(world, cx, cy, cz);
+    if (chunk == NULL) {
+        if (type == BLOCK_AIR) return;
+        chunk = CreateChunk(world, cx, cy, cz);
+        RestoreChunkLight(world, chunk);
+    }
+
+    int lx = x & CHUNK_MASK;
+    int ly = y & CHUNK_MASK;
+    int lz = z & CHUNK_MASK;
+
+    int index = ChunkVoxelIndex(lx, ly, lz);
+    if (chunk->voxels->data[index] == (unsigned char)type) return;
+
+    unsigned char* voxel = &GetWritableVoxels(chunk)[index];
+    if (*voxel == BLOCK_AIR && type != BLOCK_AIR) {
+        chunk->blockCount++;
+        world->blockCount++;
+    } else if (*voxel != BLOCK_AIR && type == BLOCK_AIR) {
+        chunk->blockCount--;
+        world->blockCount--;
+    }
+    *voxel = (unsigned char)type;
+    MarkLightDirty(world, x, y, z);
+
+    chunk->dirty = true;
+    chunk->modified = true;
+    chunk->generated = false;
+    chunk->revision = ++world->revision;
+    world->modified = true;
+    if (lx == 0) MarkChunkDirty(world, cx - 1, cy, cz);
+    if (lx == CHUNK_MASK) MarkChunkDirty(world, cx + 1, cy, cz);
+    if (ly == 0) MarkChunkDirty(world, cx, cy - 1, cz);
+    if (ly == CHUNK_MASK) MarkChunkDirty(world, cx, cy + 1, cz);
+    if (lz == 0) MarkChunkDirty(world, cx, cy, cz - 1);
+    if (lz == CHUNK_MASK) MarkChunkDirty(world, cx, cy, cz + 1);
+
+    if (chunk->blockCount == 0) {
+        InsertCoord(&world->emptied, cx, cy, cz, 0);
+        KeepChunkLight(world, chunk);
+        RemoveChunk(world, chunk);
+    }
+}
+
+void FreeWorld(World* world) {
+    for (int i = 0; i < world->chunkCount; i++) {
+        if (world->onChunkRemoved != NULL) world->onChunkRemoved(world->chunks[i]);
+        ReleaseVoxelBuffer(world->chunks[i]->voxels);
+        if (world->chunks[i]->light != NULL) ReleaseLightBuffer(world->chunks[i]->light);
+        RL_FREE(world->chunks[i]);
+    }
+    RL_FREE(world->chunks);
+    RL_FREE(world->table);
+    FreeCoordMap(&world->emptied);
+    CloseWorldSave(world);
+    *world = (World){ 0 };
+}
+
+float FindGroundLevel(Vector3 position, World* world) {
+    int targetX = (int)roundf(position.x);
+    int targetZ = (int)roundf(position.z);
+
+    int cx = targetX >> CHUNK_SHIFT;
+    int cz = targetZ >> CHUNK_SHIFT;
+    int lx = targetX & CHUNK_MASK;
+    int lz = targetZ & CHUNK_MASK;
+
+    for (int cy = world->maxChunkY; cy >= world->minChunkY && cy >= 0; cy--) {
+        Chunk* chunk = GetChunk(world, cx, cy, cz);
+        if (chunk == NULL || chunk->blockCount == 0) continue;
+
+        for (int ly = CHUNK_SIZE - 1; ly >= 0; ly--) {
+            if (chunk->voxels->data[ChunkVoxelIndex(lx, ly, lz)] != BLOCK_AIR) {
+                return (float)(cy * CHUNK_SIZE + ly) + 1.0f;
+            }
+        }
+    }
+    return 0.0f;
+}
+
+// Amanatides & Woo grid traversal: visits only the cells the ray passes
+// through, so the cost depends on the reach and not on the world size.
+VoxelHit RaycastVoxels(World* world, Ray ray, float maxDistance) {
+    VoxelHit result = { 0 };
+
+    Vector3 origin = { ray.position.x + 0.5f, ray.position.y, ray.position.z + 0.5f };
+    Vector3 dir = Vector3Normalize(ray.direction);
+
+    int x = (int)floorf(origin.x);
+    int y = (int)floorf(origin.y);
+    int z = (int)floorf(origin.z);
+
+    int stepX = (dir.x > 0.0f) ? 1 : ((dir.x < 0.0f) ? -1 : 0);
+    int stepY = (dir.y > 0.0f) ? 1 : ((dir.y < 0.0f) ? -1 : 0);
+    int stepZ = (dir.z > 0.0f) ? 1 : ((dir.z < 0.0f) ? -1 : 0);
+
+    float tDeltaX = (stepX != 0) ? fabsf(1.0f / dir.x) : INFINITY;
+    float tDeltaY = (stepY != 0) ? fabsf(1.0f / dir.y) : INFINITY;
+    float tDeltaZ = (stepZ != 0) ? fabsf(1.0f / dir.z) : INFINITY;
+
+    float tMaxX = (stepX > 0) ? (x + 1 - origin.x) * tDeltaX : ((stepX < 0) ? (origin.x - x) * tDeltaX : INFINITY);
+    float tMaxY = (stepY > 0) ? (y + 1 - origin.y) * tDeltaY : ((stepY < 0) ? (origin.y - y) * tDeltaY : INFINITY);
+    float tMaxZ = (stepZ > 0) ? (z + 1 - origin.z) * tDeltaZ : ((stepZ < 0) ? (origin.z - z) * tDeltaZ : INFINITY);
+
+    int normalX = 0, normalY = 0, normalZ = 0;
+    float t = 0.0f;
+
+    while (t <= maxDistance) {
+        bool solid = GetBlock(world, x, y, z) != BLOCK_AIR;
+        bool ground = !solid && IsGroundCell(y);
+
+        if (solid || ground) {
+            result.hit = true;
+            result.ground = ground;
+            result.x = x;
+            result.y = y;
+            result.z = z;
+            result.normalX = normalX;
+            result.normalY = normalY;
+            result.normalZ = normalZ;
+            result.adjacentX = x + normalX;
+            result.adjacentY = y + normalY;
+            result.adjacentZ = z + normalZ;
+            result.distance = t;
+            return result;
+        }
+
+        if (tMaxX < tMaxY && tMaxX < tMaxZ) {
+            x += stepX;
+            t = tMaxX;
+            tMaxX += tDeltaX;
+            normalX = -stepX; normalY = 0; normalZ = 0;
+        } else if (tMaxY < tMaxZ) {
+            y += stepY;
+            t = tMaxY;
+            tMaxY += tDeltaY;
+            normalX = 0; normalY = -stepY; normalZ = 0;
+        } else {
+            z += stepZ;
+            t = tMaxZ;
+            tMaxZ += tDeltaZ;
+            normalX = 0; normalY = 0; normalZ = -stepZ;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,183 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+#include "raylib.h"
+#include <stdbool.h>
+
+#define BLOCK_REACH 12.0f
+
+typedef enum {
+    BLOCK_AIR = 0,
+    BLOCK_STONE = 1,
+    BLOCK_GRASS = 2,
+    BLOCK_DIRT = 3,
+    BLOCK_WOOD = 4,
+    BLOCK_LEAVES = 5,
+    BLOCK_SAND = 6,
+    BLOCK_GRAVEL = 7,
+    BLOCK_LAMP = 8
+} BlockType;
+
+#define BLOCK_TYPE_COUNT 9
+
+#define CHUNK_SHIFT 4
+#define CHUNK_SIZE (1 << CHUNK_SHIFT)
+#define CHUNK_MASK (CHUNK_SIZE - 1)
+#define CHUNK_VOLUME (CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE)
+// The highest chunk layer a shared world may be built up to.
+#define WORLD_MAX_CHUNK_Y 15
+
+#define CHUNK_TABLE_INITIAL_CAPACITY 64
+
+#define CHUNK_FACE_COUNT 6
+#define ALL_CHUNK_FACES 0x3F
+
+#define LIGHT_MAX 15
+#define LIGHT_SKY_SHIFT 4
+#define LIGHT_BLOCK_MASK 0x0F
+#define LIGHT_OPEN_SKY (LIGHT_MAX << LIGHT_SKY_SHIFT)
+
+// ticket names the mesh build asked for last and building is set until it
+// is swapped in; a result with any other ticket belongs to a chunk that has
+// since been dropped and is discarded. lod is the level of detail that build
+// was asked for, 0 being full detail.
+typedef struct {
+    Mesh mesh;
+    bool hasMesh;
+    bool building;
+    unsigned int ticket;
+    unsigned char lod;
+} ChunkMesh;
+
+// Open-addressing map from chunk coordinates to an int, with backward-shift
+// deletion like the chunk table.
+typedef struct {
+    int cx, cy, cz;
+    int value;
+    bool used;
+} CoordSlot;
+
+typedef struct {
+    CoordSlot* slots;
+    int count;
+    int capacity;
+} CoordMap;
+
+// Voxel storage is shared with save snapshots until the next edit; writers go
+// through GetWritableVoxels, which copies a shared buffer first. Reference
+// counts are only changed on the main thread.
+typedef struct {
+    int refCount;
+    unsigned char data[CHUNK_VOLUME];
+} VoxelBuffer;
+
+// Sky light in the high nibble, block light in the low one. Shared with
+// mesh builds the same way as VoxelBuffer, through GetWritableLight.
+typedef struct {
+    int refCount;
+    unsigned char data[CHUNK_VOLUME];
+} LightBuffer;
+
+// faceLinks[a] has bit b set when air inside the chunk connects face a to
+// face b. Faces are ordered -X, +X, -Y, +Y, -Z, +Z. modified means the chunk
+// differs from its saved copy; generated means it is still exactly what the
+// terrain generator produced, so it never needs storing. revision changes on
+// every edit so a finished save can tell whether it wrote the latest state.
+// light is NULL until the attached light engine has lit the chunk, and
+// always without one.
+typedef struct Chunk {
+    int cx, cy, cz;
+    int index;
+    int blockCount;
+    bool dirty;
+    bool modified;
+    bool generated;
+    unsigned int revision;
+    ChunkMesh mesh;
+    unsigned char faceLinks[CHUNK_FACE_COUNT];
+    VoxelBuffer* voxels;
+    LightBuffer* light;
+} Chunk;
+
+struct WorldSave;
+struct ChunkCache;
+struct LightEngine;
+
+// onChunkRemoved lets the renderer release GPU data before a chunk is freed;
+// the world itself never touches the graphics API. Chunks that are not in
+// memory are restored on first access through GetChunk, from the eviction
+// cache first and then the attached save. emptied holds chunks the player
+// dug out completely since the last save, so neither source brings them back.
+typedef struct {
+    Chunk** chunks;
+    int chunkCount;
+    int chunkCapacity;
+
+    Chunk** table;
+    int tableCapacity;
+
+    int minChunkX, minChunkY, minChunkZ;
+    int maxChunkX, maxChunkY, maxChunkZ;
+    bool hasBounds;
+    int blockCount;
+    bool modified;
+    unsigned int revision;
+    CoordMap emptied;
+
+    bool hasTerrain;
+    unsigned int terrainSeed;
+
+    struct ChunkCache* cache;
+    struct WorldSave* save;
+    struct LightEngine* light;
+    void (*onChunkRemoved)(Chunk* chunk);
+} World;
+
+typedef struct {
+    bool hit;
+    bool ground;
+    int x, y, z;
+    int normalX, normalY, normalZ;
+    int adjacentX, adjacentY, adjacentZ;
+    float distance;
+} VoxelHit;
+
+Vector3 CellCenter(int x, int y, int z);
+BoundingBox CellBox(int x, int y, int z);
+void CellFromPosition(Vector3 position, int* x, int* y, int* z);
+void CellRangeForBox(BoundingBox box, int* x0, int* y0, int* z0, int* x1, int* y1, int* z1);
+bool IsGroundCell(int y);
+
+unsigned int ChunkHash(int cx, int cy, int cz);
+int* FindCoord(const CoordMap* map, int cx, int cy, int cz);
+int* InsertCoord(CoordMap* map, int cx, int cy, int cz, int value);
+bool RemoveCoord(CoordMap* map, int cx, int cy, int cz);
+void FreeCoordMap(CoordMap* map);
+
+int ChunkVoxelIndex(int lx, int ly, int lz);
+Chunk* FindChunk(World* world, int cx, int cy, int cz);
+Chunk* GetChunk(World* world, int cx, int cy, int cz);
+void ExtendChunkBounds(World* world, int cx, int cy, int cz);
+VoxelBuffer* RetainVoxelBuffer(VoxelBuffer* buffer);
+void ReleaseVoxelBuffer(VoxelBuffer* buffer);
+unsigned char* GetWritableVoxels(Chunk* chunk);
+LightBuffer* RetainLightBuffer(LightBuffer* buffer);
+void ReleaseLightBuffer(LightBuffer* buffer);
+unsigned char* GetWritableLight(Chunk* chunk);
+Chunk* CreateChunk(World* world, int cx, int cy, int cz);
+void RemoveChunk(World* world, Chunk* chunk);
+void MarkChunkDirty(World* world, int cx, int cy, int cz);
+void MarkNeighborsDirty(World* world, int cx, int cy, int cz);
+void MarkLightDirty(World* world, int x, int y, int z);
+void RestoreChunkLight(World* world, Chunk* chunk);
+void KeepChunkLight(World* world, Chunk* chunk);
+void FreeWorld(World* world);
+
+BlockType GetBlock(World* world, int x, int y, int z);
+BlockType GetLoadedBlock(World* world, int x, int y, int z);
+void SetBlock(World* world, int x, int y, int z, BlockType type);
+
+float FindGroundLevel(Vector3 position, World* world);
+VoxelHit RaycastVoxels(World* world, Ray ray, float maxDistance);
+
+#endif